@@ -0,0 +1,71 @@
+import os
+import re
+import time
+import tempfile
+
+# conversion of Triangle output to Hermes2D mesh (all mesh types), from about 10k to 1M triangles
+# not included in test.py, run separately
+
+def count_elements(filename):
+    triangles = 0
+    quads = 0
+    section = False
+    for line in open(filename):
+        if (line.startswith("elements")):
+            section = True
+        elif (section and line.strip() == ""):
+            break
+        elif (section and line.strip().startswith("{ ")):
+            if (len(line.strip().rstrip(",").split(",")) == 4):
+                triangles += 1
+            else:
+                quads += 1
+    return triangles, quads
+
+def mesh_document(meshtype, area):
+    newdocument("Mesh benchmark", "planar", "general", 0, 1, "disabled", 0, 1, 0, "steadystate", 0, 0, 0)
+    addboundary("Dirichlet", "general_value", 0)
+    addmaterial("Material", 0, 1)
+
+    addedge(0, 0, 1, 0, 0, "Dirichlet")
+    addedge(1, 0, 1, 1, 0, "Dirichlet")
+    addedge(1, 1, 0, 1, 0, "Dirichlet")
+    addedge(0, 1, 0, 0, 0, "Dirichlet")
+    addlabel(0.5, 0.5, area, 0, "Material")
+
+    # mesh type is not accessible from script, set it in the document
+    fn = tempfile.gettempdir() + "/benchmark_mesh.a2d"
+    savedocument(fn)
+    content = open(fn).read()
+    content = re.sub('meshtype="[a-z_]*"', 'meshtype="' + meshtype + '"', content)
+    open(fn, "w").write(content)
+    opendocument(fn)
+    os.remove(fn)
+
+    start = time.time()
+    mesh()
+    elapsed = time.time() - start
+
+    triangles, quads = count_elements(meshfilename())
+    closedocument()
+
+    return elapsed, triangles, quads
+
+result = True
+for area in [1e-4, 1e-5, 1e-6]:
+    elapsed, triangles, quads = mesh_document("triangle", area)
+    print("triangle: area = " + str(area) + ", triangles = " + str(triangles) + ", time = " + str(elapsed) + " s")
+    count = triangles
+
+    # fine division creates three quads from each triangle
+    elapsed, triangles, quads = mesh_document("quad_fine_division", area)
+    print("quad_fine_division: quads = " + str(quads) + ", time = " + str(elapsed) + " s")
+    result = result and (triangles == 0) and (quads == 3 * count)
+
+    # rough division and join keep the number of elements at most the number of triangles
+    for meshtype in ["quad_rough_division", "quad_join"]:
+        elapsed, triangles, quads = mesh_document(meshtype, area)
+        print(meshtype + ": triangles = " + str(triangles) + ", quads = " + str(quads) + ", time = " + str(elapsed) + " s")
+        result = result and (quads > 0) and (triangles + quads <= count)
+
+print("Test: Mesh conversion benchmark: " + str(result))
@@ -32,5 +32,8 @@ execfile("test_elasticity_axisymmetric.py")
 # execfile("test_rf_planar.py")
 # execfile("test_rf_axisymmetric.py")
 
+# point values
+execfile("test_pointresult.py")
+
 # scripting
 execfile("test_scripting.py")
\ No newline at end of file
@@ -58,6 +58,10 @@ testF = test("Heat flux", point["F"], 16.739787)
 testFr = test("Heat flux - r", point["Fx"], -7.697043)
 testFz = test("Heat flux - z", point["Fy"], -14.865261)
 
+# time series
+times, values = timeseries(0.00503, 0.134283)
+testSeries = (len(times) == timestepcount()) and test("Temperature - time series", values[-1]["T"], point["T"])
+
 # volume integral
 volume = volumeintegral(3)
 testTavg = test("Average temperature", volume["T_avg"], 0.034505/8.365e-4)
@@ -66,4 +70,4 @@ testTavg = test("Average temperature", volume["T_avg"], 0.034505/8.365e-4)
 surface = surfaceintegral(26);
 testFlux = test("Heat flux", surface["F"], 0.032866)
 
-print("Test: Heat transfer transient - axisymmetric: " + str(testT and testF and testFr and testFz and testTavg and testFlux))
\ No newline at end of file
+print("Test: Heat transfer transient - axisymmetric: " + str(testT and testF and testFr and testFz and testTavg and testFlux and testSeries))
\ No newline at end of file
@@ -0,0 +1,68 @@
+# batched point values, each point must equal the point value at the same point
+def testpoints(text, points):
+	values = pointresult(points)
+	result = (len(values) == len(points))
+	for i in range(len(points)):
+		point = pointresult(points[i][0], points[i][1])
+		for key in point.keys():
+			if (abs(values[i][key] - point[key]) > 1e-10 * max(abs(point[key]), 1.0)):
+				print(text + " [" + str(points[i][0]) + ", " + str(points[i][1]) + "] " + key + ": (" + str(values[i][key]) + " != " + str(point[key]) + ")")
+				result = False
+	return result
+
+# steady state (one solution), points in both materials
+newdocument("Point values - steady state", "planar", "heat", 2, 3)
+
+addboundary("T inner", "heat_temperature", -15)
+addboundary("T outer", "heat_heat_flux", 0, 20, 20)
+addboundary("Neumann", "heat_heat_flux", 0, 0, 0)
+
+addmaterial("Material 1", 0, 2, 0, 0)
+addmaterial("Material 2", 7e4, 10, 0, 0)
+
+addedge(0.1, 0.15, 0, 0.15, 0, "T outer")
+addedge(0, 0.15, 0, 0.1, 0, "Neumann")
+addedge(0, 0.1, 0.05, 0.1, 0, "T inner")
+addedge(0.05, 0.1, 0.05, 0, 0, "T inner")
+addedge(0.05, 0, 0.1, 0, 0, "Neumann")
+addedge(0.05, 0.1, 0.1, 0.1, 0, "none")
+addedge(0.1, 0.15, 0.1, 0.1, 0, "T outer")
+addedge(0.1, 0.1, 0.1, 0, 0, "T outer")
+
+addlabel(0.0553981, 0.124595, 0.003, 0, "Material 1")
+addlabel(0.070091, 0.068229, 0.003, 0, "Material 2")
+
+solve()
+
+testSteady = testpoints("Point values - steady state", [[0.086266, 0.087725], [0.012, 0.142], [0.0553981, 0.124595], [0.093, 0.011], [0.070091, 0.068229]])
+
+# harmonic (real and imaginary solution), points scattered over the domain
+newdocument("Point values - harmonic", "planar", "acoustic", 3, 2, "disabled", 5, 1, 2000, "harmonic", 1.0, 1.0, 0.0)
+
+addboundary("Source", "acoustic_pressure", 0.01)
+addboundary("Wall", "acoustic_normal_acceleration", 0)
+addboundary("Matched boundary", "acoustic_matched_boundary", 0)
+
+addmaterial("Air", 1.25, 343)
+
+addedge(-0.4, 0.05, 0.1, 0.2, 0, "Matched boundary")
+addedge(0.1, -0.2, -0.4, -0.05, 0, "Matched boundary")
+addedge(-0.4, 0.05, -0.4, -0.05, 0, "Matched boundary")
+addedge(-0.18, -0.06, -0.17, -0.05, 90, "Source")
+addedge(-0.17, -0.05, -0.18, -0.04, 90, "Source")
+addedge(-0.18, -0.04, -0.19, -0.05, 90, "Source")
+addedge(-0.19, -0.05, -0.18, -0.06, 90, "Source")
+addedge(0.1, -0.2, 0.1, 0.2, 90, "Matched boundary")
+addedge(0.03, 0.1, -0.04, -0.05, 90, "Wall")
+addedge(-0.04, -0.05, 0.08, -0.04, 0, "Wall")
+addedge(0.08, -0.04, 0.03, 0.1, 0, "Wall")
+
+addlabel(-0.0814934, 0.0707097, 0, 0, "Air")
+addlabel(-0.181474, -0.0504768, 0, 0, "none")
+addlabel(0.0314514, 0.0411749, 0, 0, "none")
+
+solve()
+
+testHarmonic = testpoints("Point values - harmonic", [[-0.084614, 0.053416], [-0.35, 0.0], [0.05, 0.15], [0.0, -0.12], [-0.25, -0.07]])
+
+print("Test: Point values (batched): " + str(testSteady and testHarmonic))
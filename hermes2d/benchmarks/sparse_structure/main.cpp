@@ -0,0 +1,162 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "hermes2d.h"
+#include "weakform_library/h1.h"
+#include <sys/time.h>
+
+// Benchmark of the sparse structure (matrix pattern) creation.
+//
+// Compares DiscreteProblem::create_sparse_structure() with the page-based
+// builder (pre_add_ij() for every pair of dofs of every element) on a
+// unit square divided into n x n squares of two triangles each, n = 32, 64,
+// ... up to the given maximum (about 9 n^2 dofs for the default order 3).
+// The patterns built with 1, 2 and 4 threads are checked to be identical to
+// the page-based one. Not built with the library, run separately:
+//
+//   qmake && make && ./sparse_structure [order] [max n]
+
+using namespace WeakFormsH1;
+
+static double wall_time()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// the former builder: every pair of dofs goes to the page lists
+static void page_structure(Space* space, CSCMatrix* mat)
+{
+  mat->free();
+  mat->prealloc(space->get_num_dofs());
+
+  Mesh* mesh = space->get_mesh();
+  AsmList al;
+  Traverse trav;
+  trav.begin(1, &mesh);
+  Element** e;
+  while ((e = trav.get_next_state(NULL, NULL)) != NULL)
+  {
+    space->get_element_assembly_list(e[0], &al);
+    for (unsigned int i = 0; i < al.cnt; i++)
+      if (al.dof[i] >= 0)
+        for (unsigned int j = 0; j < al.cnt; j++)
+          if (al.dof[j] >= 0)
+            mat->pre_add_ij(al.dof[i], al.dof[j]);
+  }
+  trav.finish();
+
+  mat->alloc();
+}
+
+static bool same_structure(CSCMatrix* a, CSCMatrix* b, int ndof)
+{
+  return a->get_nnz() == b->get_nnz()
+      && memcmp(a->get_Ap(), b->get_Ap(), sizeof(int) * (ndof + 1)) == 0
+      && memcmp(a->get_Ai(), b->get_Ai(), sizeof(int) * a->get_nnz()) == 0;
+}
+
+// unit square, n x n squares split into two triangles
+static void create_mesh(Mesh* mesh, int n)
+{
+  int nv = (n + 1) * (n + 1);
+  double2* verts = new double2[nv];
+  for (int j = 0; j <= n; j++)
+    for (int i = 0; i <= n; i++)
+    {
+      verts[j * (n + 1) + i][0] = (double) i / n;
+      verts[j * (n + 1) + i][1] = (double) j / n;
+    }
+
+  int4* tris = new int4[2 * n * n];
+  for (int j = 0; j < n; j++)
+    for (int i = 0; i < n; i++)
+    {
+      int v = j * (n + 1) + i;
+      int4* t = tris + 2 * (j * n + i);
+      t[0][0] = v; t[0][1] = v + 1; t[0][2] = v + n + 2; t[0][3] = 0;
+      t[1][0] = v; t[1][1] = v + n + 2; t[1][2] = v + n + 1; t[1][3] = 0;
+    }
+
+  int3* mark = new int3[4 * n];
+  for (int i = 0; i < n; i++)
+  {
+    int3* m = mark + 4 * i;
+    m[0][0] = i; m[0][1] = i + 1; m[0][2] = 1;
+    m[1][0] = n * (n + 1) + i; m[1][1] = n * (n + 1) + i + 1; m[1][2] = 1;
+    m[2][0] = i * (n + 1); m[2][1] = (i + 1) * (n + 1); m[2][2] = 1;
+    m[3][0] = i * (n + 1) + n; m[3][1] = (i + 1) * (n + 1) + n; m[3][2] = 1;
+  }
+
+  mesh->create(nv, verts, 2 * n * n, tris, 0, NULL, 4 * n, mark);
+
+  delete [] verts;
+  delete [] tris;
+  delete [] mark;
+}
+
+int main(int argc, char* argv[])
+{
+  int order = (argc > 1) ? atoi(argv[1]) : 3;
+  int max_n = (argc > 2) ? atoi(argv[2]) : 512;
+
+  int num_threads[3] = { 1, 2, 4 };
+
+  printf("%10s %12s %10s", "ndof", "nnz", "pages [s]");
+  for (int k = 0; k < 3; k++)
+    printf("  %dt [s]", num_threads[k]);
+  printf("\n");
+
+  bool result = true;
+  for (int n = 32; n <= max_n; n *= 2)
+  {
+    Mesh mesh;
+    create_mesh(&mesh, n);
+
+    H1Space space(&mesh, order);
+    int ndof = space.get_num_dofs();
+
+    WeakForm wf(1);
+    wf.add_matrix_form(new VolumetricMatrixForms::DefaultLinearDiffusion(0, 0));
+
+    CSCMatrix pages;
+    double start = wall_time();
+    page_structure(&space, &pages);
+    double time_pages = wall_time() - start;
+
+    printf("%10d %12d %10.3f", ndof, pages.get_nnz(), time_pages);
+    for (int k = 0; k < 3; k++)
+    {
+      DiscreteProblem dp(&wf, &space);
+      dp.set_num_threads(num_threads[k]);
+
+      CSCMatrix mat;
+      start = wall_time();
+      dp.create_sparse_structure(&mat);
+      printf("  %7.3f", wall_time() - start);
+
+      if (!same_structure(&mat, &pages, ndof))
+      {
+        printf(" (different pattern)");
+        result = false;
+      }
+    }
+    printf("\n");
+    fflush(stdout);
+  }
+
+  return result ? 0 : 1;
+}
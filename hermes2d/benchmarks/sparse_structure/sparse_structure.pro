@@ -0,0 +1,32 @@
+# benchmark of the sparse structure creation, not part of agros2d.pro
+# build the library first (hermes2d.pro)
+QT -= gui
+TARGET = sparse_structure
+TEMPLATE = app
+CONFIG += console
+OBJECTS_DIR = build
+DEFINES += NOGLUT
+DEFINES += WITH_UMFPACK
+
+INCLUDEPATH += ../../src \
+        ../../src/compat \
+        ../../../hermes_common
+
+SOURCES += main.cpp
+
+linux-g++|linux-g++-64|linux-g++-32 {
+    DEFINES += HAVE_FMEMOPEN
+    DEFINES += HAVE_LOG2
+
+    INCLUDEPATH += /usr/include/suitesparse
+    INCLUDEPATH += /usr/include/python2.6
+    INCLUDEPATH += /usr/include/python2.7
+    LIBS += -L../../lib
+    LIBS += -lhermes2d
+    LIBS += -lumfpack
+    LIBS += -lamd
+    LIBS += -lblas
+    LIBS += -lpthread
+    LIBS += $$system(python -c "\"from distutils import sysconfig; print '-lpython'+sysconfig.get_config_var('VERSION')\"")
+    LIBS += $$system(python -c "\"import distutils.sysconfig; print distutils.sysconfig.get_config_var('LOCALMODLIBS')\"")
+}
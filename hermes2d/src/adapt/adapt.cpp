@@ -14,6 +14,7 @@
 // along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "adapt.h"
+#include <climits>
 #include "../hermes2d.h"
 #include "../h2d_common.h"
 #include "../quadrature/limit_order.h"
@@ -33,6 +34,8 @@ using namespace std;
 
 Adapt::Adapt(Hermes::vector<Space *> spaces,
              Hermes::vector<ProjNormType> proj_norms) :
+    num_sorted(0),
+    num_threads(1),
     spaces(spaces),
     num_act_elems(-1),
     have_errors(false),
@@ -78,6 +81,8 @@ Adapt::Adapt(Hermes::vector<Space *> spaces,
 }
 
 Adapt::Adapt(Space* space, ProjNormType proj_norm) :
+    num_sorted(0),
+    num_threads(1),
     spaces(Hermes::vector<Space *>()),
     num_act_elems(-1),
     have_errors(false),
@@ -168,12 +173,21 @@ bool Adapt::adapt(Hermes::vector<RefinementSelectors::Selector *> refinement_sel
 
   bool first_regular_element = true; //true if first regular element was not processed yet
   int inx_regular_element = 0;
+
+  //refinements selected in advance by the threads
+  SelectionThread* threads = init_selection_threads(refinement_selectors, meshes);
+  int batch_size = num_threads;
+  ElementToRefine* selected_refs = (threads != NULL) ? new ElementToRefine[16 * num_threads] : NULL;
+  bool* selected = (threads != NULL) ? new bool[16 * num_threads] : NULL;
+  int selected_first = 0, selected_last = 0;
+
   while (inx_regular_element < num_act_elems || !priority_queue.empty())
   {
     int id, comp, inx_element;
 
     //get element identification
     if (priority_queue.empty()) {
+      sort_regular_queue(inx_regular_element + 1);
       id = regular_queue[inx_regular_element].id;
       comp = regular_queue[inx_regular_element].comp;
       inx_element = inx_regular_element;
@@ -221,9 +235,32 @@ bool Adapt::adapt(Hermes::vector<RefinementSelectors::Selector *> refinement_sel
 
       // get refinement suggestion
       ElementToRefine elem_ref(id, comp);
-      int current = this->spaces[comp]->get_element_order(id);
-      // rsln[comp] may be unset if refinement_selectors[comp] == HOnlySelector or POnlySelector
-      bool refined = refinement_selectors[comp]->select_refinement(e, current, rsln[comp], elem_ref);
+      bool refined;
+      if (threads != NULL && inx_element >= 0) {
+        // selected in advance by the threads, a batch of the following elements at a time
+        // (the batch grows from one element per thread and ends where the strategy would stop)
+        if (inx_element >= selected_last) {
+          selected_first = inx_element;
+          selected_last = std::min(inx_element + batch_size, num_act_elems);
+          sort_regular_queue(selected_last);
+          for (int i = selected_first + 1; i < selected_last; i++) {
+            double err = errors[regular_queue[i].comp][regular_queue[i].id];
+            if (((strat == 1 || strat == 3) && err < error_squared_threshod) || (strat == 2 && err < thr)) {
+              selected_last = i;
+              break;
+            }
+          }
+          select_refinements(threads, selected_first, selected_last, selected_refs, selected);
+          batch_size = std::min(2 * batch_size, 16 * num_threads);
+        }
+        elem_ref = selected_refs[inx_element - selected_first];
+        refined = selected[inx_element - selected_first];
+      }
+      else {
+        int current = this->spaces[comp]->get_element_order(id);
+        // rsln[comp] may be unset if refinement_selectors[comp] == HOnlySelector or POnlySelector
+        refined = refinement_selectors[comp]->select_refinement(e, current, rsln[comp], elem_ref);
+      }
 
       //add to a list of elements that are going to be refined
       if (can_refine_element(mesh, e, refined, elem_ref) ) {
@@ -242,6 +279,12 @@ bool Adapt::adapt(Hermes::vector<RefinementSelectors::Selector *> refinement_sel
     }
   }
 
+  if (threads != NULL) {
+    free_selection_threads(threads);
+    delete [] selected_refs;
+    delete [] selected;
+  }
+
   verbose("Examined elements: %d", num_exam_elem);
   verbose(" Elements taken from priority queue: %d", num_priority_elem);
   verbose(" Ignored elements: %d", num_ignored_elem);
@@ -310,6 +353,124 @@ bool Adapt::adapt(RefinementSelectors::Selector* refinement_selector, double thr
   return adapt(refinement_selectors, thr, strat, regularize, to_be_processed);
 }
 
+void Adapt::set_num_threads(int num_threads)
+{
+  if (num_threads < 1)
+    error("Number of threads must be positive in Adapt::set_num_threads().");
+  this->num_threads = num_threads;
+}
+
+struct Adapt::SelectionThread
+{
+  Adapt* adapt;
+  pthread_t thread;
+
+  // Index of the thread and the number of all threads.
+  int index;
+  int count;
+
+  // Selectors and reference solutions of the components (copies except for the calling thread).
+  RefinementSelectors::Selector* selectors[H2D_MAX_COMPONENTS];
+  Solution* rsln[H2D_MAX_COMPONENTS];
+  Mesh** meshes;
+
+  // Elements of the regular queue processed by all threads and the selected refinements.
+  int first, last;
+  ElementToRefine* elem_refs;
+  bool* refined;
+};
+
+Adapt::SelectionThread* Adapt::init_selection_threads(Hermes::vector<RefinementSelectors::Selector *>& refinement_selectors, Mesh** meshes)
+{
+  if (num_threads < 2)
+    return NULL;
+
+  Hermes::vector<Mesh *> mesh_list;
+  for (int j = 0; j < this->num; j++)
+    mesh_list.push_back(meshes[j]);
+  if (!Traverse::is_mode_uniform(mesh_list))
+    return NULL;
+
+  // Copies of the selectors are created here, as the constructors switch the mode of the shapesets.
+  for (int t = 1; t < num_threads; t++)
+    for (int j = 0; j < this->num; j++)
+      if (refinement_selectors[j]->get_thread_copy(t - 1) == NULL)
+        return NULL;
+
+  SelectionThread* threads = new SelectionThread[num_threads];
+  for (int t = 0; t < num_threads; t++) {
+    SelectionThread* st = threads + t;
+    st->adapt = this;
+    st->index = t;
+    st->count = num_threads;
+    st->meshes = meshes;
+    for (int j = 0; j < this->num; j++) {
+      if (t == 0) {
+        st->selectors[j] = refinement_selectors[j];
+        st->rsln[j] = rsln[j];
+      }
+      else {
+        st->selectors[j] = refinement_selectors[j]->get_thread_copy(t - 1);
+        st->rsln[j] = NULL;
+        if (rsln[j] != NULL) {
+          st->rsln[j] = new Solution();
+          st->rsln[j]->copy(rsln[j], false);
+          st->rsln[j]->set_quad_2d(&g_quad_2d_std);
+          st->rsln[j]->enable_transform(false);
+          st->rsln[j]->use_private_refmap_pss();
+        }
+      }
+    }
+  }
+
+  return threads;
+}
+
+void Adapt::select_refinements(SelectionThread* threads, int first, int last, ElementToRefine* elem_refs, bool* refined)
+{
+  for (int t = 0; t < num_threads; t++) {
+    threads[t].first = first;
+    threads[t].last = last;
+    threads[t].elem_refs = elem_refs;
+    threads[t].refined = refined;
+  }
+
+  // The first part is selected by the calling thread.
+  for (int t = 1; t < num_threads; t++)
+    if (pthread_create(&threads[t].thread, NULL, selection_thread, threads + t) != 0)
+      error("Could not create a thread in Adapt::select_refinements().");
+  selection_thread(threads);
+  for (int t = 1; t < num_threads; t++)
+    pthread_join(threads[t].thread, NULL);
+}
+
+void* Adapt::selection_thread(void* data)
+{
+  SelectionThread* st = (SelectionThread*) data;
+  Adapt* adapt = st->adapt;
+
+  for (int inx = st->first + st->index; inx < st->last; inx += st->count) {
+    int id = adapt->regular_queue[inx].id;
+    int comp = adapt->regular_queue[inx].comp;
+    Element* e = st->meshes[comp]->get_element(id);
+
+    ElementToRefine& elem_ref = st->elem_refs[inx - st->first];
+    elem_ref = ElementToRefine(id, comp);
+    int current = adapt->spaces[comp]->get_element_order(id);
+    st->refined[inx - st->first] = st->selectors[comp]->select_refinement(e, current, st->rsln[comp], elem_ref);
+  }
+
+  return NULL;
+}
+
+void Adapt::free_selection_threads(SelectionThread* threads)
+{
+  for (int t = 1; t < num_threads; t++)
+    for (int j = 0; j < this->num; j++)
+      delete threads[t].rsln[j];
+  delete [] threads;
+}
+
 void Adapt::fix_shared_mesh_refinements(Mesh** meshes, Hermes::vector<ElementToRefine>& elems_to_refine,
                                         int** idx, Hermes::vector<RefinementSelectors::Selector *> refinement_selectors) {
   int num_elem_to_proc = elems_to_refine.size();
@@ -437,6 +598,7 @@ void Adapt::unrefine(double thr)
   if (!have_errors)
     error("Element errors have to be calculated first, see Adapt::calc_err_est().");
   if (this->num > 2) error("Unrefine implemented for two spaces only.");
+  sort_regular_queue(1);
 
   Mesh* mesh[2];
   mesh[0] = this->spaces[0]->get_mesh();
@@ -679,11 +841,75 @@ double Adapt::eval_error_norm(Adapt::MatrixFormVolError* form,
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Adapt::ErrorThread
+{
+  Adapt* adapt;
+  pthread_t thread;
+
+  // Base elements [first_base, last_base) of the thread.
+  int first_base, last_base;
+
+  // Solutions of the components (copies except for the calling thread).
+  Solution* sln[H2D_MAX_COMPONENTS];
+  Solution* rsln[H2D_MAX_COMPONENTS];
+
+  // Errors of the elements (NULL if not calculated, shared by the threads) and the sums of the thread.
+  double* errors[H2D_MAX_COMPONENTS];
+  double norms[H2D_MAX_COMPONENTS];
+  double errors_components[H2D_MAX_COMPONENTS];
+  double total_norm;
+  double total_error;
+};
+
+void* Adapt::error_thread(void* data)
+{
+  ErrorThread* et = (ErrorThread*) data;
+  Adapt* adapt = et->adapt;
+  int num = adapt->num;
+
+  Mesh* meshes[2 * H2D_MAX_COMPONENTS];
+  Transformable* tr[2 * H2D_MAX_COMPONENTS];
+  for (int i = 0; i < num; i++) {
+    meshes[i] = et->sln[i]->get_mesh();
+    meshes[i + num] = et->rsln[i]->get_mesh();
+    tr[i] = et->sln[i];
+    tr[i + num] = et->rsln[i];
+  }
+
+  // Each thread traverses its own range of the base elements, so the error of an element
+  // is summed by one thread only.
+  Element **ee;
+  Traverse trav;
+  trav.begin(2 * num, meshes, tr);
+  trav.set_base_range(et->first_base, et->last_base);
+  while ((ee = trav.get_next_state(NULL, NULL)) != NULL) {
+    for (int i = 0; i < num; i++) {
+      for (int j = 0; j < num; j++) {
+        if (adapt->error_form[i][j] != NULL) {
+          double err, nrm;
+          err = adapt->eval_error(adapt->error_form[i][j], et->sln[i], et->sln[j], et->rsln[i], et->rsln[j]);
+          nrm = adapt->eval_error_norm(adapt->error_form[i][j], et->rsln[i], et->rsln[j]);
+
+          et->norms[i] += nrm;
+          et->total_norm += nrm;
+          et->total_error += err;
+          et->errors_components[i] += err;
+          if (et->errors[i] != NULL)
+            et->errors[i][ee[i]->id] += err;
+        }
+      }
+    }
+  }
+  trav.finish();
+
+  return NULL;
+}
+
 double Adapt::calc_err_internal(Hermes::vector<Solution *> slns, Hermes::vector<Solution *> rslns,
                                 Hermes::vector<double>* component_errors, bool solutions_for_adapt, unsigned int error_flags)
 {
   _F_
-  int i, j, k;
+  int i, k;
 
   int n = slns.size();
   if (n != this->num) EXIT("Wrong number of solutions.");
@@ -707,16 +933,12 @@ double Adapt::calc_err_internal(Hermes::vector<Solution *> slns, Hermes::vector<
   have_coarse_solutions = true;
   have_reference_solutions = true;
 
-  // Prepare multi-mesh traversal and error arrays.
+  // Prepare error arrays.
   Mesh **meshes = new Mesh *[2 * num];
-  Transformable **tr = new Transformable *[2 * num];
-  Traverse trav;
   num_act_elems = 0;
   for (i = 0; i < num; i++) {
     meshes[i] = sln[i]->get_mesh();
     meshes[i + num] = rsln[i]->get_mesh();
-    tr[i] = sln[i];
-    tr[i + num] = rsln[i];
 
     num_act_elems += sln[i]->get_mesh()->get_num_active_elements();
 
@@ -728,6 +950,60 @@ double Adapt::calc_err_internal(Hermes::vector<Solution *> slns, Hermes::vector<
     }
   }
 
+  // The threads evaluate copies of the solutions.
+  int count = 1;
+  if (num_threads > 1) {
+    bool copyable = true;
+    Hermes::vector<Mesh *> mesh_list;
+    for (i = 0; i < 2 * num; i++)
+      mesh_list.push_back(meshes[i]);
+    for (i = 0; i < num; i++)
+      if (sln[i]->get_type() != HERMES_SLN || rsln[i]->get_type() != HERMES_SLN)
+        copyable = false;
+    if (copyable && Traverse::is_mode_uniform(mesh_list))
+      count = num_threads;
+  }
+
+  // Every thread takes a contiguous range of the base elements.
+  int* bounds = new int[count + 1];
+  Traverse::split_base_elements(2 * num, meshes, count, bounds);
+
+  ErrorThread* threads = new ErrorThread[count];
+  for (int t = 0; t < count; t++) {
+    ErrorThread* et = threads + t;
+    et->adapt = this;
+    et->first_base = bounds[t];
+    et->last_base = bounds[t + 1];
+    et->total_norm = et->total_error = 0.0;
+    for (i = 0; i < num; i++) {
+      et->norms[i] = et->errors_components[i] = 0.0;
+      et->errors[i] = solutions_for_adapt ? errors[i] : NULL;
+      if (t == 0) {
+        et->sln[i] = sln[i];
+        et->rsln[i] = rsln[i];
+      }
+      else {
+        et->sln[i] = new Solution();
+        et->sln[i]->copy(sln[i], false);
+        et->sln[i]->set_quad_2d(&g_quad_2d_std);
+        et->sln[i]->use_private_refmap_pss();
+        et->rsln[i] = new Solution();
+        et->rsln[i]->copy(rsln[i], false);
+        et->rsln[i]->set_quad_2d(&g_quad_2d_std);
+        et->rsln[i]->use_private_refmap_pss();
+      }
+    }
+  }
+  delete [] bounds;
+
+  // Calculate error, the first part by the calling thread.
+  for (int t = 1; t < count; t++)
+    if (pthread_create(&threads[t].thread, NULL, error_thread, threads + t) != 0)
+      error("Could not create a thread in Adapt::calc_err_internal().");
+  error_thread(threads);
+  for (int t = 1; t < count; t++)
+    pthread_join(threads[t].thread, NULL);
+
   double total_norm = 0.0;
   double *norms = new double[num];
   memset(norms, 0, num * sizeof(double));
@@ -736,28 +1012,20 @@ double Adapt::calc_err_internal(Hermes::vector<Solution *> slns, Hermes::vector<
   if(solutions_for_adapt) this->errors_squared_sum = 0.0;
   double total_error = 0.0;
 
-  // Calculate error.
-  Element **ee;
-  trav.begin(2 * num, meshes, tr);
-  while ((ee = trav.get_next_state(NULL, NULL)) != NULL) {
+  for (int t = 0; t < count; t++) {
+    ErrorThread* et = threads + t;
+    total_norm += et->total_norm;
+    total_error += et->total_error;
     for (i = 0; i < num; i++) {
-      for (j = 0; j < num; j++) {
-        if (error_form[i][j] != NULL) {
-          double err, nrm;
-          err = eval_error(error_form[i][j], sln[i], sln[j], rsln[i], rsln[j]);
-          nrm = eval_error_norm(error_form[i][j], rsln[i], rsln[j]);
-
-          norms[i] += nrm;
-          total_norm  += nrm;
-          total_error += err;
-          errors_components[i] += err;
-          if(solutions_for_adapt)
-            this->errors[i][ee[i]->id] += err;
-        }
+      norms[i] += et->norms[i];
+      errors_components[i] += et->errors_components[i];
+      if (t > 0) {
+        delete et->sln[i];
+        delete et->rsln[i];
       }
     }
   }
-  trav.finish();
+  delete [] threads;
 
   // Store the calculation for each solution component separately.
   if(component_errors != NULL) {
@@ -798,6 +1066,8 @@ double Adapt::calc_err_internal(Hermes::vector<Solution *> slns, Hermes::vector<
 
   // Prepare an ordered list of elements according to an error.
   if(solutions_for_adapt) {
+    // an overridden fill_regular_queue() may not know about num_sorted, its order is final
+    num_sorted = INT_MAX;
     fill_regular_queue(meshes);
     have_errors = true;
   }
@@ -809,7 +1079,6 @@ double Adapt::calc_err_internal(Hermes::vector<Solution *> slns, Hermes::vector<
   }
 
   delete [] meshes;
-  delete [] tr;
   delete [] norms;
   delete [] errors_components;
 
@@ -855,6 +1124,23 @@ void Adapt::fill_regular_queue(Mesh** meshes) {
     for_all_active_elements(e, meshes[i])
       regular_queue.push_back(ElementReference(e->id, i));
 
-  //sort
-  std::sort(regular_queue.begin(), regular_queue.end(), CompareElements(errors));
+  //the queue is sorted on demand, adapt() usually examines just its beginning
+  num_sorted = 0;
+}
+
+void Adapt::sort_regular_queue(int count) const {
+  int size = (int)regular_queue.size();
+  if (count > size)
+    count = size;
+  if (count <= num_sorted)
+    return;
+
+  //extend the sorted part at least twice to keep the number of partitions low
+  count = std::min(std::max(count, 2 * num_sorted), size);
+  vector<ElementReference>::iterator begin = regular_queue.begin() + num_sorted;
+  vector<ElementReference>::iterator end = regular_queue.begin() + count;
+  if (count < size)
+    std::nth_element(begin, end, regular_queue.end(), CompareElements(errors));
+  std::sort(begin, end, CompareElements(errors));
+  num_sorted = count;
 }
@@ -250,6 +250,17 @@ public:
   bool adapt(RefinementSelectors::Selector* refinement_selector, double thr, int strat = 0,
             int regularize = -1, double to_be_processed = 0.0);
 
+  /// Sets the number of threads used by adapt() and calc_err_est() (1 by default).
+  /// The threads of calc_err_est() evaluate the errors of disjoint sets of elements on copies of
+  /// the solutions and sum them up afterwards. The threads of adapt() select the refinements
+  /// of the elements of the regular queue in advance, each with its own copies of the selectors
+  /// (see RefinementSelectors::Selector::get_thread_copy()) and of the reference solutions.
+  /// The refinements are then applied in the order of the errors as if selected one by one.
+  /// Meshes combining triangles and quads and selectors which cannot be copied are always
+  /// processed by the calling thread only.
+  void set_num_threads(int num_threads);
+  int get_num_threads() const { return num_threads; }
+
   /// Unrefines the elements with the smallest error.
   /** \note This method is provided just for backward compatibility reasons. Currently, it is not used by the library.
    *  \param[in] thr A stop condition relative error threshold. */
@@ -271,7 +282,7 @@ public:
 
   /// Returns regular queue of elements
   /** \return A regular queue. */
-  const std::vector<ElementReference>& get_regular_queue() const { return regular_queue; };
+  const std::vector<ElementReference>& get_regular_queue() const { sort_regular_queue(regular_queue.size()); return regular_queue; };
 
   /// Returns a total number of active elements.
   /** \return A total number of active elements. If below 0, errors were not calculated yet, see set_solutions() */
@@ -291,7 +302,8 @@ public:
 
 protected: //adaptivity
   std::queue<ElementReference> priority_queue; ///< A queue of priority elements. Elements in this queue are processed before the elements in the Adapt::regular_queue.
-  std::vector<ElementReference> regular_queue; ///< A queue of elements which should be processes. The queue had to be filled by the method fill_regular_queue().
+  mutable std::vector<ElementReference> regular_queue; ///< A queue of elements which should be processes. The queue had to be filled by the method fill_regular_queue().
+  mutable int num_sorted; ///< A number of elements at the beginning of Adapt::regular_queue which are already in their final order, see sort_regular_queue().
   std::vector<ElementToRefine> last_refinements; ///< A vector of refinements generated during the last finished execution of the method adapt().
 
   /// Returns true if a given element should be ignored and not processed through refinement selection.
@@ -326,6 +338,33 @@ protected: //adaptivity
   /** \param[in] meshes An arrat of meshes of components. */
   void homogenize_shared_mesh_orders(Mesh** meshes);
 
+  /// Number of threads used by adapt() and calc_err_internal(), see set_num_threads().
+  int num_threads;
+
+  /// Data of one thread selecting the refinements.
+  struct SelectionThread;
+
+  /// Creates the data of num_threads threads selecting the refinements in adapt().
+  /** \return The data of the threads, or NULL if the refinements have to be selected by the calling thread. */
+  SelectionThread* init_selection_threads(Hermes::vector<RefinementSelectors::Selector *>& refinement_selectors, Mesh** meshes);
+
+  /// Selects the refinements of the elements regular_queue[first, last) by all threads.
+  /** \param[out] elem_refs The selected refinements. The index is the index in the regular queue minus \a first.
+   *  \param[out] refined True if a refinement was proposed, see RefinementSelectors::Selector::select_refinement(). */
+  void select_refinements(SelectionThread* threads, int first, int last, ElementToRefine* elem_refs, bool* refined);
+
+  /// Deletes the data of the threads created by init_selection_threads().
+  void free_selection_threads(SelectionThread* threads);
+
+  /// Thread function of select_refinements().
+  static void* selection_thread(void* data);
+
+  /// Data of one thread calculating the errors in calc_err_internal().
+  struct ErrorThread;
+
+  /// Thread function of calc_err_internal().
+  static void* error_thread(void* data);
+
 protected: // spaces & solutions
   int num;                              ///< Number of solution components (as in wf->neq).
   Hermes::vector<Space*> spaces;        ///< Spaces.
@@ -398,13 +437,18 @@ protected: //forms and error evaluation
    *  /param[in] meshes An array of pointers to meshes of a reference solution. An index into the array is an index of a component. */
   virtual void fill_regular_queue(Mesh** meshes);
 
+  /// Sorts at least the first \a count elements of Adapt::regular_queue.
+  /** The method fill_regular_queue() leaves the queue unsorted, the elements are then sorted
+   *  by parts (std::nth_element) as adapt() proceeds, which is usually a small part of the queue. */
+  void sort_regular_queue(int count) const;
+
 private:
   /// A functor that compares elements accoring to their error. Used by std::sort().
   class CompareElements {
   private:
-    double** errors; ///< A 2D array of squared errors: the first index is an index of component, the second index is an element ID.
+    double* const* errors; ///< A 2D array of squared errors: the first index is an index of component, the second index is an element ID.
   public:
-    CompareElements(double** errors): errors(errors) {}; ///< Constructor.
+    CompareElements(double* const* errors): errors(errors) {}; ///< Constructor.
     /// Compares two elements.
     /** \param[in] e1 A reference to the first element.
      *  \param[in] e1 A reference to the second element.
@@ -423,6 +423,7 @@ double KellyTypeAdapt::calc_err_internal(Hermes::vector<Solution *> slns,
     errors_squared_sum /= total_norm;
 
   // Prepare an ordered list of elements according to an error.
+  num_sorted = INT_MAX;
   fill_regular_queue(&(stage.meshes.front()));
   have_errors = true;
 
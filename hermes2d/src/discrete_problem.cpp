@@ -47,6 +47,53 @@ DiscreteProblem::DiscreteProblem(WeakForm* wf, Space* space, bool is_linear)
   init();
 }
 
+DiscreteProblem::DiscreteProblem(DiscreteProblem* master)
+   : wf(master->wf), is_linear(master->is_linear), wf_seq(-1), spaces(master->spaces)
+{
+  _F_
+  have_spaces = true;
+
+  // Internal variables settings.
+  sp_seq = new int[wf->get_neq()];
+  memset(sp_seq, -1, sizeof(int) * wf->get_neq());
+  num_threads = 1;
+  positions_matrix = NULL;
+  state_positions = NULL;
+  static_condensation = false;
+  condensed_index = NULL;
+  num_condensed_dofs = 0;
+  have_condensed_rhs = false;
+  master_problem = NULL;
+
+  // Matrix related settings.
+  matrix_buffer = NULL;
+  matrix_buffer_dim = 0;
+  have_matrix = false;
+  values_changed = true;
+  struct_changed = true;
+
+  // Own precalc shapesets, the dofs are already assigned by the master.
+  pss = new PrecalcShapeset*[wf->get_neq()];
+  for (unsigned int i = 0; i < wf->get_neq(); i++)
+    pss[i] = new PrecalcShapeset(spaces[i]->get_shapeset());
+  num_user_pss = wf->get_neq();
+  ndof = master->ndof;
+
+  element_markers_conversion = master->element_markers_conversion;
+  boundary_markers_conversion = master->boundary_markers_conversion;
+
+  this->is_fvm = master->is_fvm;
+  vector_valued_forms = master->vector_valued_forms;
+  DG_matrix_forms_present = false;
+  DG_vector_forms_present = false;
+
+  geom_ord = master->geom_ord;
+
+  // The elements are condensed into the data of the master.
+  static_condensation = master->static_condensation;
+  master_problem = master;
+}
+
 void DiscreteProblem::init()
 {
   _F_
@@ -61,6 +108,14 @@ void DiscreteProblem::init()
   // Internal variables settings.
   sp_seq = new int[wf->get_neq()];
   memset(sp_seq, -1, sizeof(int) * wf->get_neq());
+  num_threads = 1;
+  positions_matrix = NULL;
+  state_positions = NULL;
+  static_condensation = false;
+  condensed_index = NULL;
+  num_condensed_dofs = 0;
+  have_condensed_rhs = false;
+  master_problem = NULL;
 
   // Matrix related settings.
   matrix_buffer = NULL;
@@ -107,6 +162,7 @@ DiscreteProblem::~DiscreteProblem()
 {
   _F_
   free();
+  free_condensation();
   if (sp_seq != NULL) delete [] sp_seq;
   if (pss != NULL) {
     for(int i = 0; i < num_user_pss; i++)
@@ -122,6 +178,7 @@ void DiscreteProblem::free()
   if (wf != NULL)
     memset(sp_seq, -1, sizeof(int) * wf->get_neq());
   wf_seq = -1;
+  free_positions();
 }
 
 int DiscreteProblem::get_num_dofs()
@@ -179,10 +236,19 @@ void DiscreteProblem::create_sparse_structure(SparseMatrix* mat, Vector* rhs,
       verbose("Reusing matrix sparse structure.");
       mat->zero();
     }
-    if (rhs != NULL) rhs->zero();
+    // the rhs may be a different vector than the one assembled with the matrix
+    if (rhs != NULL)
+    {
+      int size = static_condensation ? num_condensed_dofs : get_num_dofs();
+      if (rhs->length() != (unsigned int) size) rhs->alloc(size);
+      else rhs->zero();
+    }
     return;
   }
 
+  // The positions in the old structure are no longer valid.
+  free_positions();
+
   // For DG, the sparse structure is different as we have to
   // account for over-edge calculations.
   bool is_DG = false;
@@ -219,77 +285,273 @@ void DiscreteProblem::create_sparse_structure(SparseMatrix* mat, Vector* rhs,
     // Spaces have changed: create the matrix from scratch.
     have_matrix = true;
     mat->free();
-    mat->prealloc(ndof);
-    AsmList* al = new AsmList[wf->get_neq()];
-    Mesh** meshes = new Mesh*[wf->get_neq()];
-    bool **blocks = wf->get_blocks(force_diagonal_blocks);
+    if (static_condensation)
+    {
+      init_condensation();
+      ndof = num_condensed_dofs;
+    }
+    build_sparse_structure(mat, ndof, force_diagonal_blocks, block_weights);
+  }
+  else if (static_condensation)
+    ndof = num_condensed_dofs;
 
-    // Init multi-mesh traversal.
-    for (unsigned int i = 0; i < wf->get_neq(); i++) meshes[i] = spaces[i]->get_mesh();
+  // WARNING: unlike Matrix::alloc(), Vector::alloc(ndof) frees the memory occupied
+  // by previous vector before allocating
+  if (rhs != NULL) rhs->alloc(ndof);
 
-    Traverse trav;
-    trav.begin(wf->get_neq(), meshes);
-
-    // Loop through all elements.
-    Element **e;
-    while ((e = trav.get_next_state(NULL, NULL)) != NULL) {
-      // Obtain assembly lists for the element at all spaces.
-      for (unsigned int i = 0; i < wf->get_neq(); i++) {
-        // TODO: do not get the assembly list again if the element was not changed.
-        if (e[i] != NULL) spaces[i]->get_element_assembly_list(e[i], &(al[i]));
-      }
+  // save space seq numbers and weakform seq number, so we can detect their changes
+  // (only together with the matrix structure, assembling the rhs alone must not
+  // make an outdated matrix structure look valid)
+  if (mat != NULL)
+  {
+    for (unsigned int i = 0; i < wf->get_neq(); i++) sp_seq[i] = spaces[i]->get_seq();
 
-      // Go through all equation-blocks of the local stiffness matrix.
-      for (unsigned int m = 0; m < wf->get_neq(); m++) {
-        for (unsigned int n = 0; n < wf->get_neq(); n++) {
+    wf_seq = wf->get_seq();
+  }
 
-          // Do not include blocks with zero weight except if
-          // (force_diagonal_blocks == true && this is a diagonal block).
-          bool is_diagonal_block = (m == n);
-          if (is_diagonal_block == false || force_diagonal_blocks == false) {
-            if (block_weights != NULL) {
-              if (fabs(block_weights->get_A(m, n)) < 1e-12) continue;
-            }
-          }
+  struct_changed = true;
+}
 
-          if (blocks[m][n] && e[m] != NULL && e[n] != NULL) {
-            AsmList *am = &(al[m]);
-            AsmList *an = &(al[n]);
-
-            // Pretend assembling of the element stiffness matrix.
-            for (unsigned int i = 0; i < am->cnt; i++) {
-              if (am->dof[i] >= 0) {
-                for (unsigned int j = 0; j < an->cnt; j++) {
-                  if (an->dof[j] >= 0) {
-                    mat->pre_add_ij(am->dof[i], an->dof[j]);
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
+struct DiscreteProblem::StructureThread
+{
+  DiscreteProblem* dp;
+  pthread_t thread;
+
+  // Index of the thread and the number of all threads.
+  int index;
+  int count;
+
+  // 1: count the entries of the columns, 2: store their rows, 3: sort the columns.
+  int pass;
+
+  // Size of the matrix and the index of the DOFs in the condensed system (NULL without it).
+  int ndof;
+  int* dof_index;
+
+  Hermes::vector<Mesh *> meshes;
+  bool** blocks;
+  bool force_diagonal_blocks;
+  Table* block_weights;
+
+  // Upper bounds of the numbers of entries of the columns found by this thread (pass 1),
+  // then the positions where this thread stores the next row of the columns (pass 2).
+  int* cnt;
+
+  // Offsets of the columns, their rows and their final lengths (pass 3).
+  int* ptr;
+  int* idx;
+  int* len;
+};
+
+void DiscreteProblem::build_sparse_structure(SparseMatrix* mat, int ndof,
+                                             bool force_diagonal_blocks, Table* block_weights)
+{
+  _F_
+  Hermes::vector<Mesh *> meshes;
+  for (unsigned int i = 0; i < wf->get_neq(); i++)
+    meshes.push_back(spaces[i]->get_mesh());
+  bool **blocks = wf->get_blocks(force_diagonal_blocks);
+
+  // Assembly lists switch the mode of the shared shapesets.
+  int count = Traverse::is_mode_uniform(meshes) ? num_threads : 1;
+
+  StructureThread* threads = new StructureThread[count];
+  for (int t = 0; t < count; t++) {
+    StructureThread* st = threads + t;
+    st->dp = this;
+    st->index = t;
+    st->count = count;
+    st->meshes = meshes;
+    st->blocks = blocks;
+    st->force_diagonal_blocks = force_diagonal_blocks;
+    st->block_weights = block_weights;
+    st->ndof = ndof;
+    st->dof_index = static_condensation ? condensed_index : NULL;
+    st->cnt = new int[ndof];
+    memset(st->cnt, 0, sizeof(int) * ndof);
+    st->ptr = st->idx = st->len = NULL;
+  }
+
+  // The first pass counts the entries of the columns (including duplicities),
+  // every thread then stores its rows of a column behind the rows of the previous threads.
+  build_structure_pass(threads, 1);
+
+  int* ptr = new int[ndof + 1];
+  int total = 0;
+  for (int col = 0; col < ndof; col++) {
+    ptr[col] = total;
+    for (int t = 0; t < count; t++) {
+      int n = threads[t].cnt[col];
+      threads[t].cnt[col] = total;
+      total += n;
     }
+  }
+  ptr[ndof] = total;
 
-    trav.finish();
+  int* idx = new int[total];
+  for (int t = 0; t < count; t++)
+    threads[t].idx = idx;
+  build_structure_pass(threads, 2);
 
-    delete [] al;
-    delete [] meshes;
-    delete [] blocks;
+  // Sort the columns and remove the duplicities, then close the gaps.
+  int* len = threads[0].cnt;
+  for (int t = 0; t < count; t++) {
+    threads[t].ptr = ptr;
+    threads[t].len = len;
+  }
+  build_structure_pass(threads, 3);
 
-    mat->alloc();
+  int pos = 0;
+  for (int col = 0; col < ndof; col++) {
+    int start = ptr[col];
+    ptr[col] = pos;
+    memmove(idx + pos, idx + start, sizeof(int) * len[col]);
+    pos += len[col];
   }
+  ptr[ndof] = pos;
 
-  // WARNING: unlike Matrix::alloc(), Vector::alloc(ndof) frees the memory occupied
-  // by previous vector before allocating
-  if (rhs != NULL) rhs->alloc(ndof);
+  mat->alloc_structure(ndof, ptr, idx);
 
-  // save space seq numbers and weakform seq number, so we can detect their changes
-  for (unsigned int i = 0; i < wf->get_neq(); i++) sp_seq[i] = spaces[i]->get_seq();
+  for (int t = 0; t < count; t++)
+    delete [] threads[t].cnt;
+  delete [] threads;
+  delete [] ptr;
+  delete [] idx;
+  delete [] blocks;
+}
 
-  wf_seq = wf->get_seq();
+void DiscreteProblem::build_structure_pass(StructureThread* threads, int pass)
+{
+  _F_
+  int count = threads[0].count;
+  for (int t = 0; t < count; t++)
+    threads[t].pass = pass;
+
+  // The first part is done by the calling thread.
+  for (int t = 1; t < count; t++)
+    if (pthread_create(&threads[t].thread, NULL, structure_thread, threads + t) != 0)
+      error("Could not create a thread in DiscreteProblem::build_structure_pass().");
+  structure_thread(threads);
+  for (int t = 1; t < count; t++)
+    pthread_join(threads[t].thread, NULL);
+}
 
-  struct_changed = true;
+void* DiscreteProblem::structure_thread(void* data)
+{
+  StructureThread* st = (StructureThread *) data;
+  DiscreteProblem* dp = st->dp;
+  unsigned int neq = dp->wf->get_neq();
+
+  // Every thread sorts a contiguous range of columns.
+  if (st->pass == 3) {
+    int ndof = st->ndof;
+    int first = (int) ((long long) ndof * st->index / st->count);
+    int last = (int) ((long long) ndof * (st->index + 1) / st->count);
+    for (int col = first; col < last; col++) {
+      int* begin = st->idx + st->ptr[col];
+      int* end = st->idx + st->ptr[col + 1];
+      std::sort(begin, end);
+      st->len[col] = std::unique(begin, end) - begin;
+    }
+    return NULL;
+  }
+
+  AsmList* al = new AsmList[neq];
+  int* nrows = new int[neq];
+
+  // With a single mesh, every thread takes a range of element ids. Otherwise the states
+  // of the multi-mesh traversal are dealt round-robin among the threads.
+  Mesh* mesh = st->meshes[0];
+  for (unsigned int i = 1; i < neq; i++)
+    if (st->meshes[i] != mesh) mesh = NULL;
+
+  Traverse trav;
+  Element** single = new Element*[neq];
+  int id = 0, last = 0;
+  if (mesh != NULL) {
+    int max = mesh->get_max_element_id();
+    id = (int) ((long long) max * st->index / st->count);
+    last = (int) ((long long) max * (st->index + 1) / st->count);
+  }
+  else
+    trav.begin(neq, &(st->meshes.front()));
+
+  Element **e;
+  int state = 0;
+  while (true) {
+    if (mesh != NULL) {
+      while (id < last && (!mesh->get_element_fast(id)->used || !mesh->get_element_fast(id)->active))
+        id++;
+      if (id >= last)
+        break;
+      for (unsigned int i = 0; i < neq; i++)
+        single[i] = mesh->get_element_fast(id);
+      id++;
+      e = single;
+    }
+    else {
+      if ((e = trav.get_next_state(NULL, NULL)) == NULL)
+        break;
+      if (state++ % st->count != st->index)
+        continue;
+    }
+
+    // Obtain assembly lists for the element at all spaces.
+    for (unsigned int i = 0; i < neq; i++) {
+      nrows[i] = 0;
+      if (e[i] == NULL)
+        continue;
+      dp->spaces[i]->get_element_assembly_list(e[i], &(al[i]));
+      for (unsigned int j = 0; j < al[i].cnt; j++) {
+        // The eliminated DOFs are left out of the condensed matrix.
+        if (st->dof_index != NULL && al[i].dof[j] >= 0)
+          al[i].dof[j] = st->dof_index[al[i].dof[j]];
+        if (al[i].dof[j] >= 0) nrows[i]++;
+      }
+    }
+
+    // Go through all equation-blocks of the local stiffness matrix.
+    for (unsigned int m = 0; m < neq; m++) {
+      for (unsigned int n = 0; n < neq; n++) {
+
+        // Do not include blocks with zero weight except if
+        // (force_diagonal_blocks == true && this is a diagonal block).
+        // The Schur complement of the bubbles couples all components of the element.
+        bool is_diagonal_block = (m == n);
+        if (st->dof_index == NULL && (is_diagonal_block == false || st->force_diagonal_blocks == false)) {
+          if (st->block_weights != NULL) {
+            if (fabs(st->block_weights->get_A(m, n)) < 1e-12) continue;
+          }
+        }
+
+        if ((st->blocks[m][n] || st->dof_index != NULL) && e[m] != NULL && e[n] != NULL) {
+          AsmList *am = &(al[m]);
+          AsmList *an = &(al[n]);
+
+          // Pretend assembling of the element stiffness matrix.
+          for (unsigned int j = 0; j < an->cnt; j++) {
+            int col = an->dof[j];
+            if (col < 0)
+              continue;
+            if (st->pass == 1)
+              st->cnt[col] += nrows[m];
+            else
+              for (unsigned int i = 0; i < am->cnt; i++)
+                if (am->dof[i] >= 0)
+                  st->idx[st->cnt[col]++] = am->dof[i];
+          }
+        }
+      }
+    }
+  }
+
+  if (mesh == NULL)
+    trav.finish();
+
+  delete [] al;
+  delete [] nrows;
+  delete [] single;
+  return NULL;
 }
 
 //// assembly ////////////////////////////////////////////////////////////////////
@@ -366,6 +628,10 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat,
   // Sanity checks.
   assemble_sanity_checks(block_weights);
 
+  // The right hand side is condensed by the blocks of the matrix.
+  if (static_condensation && mat == NULL && !is_up_to_date())
+    error("The matrix has to be assembled before the right hand side alone in the static condensation.");
+
   // Creating matrix sparse structure.
   create_sparse_structure(mat, rhs, force_diagonal_blocks, block_weights);
 
@@ -412,6 +678,10 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat,
                        block_weights, spss, refmap, u_ext);
   }
 
+  // The bubble DOFs are recovered by the right hand side condensed with the last matrix.
+  if (static_condensation)
+    have_condensed_rhs = (rhs != NULL) || (mat == NULL && have_condensed_rhs);
+
   // Deinitialize matrix buffer.
   if(matrix_buffer != NULL)
     delete [] matrix_buffer;
@@ -481,10 +751,40 @@ void DiscreteProblem::assemble_one_stage(WeakForm::Stage& stage,
     }
   }
 
+  // Every state has to be one whole element to eliminate its bubbles.
+  if (static_condensation) {
+    if (DG_matrix_forms_present || DG_vector_forms_present)
+      error("The static condensation is not possible with DG forms.");
+    for (unsigned int i = 0; i < stage.meshes.size(); i++)
+      if (stage.meshes[i]->get_seq() != spaces[0]->get_mesh()->get_seq())
+        error("The static condensation needs all spaces and external functions on one mesh.");
+  }
+
+  // Let several threads assemble the stage, if possible.
+  if (num_threads > 1 && !DG_matrix_forms_present && !DG_vector_forms_present
+      && is_stage_threadable(stage)) {
+    trav.finish();
+    assemble_one_stage_threaded(stage, matrix, rhs, force_diagonal_blocks,
+                                block_weights, u_ext);
+    if (matrix != NULL) matrix->finish();
+    if (rhs != NULL) rhs->finish();
+    return;
+  }
+
+  // The condensed elements are not added by the cached positions.
+  StagePositions* sp = static_condensation ? NULL : get_stage_positions(stage, matrix);
+
   // Loop through all assembling states.
   // Assemble each one.
   Element** e;
+  unsigned int state = 0;
   while ((e = trav.get_next_state(bnd, surf_pos)) != NULL) {
+    if (sp != NULL) {
+      if (state == sp->states.size())
+        sp->states.resize(state + 1);
+      state_positions = &sp->states[state++];
+    }
+
     // One state is a collection of (virtual) elements sharing
     // the same physical location on (possibly) different meshes.
     // This is then the same element of the virtual union mesh.
@@ -495,6 +795,7 @@ void DiscreteProblem::assemble_one_stage(WeakForm::Stage& stage,
                        block_weights, spss, refmap,
                        u_ext, e, bnd, surf_pos, trav.get_base());
   }
+  state_positions = NULL;
 
   if (matrix != NULL) matrix->finish();
   if (rhs != NULL) rhs->finish();
@@ -508,6 +809,809 @@ void DiscreteProblem::assemble_one_stage(WeakForm::Stage& stage,
   }
 }
 
+//// threaded assembling /////////////////////////////////////////////////////////
+
+// Matrix private to one assembling thread. The values added to the positions found in the
+// global matrix are summed by the positions, the other values are kept as triplets. Both are
+// added to the global matrix when all threads are finished.
+class AssemblingMatrix : public SparseMatrix
+{
+public:
+  AssemblingMatrix(SparseMatrix* mat) : SparseMatrix(mat->get_size()), mat(mat), diagonal(0.0) { }
+
+  virtual void alloc() { }
+  virtual void free() { zero(); }
+  virtual scalar get(unsigned int m, unsigned int n) { return 0.0; }
+  virtual void zero()
+  {
+    values.clear();
+    rows.clear();
+    cols.clear();
+    triplets.clear();
+    diagonal = 0.0;
+  }
+  virtual void add_to_diagonal(scalar v) { diagonal += v; }
+  virtual void add(unsigned int m, unsigned int n, scalar v)
+  {
+    if ((int) m < 0 || (int) n < 0) return;
+    rows.push_back(m);
+    cols.push_back(n);
+    triplets.push_back(v);
+  }
+  virtual void add(unsigned int m, unsigned int n, scalar **matrix, int *rows, int *cols)
+  {
+    for (unsigned int i = 0; i < m; i++)
+      for (unsigned int j = 0; j < n; j++)
+        if (rows[i] >= 0 && cols[j] >= 0)
+          add(rows[i], cols[j], matrix[i][j]);
+  }
+  // The sparse structure of the global matrix is not changed during the assembling.
+  virtual bool find_positions(unsigned int m, unsigned int n, int *rows, int *cols, int *pos)
+  {
+    return mat->find_positions(m, n, rows, cols, pos);
+  }
+  virtual void add_to_positions(unsigned int m, unsigned int n, scalar **matrix, int *pos)
+  {
+    for (unsigned int i = 0; i < m; i++)
+      for (unsigned int j = 0; j < n; j++) {
+        int p = pos[i * n + j];
+        if (p >= 0) {
+          if ((unsigned int) p >= values.size())
+            values.resize(p + 1, 0.0);
+          values[p] += matrix[i][j];
+        }
+        else if (p == -2 && matrix[i][j] != 0.0)
+          error("Sparse matrix entry not found");
+      }
+  }
+  virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE)
+  {
+    return false;
+  }
+  virtual unsigned int get_matrix_size() const
+  {
+    return (values.size() + triplets.size()) * sizeof(scalar) + (rows.size() + cols.size()) * sizeof(unsigned int);
+  }
+  virtual double get_fill_in() const { return 0.0; }
+
+  // Adds the triplets and the diagonal to the global matrix.
+  void add_triplets()
+  {
+    for (unsigned int i = 0; i < triplets.size(); i++)
+      mat->add(rows[i], cols[i], triplets[i]);
+    if (diagonal != 0.0)
+      mat->add_to_diagonal(diagonal);
+  }
+
+  SparseMatrix* mat;
+  std::vector<scalar> values;   // values by the positions in the global matrix
+  std::vector<unsigned int> rows, cols;
+  std::vector<scalar> triplets;
+  scalar diagonal;
+};
+
+// Right hand side private to one assembling thread, added to the global one
+// when all threads are finished.
+class AssemblingVector : public Vector
+{
+public:
+  AssemblingVector(unsigned int n) : v(NULL) { alloc(n); }
+  virtual ~AssemblingVector() { free(); }
+
+  virtual void alloc(unsigned int n)
+  {
+    free();
+    size = n;
+    v = new scalar[n];
+    zero();
+  }
+  virtual void free()
+  {
+    delete [] v;
+    v = NULL;
+    size = 0;
+  }
+  virtual scalar get(unsigned int idx) { return v[idx]; }
+  virtual void extract(scalar *w) const { memcpy(w, v, size * sizeof(scalar)); }
+  virtual void zero() { memset(v, 0, size * sizeof(scalar)); }
+  virtual void change_sign()
+  {
+    for (unsigned int i = 0; i < size; i++) v[i] = -v[i];
+  }
+  virtual void set(unsigned int idx, scalar y) { v[idx] = y; }
+  virtual void add(unsigned int idx, scalar y) { v[idx] += y; }
+  virtual void add_vector(Vector* vec)
+  {
+    for (unsigned int i = 0; i < size; i++) v[i] += vec->get(i);
+  }
+  virtual void add_vector(scalar* vec)
+  {
+    for (unsigned int i = 0; i < size; i++) v[i] += vec[i];
+  }
+  virtual void add(unsigned int n, unsigned int *idx, scalar *y)
+  {
+    for (unsigned int i = 0; i < n; i++) v[idx[i]] += y[i];
+  }
+  virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE)
+  {
+    return false;
+  }
+
+  scalar* get_values() { return v; }
+
+protected:
+  scalar* v;
+};
+
+struct DiscreteProblem::AssemblingThread
+{
+  DiscreteProblem* dp;
+  pthread_t thread;
+
+  // Base elements [first_base, last_base) of the thread, first_state is the index of the first state.
+  int first_base, last_base;
+  unsigned int first_state;
+
+  // Copy of the stage referring to the functions of the worker.
+  WeakForm::Stage stage;
+
+  AssemblingMatrix* matrix;
+  AssemblingVector* rhs;
+  bool force_diagonal_blocks;
+  Table* block_weights;
+
+  // Cached positions of the stage, shared by the threads (each writes its own states).
+  StagePositions* positions;
+
+  Hermes::vector<PrecalcShapeset *> spss;
+  Hermes::vector<RefMap *> refmap;
+  Hermes::vector<Solution *> u_ext;
+};
+
+struct DiscreteProblem::MergingThread
+{
+  pthread_t thread;
+
+  AssemblingThread* threads;
+  int count;
+
+  SparseMatrix* matrix;
+  unsigned int first, last;   // range of the positions
+};
+
+void DiscreteProblem::set_num_threads(int num_threads)
+{
+  _F_
+  if (num_threads < 1)
+    error("Number of assembling threads must be positive in DiscreteProblem::set_num_threads().");
+  this->num_threads = num_threads;
+}
+
+MeshFunction* DiscreteProblem::get_ext_fn(MeshFunction* fn)
+{
+  if (ext_copies.empty())
+    return fn;
+
+  std::map<MeshFunction*, MeshFunction*>::iterator it = ext_copies.find(fn);
+  return (it != ext_copies.end()) ? it->second : fn;
+}
+
+bool DiscreteProblem::is_stage_threadable(WeakForm::Stage& stage)
+{
+  _F_
+  // Every thread works with its own copies of the external functions,
+  // which is possible for Solutions only.
+  for (unsigned int i = 0; i < stage.ext.size(); i++) {
+    Solution* sln = dynamic_cast<Solution*>(stage.ext[i]);
+    if (sln == NULL || (sln->get_type() != HERMES_SLN && sln->get_type() != HERMES_CONST))
+      return false;
+  }
+
+  // Adaptive quadrature transforms the original external functions.
+  for (unsigned int i = 0; i < stage.mfvol.size(); i++)
+    if (stage.mfvol[i]->adapt_eval) return false;
+  for (unsigned int i = 0; i < stage.mfsurf.size(); i++)
+    if (stage.mfsurf[i]->adapt_eval) return false;
+  for (unsigned int i = 0; i < stage.vfvol.size(); i++)
+    if (stage.vfvol[i]->adapt_eval) return false;
+  for (unsigned int i = 0; i < stage.vfsurf.size(); i++)
+    if (stage.vfsurf[i]->adapt_eval) return false;
+
+  return Traverse::is_mode_uniform(stage.meshes);
+}
+
+void DiscreteProblem::assemble_one_stage_threaded(WeakForm::Stage& stage,
+                                                  SparseMatrix* matrix, Vector* rhs,
+                                                  bool force_diagonal_blocks, Table* block_weights,
+                                                  Hermes::vector<Solution *>& u_ext)
+{
+  _F_
+  // Constrained edge functions of the shapesets and orders of the inverse reference
+  // maps are calculated on their first use. Do it now, so that the threads only read them.
+  std::set<Mesh *> meshes;
+  for (unsigned int i = 0; i < stage.meshes.size(); i++)
+    meshes.insert(stage.meshes[i]);
+
+  AsmList al;
+  for (unsigned int i = 0; i < stage.idx.size(); i++) {
+    Space* space = spaces[stage.idx[i]];
+    Element* e;
+    for_all_active_elements(e, space->get_mesh()) {
+      space->get_element_assembly_list(e, &al);
+      for (unsigned int j = 0; j < al.cnt; j++)
+        if (al.idx[j] < 0)
+          space->get_shapeset()->get_fn_value(al.idx[j], 0.0, 0.0, 0);
+    }
+  }
+
+  RefMap rm;
+  for (std::set<Mesh *>::iterator it = meshes.begin(); it != meshes.end(); it++) {
+    Element* e;
+    for_all_active_elements(e, *it)
+      rm.set_active_element(e);
+  }
+
+  // Every thread takes a contiguous range of the base elements.
+  int* bounds = new int[num_threads + 1];
+  Traverse::split_base_elements(stage.meshes.size(), &(stage.meshes.front()), num_threads, bounds);
+
+  // The threads fill in the positions of their states, so all states have to exist
+  // and every thread needs the index of its first state.
+  StagePositions* sp = static_condensation ? NULL : get_stage_positions(stage, matrix);
+  if (sp != NULL && sp->base_states.empty()) {
+    bool bnd[4];
+    SurfPos surf_pos[4];
+    Traverse trav;
+    trav.begin(stage.meshes.size(), &(stage.meshes.front()), &(stage.fns.front()));
+    int num_base = stage.meshes[0]->get_num_base_elements();
+    sp->base_states.resize(num_base + 1, 0);
+    unsigned int num_states = 0;
+    while (trav.get_next_state(bnd, surf_pos) != NULL) {
+      sp->base_states[trav.get_base()->id + 1]++;
+      num_states++;
+    }
+    trav.finish();
+    for (int i = 0; i < num_base; i++)
+      sp->base_states[i + 1] += sp->base_states[i];
+    if (sp->states.size() < num_states)
+      sp->states.resize(num_states);
+  }
+
+  // Everything the threads use is created here, as the constructors of shapesets
+  // and reference maps switch the mode of the shared shapesets.
+  AssemblingThread* threads = new AssemblingThread[num_threads];
+  for (int t = 0; t < num_threads; t++) {
+    AssemblingThread* at = threads + t;
+    at->dp = new DiscreteProblem(this);
+    at->first_base = bounds[t];
+    at->last_base = bounds[t + 1];
+    at->first_state = (sp != NULL) ? sp->base_states[bounds[t]] : 0;
+    at->matrix = (matrix != NULL) ? new AssemblingMatrix(matrix) : NULL;
+    at->rhs = (rhs != NULL) ? new AssemblingVector(rhs->length()) : NULL;
+    at->force_diagonal_blocks = force_diagonal_blocks;
+    at->block_weights = block_weights;
+    at->positions = sp;
+
+    at->stage = stage;
+    for (unsigned int i = 0; i < stage.idx.size(); i++)
+      at->stage.fns[i] = at->dp->pss[stage.idx[i]];
+    for (unsigned int i = 0; i < stage.ext.size(); i++) {
+      Solution* sln = new Solution();
+      sln->copy(static_cast<Solution*>(stage.ext[i]), false);
+      sln->set_quad_2d(&g_quad_2d_std);
+      sln->use_private_refmap_pss();
+      at->dp->ext_copies[stage.ext[i]] = sln;
+      at->stage.ext[i] = sln;
+      at->stage.fns[stage.idx.size() + i] = sln;
+    }
+    // Previous Newton iterations are among the external functions of every stage.
+    for (unsigned int i = 0; i < u_ext.size(); i++)
+      at->u_ext.push_back((u_ext[i] != NULL) ? static_cast<Solution*>(at->dp->get_ext_fn(u_ext[i])) : NULL);
+
+    at->dp->initialize_psss(at->spss);
+    at->dp->initialize_refmaps(at->refmap);
+    for (unsigned int i = 0; i < at->refmap.size(); i++)
+      at->refmap[i]->use_private_pss();
+  }
+
+  // The first part is assembled by the calling thread.
+  for (int t = 1; t < num_threads; t++)
+    if (pthread_create(&threads[t].thread, NULL, assemble_thread, threads + t) != 0)
+      error("Could not create an assembling thread in DiscreteProblem::assemble_one_stage_threaded().");
+  assemble_thread(threads);
+  for (int t = 1; t < num_threads; t++)
+    pthread_join(threads[t].thread, NULL);
+  delete [] bounds;
+
+  // Add the thread matrices to the global one, every thread adds a range of the positions.
+  if (matrix != NULL) {
+    unsigned int num_values = 0;
+    for (int t = 0; t < num_threads; t++)
+      num_values = std::max(num_values, (unsigned int) threads[t].matrix->values.size());
+
+    MergingThread* merging = new MergingThread[num_threads];
+    for (int t = 0; t < num_threads; t++) {
+      merging[t].threads = threads;
+      merging[t].count = num_threads;
+      merging[t].matrix = matrix;
+      merging[t].first = (unsigned int) ((long long) num_values * t / num_threads);
+      merging[t].last = (unsigned int) ((long long) num_values * (t + 1) / num_threads);
+    }
+    for (int t = 1; t < num_threads; t++)
+      if (pthread_create(&merging[t].thread, NULL, merge_thread, merging + t) != 0)
+        error("Could not create a merging thread in DiscreteProblem::assemble_one_stage_threaded().");
+    merge_thread(merging);
+    for (int t = 1; t < num_threads; t++)
+      pthread_join(merging[t].thread, NULL);
+    delete [] merging;
+
+    // The values without positions are added by the calling thread.
+    for (int t = 0; t < num_threads; t++) {
+      threads[t].matrix->add_triplets();
+      delete threads[t].matrix;
+    }
+  }
+
+  // Sum the right hand sides, clean up.
+  for (int t = 0; t < num_threads; t++) {
+    AssemblingThread* at = threads + t;
+    if (at->rhs != NULL) {
+      rhs->add_vector(at->rhs->get_values());
+      delete at->rhs;
+    }
+
+    for (unsigned int i = 0; i < at->spss.size(); i++)
+      delete at->spss[i];
+    for (unsigned int i = 0; i < at->refmap.size(); i++)
+      delete at->refmap[i];
+    for (unsigned int i = 0; i < stage.ext.size(); i++)
+      delete at->stage.ext[i];
+    delete at->dp;
+  }
+  delete [] threads;
+}
+
+void* DiscreteProblem::assemble_thread(void* data)
+{
+  AssemblingThread* at = (AssemblingThread *) data;
+  DiscreteProblem* dp = at->dp;
+
+  bool bnd[4];
+  SurfPos surf_pos[4];
+
+  Traverse trav;
+  trav.begin(at->stage.meshes.size(), &(at->stage.meshes.front()), &(at->stage.fns.front()));
+  trav.set_base_range(at->first_base, at->last_base);
+
+  Element** e;
+  unsigned int state = at->first_state;
+  while ((e = trav.get_next_state(bnd, surf_pos)) != NULL) {
+    if (at->positions != NULL)
+      dp->state_positions = &at->positions->states[state++];
+    dp->assemble_one_state(at->stage, at->matrix, at->rhs, at->force_diagonal_blocks,
+                           at->block_weights, at->spss, at->refmap,
+                           at->u_ext, e, bnd, surf_pos, trav.get_base());
+  }
+
+  dp->state_positions = NULL;
+
+  trav.finish();
+  return NULL;
+}
+
+void* DiscreteProblem::merge_thread(void* data)
+{
+  MergingThread* mt = (MergingThread *) data;
+  if (mt->first >= mt->last)
+    return NULL;
+
+  // The ranges of the positions are disjoint, so the threads add to the global matrix at once.
+  unsigned int n = mt->last - mt->first;
+  scalar* sum = new scalar[n];
+  int* pos = new int[n];
+  for (unsigned int i = 0; i < n; i++) {
+    sum[i] = 0.0;
+    pos[i] = mt->first + i;
+  }
+  for (int t = 0; t < mt->count; t++) {
+    std::vector<scalar>& values = mt->threads[t].matrix->values;
+    unsigned int last = std::min(mt->last, (unsigned int) values.size());
+    for (unsigned int p = mt->first; p < last; p++)
+      sum[p - mt->first] += values[p];
+  }
+  mt->matrix->add_to_positions(1, n, &sum, pos);
+
+  delete [] sum;
+  delete [] pos;
+  return NULL;
+}
+
+//// static condensation ///////////////////////////////////////////////////////
+
+// LU decomposition with partial pivoting of the n x n matrix a (stored by rows).
+static void condensed_lu(scalar* a, int n, int* piv)
+{
+  for (int k = 0; k < n; k++) {
+    int p = k;
+    for (int i = k + 1; i < n; i++)
+      if (std::abs(a[i * n + k]) > std::abs(a[p * n + k])) p = i;
+    piv[k] = p;
+    if (p != k)
+      for (int j = 0; j < n; j++) std::swap(a[k * n + j], a[p * n + j]);
+    if (a[k * n + k] == 0.0) error("Singular block of eliminated DOFs in the static condensation.");
+    for (int i = k + 1; i < n; i++) {
+      scalar f = (a[i * n + k] /= a[k * n + k]);
+      for (int j = k + 1; j < n; j++) a[i * n + j] -= f * a[k * n + j];
+    }
+  }
+}
+
+// Solves with the decomposition by condensed_lu() for m right hand sides (n x m, stored by rows).
+static void condensed_lu_solve(scalar* a, int n, int* piv, scalar* b, int m)
+{
+  for (int k = 0; k < n; k++)
+    if (piv[k] != k)
+      for (int j = 0; j < m; j++) std::swap(b[k * m + j], b[piv[k] * m + j]);
+  for (int k = 0; k < n; k++)
+    for (int i = k + 1; i < n; i++)
+      for (int j = 0; j < m; j++) b[i * m + j] -= a[i * n + k] * b[k * m + j];
+  for (int k = n - 1; k >= 0; k--) {
+    for (int j = 0; j < m; j++) b[k * m + j] /= a[k * n + k];
+    for (int i = 0; i < k; i++)
+      for (int j = 0; j < m; j++) b[i * m + j] -= a[i * n + k] * b[k * m + j];
+  }
+}
+
+struct DiscreteProblem::CondensedBlock
+{
+  std::vector<int> dofs;        // the eliminated DOFs
+  std::vector<int> cols;        // the kept DOFs of the element
+  std::vector<scalar> lu;       // decomposition of A(dofs, dofs)
+  std::vector<int> piv;
+  std::vector<scalar> a_rows;   // A(cols, dofs)
+  std::vector<scalar> x;        // A(dofs, dofs)^-1 A(dofs, cols)
+  std::vector<scalar> z;        // A(dofs, dofs)^-1 b(dofs) of the last right hand side
+};
+
+// Local matrix of the DOFs of one element (sorted), the forms add to it by the global DOFs.
+class DiscreteProblem::ElementMatrix : public SparseMatrix
+{
+public:
+  ElementMatrix(std::vector<int>& dofs) : SparseMatrix(dofs.size()), dofs(dofs), a(dofs.size() * dofs.size(), 0.0) { }
+
+  int local(int dof) { return std::lower_bound(dofs.begin(), dofs.end(), dof) - dofs.begin(); }
+
+  virtual void alloc() { }
+  virtual void free() { }
+  virtual scalar get(unsigned int m, unsigned int n) { return a[m * size + n]; }
+  virtual void zero() { std::fill(a.begin(), a.end(), 0.0); }
+  virtual void add_to_diagonal(scalar v)
+  {
+    for (unsigned int i = 0; i < size; i++) a[i * size + i] += v;
+  }
+  virtual void add(unsigned int m, unsigned int n, scalar v)
+  {
+    if ((int) m >= 0 && (int) n >= 0) a[local(m) * size + local(n)] += v;
+  }
+  virtual void add(unsigned int m, unsigned int n, scalar **matrix, int *rows, int *cols)
+  {
+    for (unsigned int i = 0; i < m; i++) {
+      if (rows[i] < 0) continue;
+      scalar* row = &a[local(rows[i]) * size];
+      for (unsigned int j = 0; j < n; j++)
+        if (cols[j] >= 0) row[local(cols[j])] += matrix[i][j];
+    }
+  }
+  virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE) { return false; }
+  virtual unsigned int get_matrix_size() const { return a.size() * sizeof(scalar); }
+  virtual double get_fill_in() const { return 1.0; }
+
+  std::vector<int>& dofs;
+  std::vector<scalar> a;
+};
+
+// Local right hand side of the DOFs of one element.
+class DiscreteProblem::ElementVector : public Vector
+{
+public:
+  ElementVector(ElementMatrix* em) : em(em), b(em->dofs.size(), 0.0) { size = b.size(); }
+
+  virtual void alloc(unsigned int n) { b.assign(n, 0.0); size = n; }
+  virtual void free() { }
+  virtual scalar get(unsigned int idx) { return b[em->local(idx)]; }
+  virtual void extract(scalar *v) const { }
+  virtual void zero() { std::fill(b.begin(), b.end(), 0.0); }
+  virtual void change_sign()
+  {
+    for (unsigned int i = 0; i < size; i++) b[i] = -b[i];
+  }
+  virtual void set(unsigned int idx, scalar y) { b[em->local(idx)] = y; }
+  virtual void add(unsigned int idx, scalar y) { b[em->local(idx)] += y; }
+  virtual void add_vector(Vector* vec) { error("Not supported by the static condensation."); }
+  virtual void add_vector(scalar* vec) { error("Not supported by the static condensation."); }
+  virtual void add(unsigned int n, unsigned int *idx, scalar *y)
+  {
+    for (unsigned int i = 0; i < n; i++) b[em->local(idx[i])] += y[i];
+  }
+  virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE) { return false; }
+
+  ElementMatrix* em;
+  std::vector<scalar> b;
+};
+
+void DiscreteProblem::set_static_condensation(bool static_condensation)
+{
+  _F_
+  // The matrices passed to assemble() change their size.
+  if (static_condensation != this->static_condensation) {
+    free_condensation();
+    have_matrix = false;
+  }
+  this->static_condensation = static_condensation;
+}
+
+void DiscreteProblem::free_condensation()
+{
+  _F_
+  for (unsigned int i = 0; i < condensed_blocks.size(); i++)
+    if (condensed_blocks[i] != NULL) delete condensed_blocks[i];
+  condensed_blocks.clear();
+  if (condensed_index != NULL) delete [] condensed_index;
+  condensed_index = NULL;
+  num_condensed_dofs = 0;
+  have_condensed_rhs = false;
+}
+
+void DiscreteProblem::init_condensation()
+{
+  _F_
+  free_condensation();
+  Mesh* mesh = spaces[0]->get_mesh();
+  for (unsigned int i = 1; i < spaces.size(); i++)
+    if (spaces[i]->get_mesh()->get_seq() != mesh->get_seq())
+      error("The static condensation needs all spaces on one mesh.");
+
+  int ndof = get_num_dofs();
+  condensed_index = new int[ndof];
+  for (int i = 0; i < ndof; i++)
+    condensed_index[i] = 0;
+
+  // The bubble DOFs of every element are eliminated.
+  condensed_blocks.resize(mesh->get_max_element_id(), NULL);
+  AsmList al;
+  for (unsigned int i = 0; i < spaces.size(); i++) {
+    Element* e;
+    for_all_active_elements(e, spaces[i]->get_mesh()) {
+      al.cnt = 0;
+      spaces[i]->get_shapeset()->set_mode(e->get_mode());
+      spaces[i]->get_bubble_assembly_list(e, &al);
+      for (unsigned int k = 0; k < al.cnt; k++)
+        if (al.dof[k] >= 0) {
+          condensed_index[al.dof[k]] = -1;
+          if (condensed_blocks[e->id] == NULL)
+            condensed_blocks[e->id] = new CondensedBlock;
+        }
+    }
+  }
+
+  for (int i = 0; i < ndof; i++)
+    condensed_index[i] = (condensed_index[i] < 0) ? -1 : num_condensed_dofs++;
+}
+
+void DiscreteProblem::condense_element(Element* e, ElementMatrix* em, ElementVector* ev,
+                                       SparseMatrix* mat, Vector* rhs)
+{
+  _F_
+  // Workers of the threaded assembling write the blocks of their own elements.
+  DiscreteProblem* owner = (master_problem != NULL) ? master_problem : this;
+  int* index = owner->condensed_index;
+  CondensedBlock* cb = owner->condensed_blocks[e->id];
+
+  int n = em->dofs.size();
+  std::vector<int> kept, elim;
+  for (int i = 0; i < n; i++) {
+    if (index[em->dofs[i]] >= 0) kept.push_back(i);
+    else elim.push_back(i);
+  }
+  int nb = elim.size(), nk = kept.size();
+  if (nb > 0 && cb == NULL)
+    error("Bubble DOFs of an element unknown to the static condensation.");
+
+  std::vector<int> rows(nk);
+  for (int r = 0; r < nk; r++)
+    rows[r] = index[em->dofs[kept[r]]];
+
+  if (mat != NULL) {
+    scalar* a = &em->a[0];
+    scalar** s = get_matrix_buffer(std::max(nk, 1));
+    for (int r = 0; r < nk; r++)
+      for (int c = 0; c < nk; c++) s[r][c] = a[kept[r] * n + kept[c]];
+
+    if (nb > 0) {
+      cb->dofs.resize(nb);
+      cb->cols.resize(nk);
+      cb->lu.resize(nb * nb);
+      cb->piv.resize(nb);
+      cb->a_rows.resize(nk * nb);
+      cb->x.resize(nb * nk);
+      for (int t = 0; t < nb; t++) {
+        cb->dofs[t] = em->dofs[elim[t]];
+        for (int u = 0; u < nb; u++) cb->lu[t * nb + u] = a[elim[t] * n + elim[u]];
+        for (int c = 0; c < nk; c++) cb->x[t * nk + c] = a[elim[t] * n + kept[c]];
+      }
+      for (int r = 0; r < nk; r++) {
+        cb->cols[r] = em->dofs[kept[r]];
+        for (int t = 0; t < nb; t++) cb->a_rows[r * nb + t] = a[kept[r] * n + elim[t]];
+      }
+      condensed_lu(&cb->lu[0], nb, &cb->piv[0]);
+      if (nk > 0) condensed_lu_solve(&cb->lu[0], nb, &cb->piv[0], &cb->x[0], nk);
+
+      // Schur complement A(cols, cols) - A(cols, dofs) A(dofs, dofs)^-1 A(dofs, cols)
+      for (int r = 0; r < nk; r++)
+        for (int c = 0; c < nk; c++) {
+          scalar sum = 0.0;
+          for (int t = 0; t < nb; t++) sum += cb->a_rows[r * nb + t] * cb->x[t * nk + c];
+          s[r][c] -= sum;
+        }
+    }
+    if (nk > 0) mat->add(nk, nk, s, &rows[0], &rows[0]);
+  }
+
+  if (rhs != NULL) {
+    scalar* b = &ev->b[0];
+    if (nb > 0) {
+      cb->z.resize(nb);
+      for (int t = 0; t < nb; t++) cb->z[t] = b[elim[t]];
+      condensed_lu_solve(&cb->lu[0], nb, &cb->piv[0], &cb->z[0], 1);
+    }
+    for (int r = 0; r < nk; r++) {
+      scalar sum = b[kept[r]];
+      for (int t = 0; t < nb; t++) sum -= cb->a_rows[r * nb + t] * cb->z[t];
+      rhs->add(rows[r], sum);
+    }
+  }
+}
+
+void DiscreteProblem::expand_condensed_solution(scalar* condensed_vec, scalar* coeff_vec)
+{
+  _F_
+  if (condensed_index == NULL)
+    error("No system was condensed in DiscreteProblem::expand_condensed_solution().");
+  if (!have_condensed_rhs)
+    error("No right hand side was condensed since the matrix in DiscreteProblem::expand_condensed_solution().");
+  int ndof = get_num_dofs();
+  for (int i = 0; i < ndof; i++)
+    if (condensed_index[i] >= 0)
+      coeff_vec[i] = condensed_vec[condensed_index[i]];
+
+  // A(dofs, dofs)^-1 (b(dofs) - A(dofs, cols) u(cols))
+  for (unsigned int bi = 0; bi < condensed_blocks.size(); bi++) {
+    CondensedBlock* cb = condensed_blocks[bi];
+    if (cb == NULL) continue;
+    int nb = cb->dofs.size(), nc = cb->cols.size();
+    for (int t = 0; t < nb; t++) {
+      scalar sum = cb->z[t];
+      for (int c = 0; c < nc; c++) sum -= cb->x[t * nc + c] * coeff_vec[cb->cols[c]];
+      coeff_vec[cb->dofs[t]] = sum;
+    }
+  }
+}
+
+//// cached positions in the matrix //////////////////////////////////////////////
+
+DiscreteProblem::StagePositions* DiscreteProblem::get_stage_positions(WeakForm::Stage& stage, SparseMatrix* mat)
+{
+  _F_
+  if (mat == NULL)
+    return NULL;
+
+  // The positions belong to the storage of one matrix.
+  if (mat != positions_matrix) {
+    free_positions();
+    positions_matrix = mat;
+  }
+
+  // The states of a stage are given by its meshes and spaces.
+  std::vector<unsigned> seqs;
+  for (unsigned int i = 0; i < stage.meshes.size(); i++)
+    seqs.push_back(stage.meshes[i]->get_seq());
+  for (unsigned int i = 0; i < positions.size(); i++)
+    if (positions[i]->meshes == stage.meshes && positions[i]->idx == stage.idx) {
+      // A refined or reloaded mesh (e.g. of an external function) shifts the states.
+      if (positions[i]->seqs != seqs) {
+        free_states(positions[i]);
+        positions[i]->seqs = seqs;
+      }
+      return positions[i];
+    }
+
+  StagePositions* sp = new StagePositions;
+  sp->meshes = stage.meshes;
+  sp->idx = stage.idx;
+  sp->seqs = seqs;
+  positions.push_back(sp);
+  return sp;
+}
+
+void DiscreteProblem::free_states(StagePositions* sp)
+{
+  _F_
+  for (unsigned int j = 0; j < sp->states.size(); j++)
+    for (unsigned int k = 0; k < sp->states[j].size(); k++)
+      delete [] sp->states[j][k].pos;
+  sp->states.clear();
+  sp->base_states.clear();
+}
+
+void DiscreteProblem::free_positions()
+{
+  _F_
+  for (unsigned int i = 0; i < positions.size(); i++) {
+    free_states(positions[i]);
+    delete positions[i];
+  }
+  positions.clear();
+  positions_matrix = NULL;
+}
+
+// The first DOF of a block of the local stiffness matrix, -1 if all are Dirichlet ones.
+static int first_dof(AsmList* al)
+{
+  for (unsigned int i = 0; i < al->cnt; i++)
+    if (al->dof[i] >= 0) return al->dof[i];
+  return -1;
+}
+
+void DiscreteProblem::add_matrix_block(SparseMatrix* mat, int m, int n, int isurf,
+                                       AsmList* al_m, AsmList* al_n, scalar** local_stiffness_matrix)
+{
+  _F_
+  if (state_positions == NULL) {
+    mat->add(al_m->cnt, al_n->cnt, local_stiffness_matrix, al_m->dof, al_n->dof);
+    return;
+  }
+
+  BlockPositions* bp = NULL;
+  for (unsigned int i = 0; i < state_positions->size(); i++) {
+    BlockPositions& b = (*state_positions)[i];
+    if (b.m == m && b.n == n && b.isurf == isurf) {
+      bp = &b;
+      break;
+    }
+  }
+
+  // First assembling of the block, or the positions of another element: search for the positions.
+  int m_first = first_dof(al_m), n_first = first_dof(al_n);
+  bool search = (bp == NULL) || bp->m_cnt != al_m->cnt || bp->n_cnt != al_n->cnt
+                || bp->m_first != m_first || bp->n_first != n_first;
+  if (bp == NULL) {
+    BlockPositions b;
+    b.m = m;
+    b.n = n;
+    b.isurf = isurf;
+    b.pos = NULL;
+    state_positions->push_back(b);
+    bp = &state_positions->back();
+  }
+  if (search) {
+    if (bp->pos != NULL) delete [] bp->pos;
+    bp->m_cnt = al_m->cnt;
+    bp->n_cnt = al_n->cnt;
+    bp->m_first = m_first;
+    bp->n_first = n_first;
+    bp->pos = new int[al_m->cnt * al_n->cnt];
+    if (!mat->find_positions(al_m->cnt, al_n->cnt, al_m->dof, al_n->dof, bp->pos)) {
+      delete [] bp->pos;
+      bp->pos = NULL;
+    }
+  }
+
+  if (bp->pos != NULL)
+    mat->add_to_positions(al_m->cnt, al_n->cnt, local_stiffness_matrix, bp->pos);
+  else
+    mat->add(al_m->cnt, al_n->cnt, local_stiffness_matrix, al_m->dof, al_n->dof);
+}
+
 Element* DiscreteProblem::init_state(WeakForm::Stage& stage, Hermes::vector<PrecalcShapeset *>& spss,
   Hermes::vector<RefMap *>& refmap, Element** e, Hermes::vector<bool>& isempty, Hermes::vector<AsmList *>& al)
 {
@@ -580,6 +1684,25 @@ void DiscreteProblem::assemble_one_state(WeakForm::Stage& stage,
   if(rep_element == NULL)
     return;
 
+  // With the static condensation, the forms are assembled into the system of the element first.
+  std::vector<int> element_dofs;
+  ElementMatrix* element_matrix = NULL;
+  ElementVector* element_rhs = NULL;
+  SparseMatrix* global_matrix = matrix;
+  Vector* global_rhs = rhs;
+  if (static_condensation) {
+    for (unsigned int i = 0; i < stage.idx.size(); i++)
+      if (!isempty[stage.idx[i]])
+        for (unsigned int j = 0; j < al[stage.idx[i]]->cnt; j++)
+          if (al[stage.idx[i]]->dof[j] >= 0) element_dofs.push_back(al[stage.idx[i]]->dof[j]);
+    std::sort(element_dofs.begin(), element_dofs.end());
+    element_dofs.erase(std::unique(element_dofs.begin(), element_dofs.end()), element_dofs.end());
+    element_matrix = new ElementMatrix(element_dofs);
+    element_rhs = new ElementVector(element_matrix);
+    if (matrix != NULL) matrix = element_matrix;
+    if (rhs != NULL) rhs = element_rhs;
+  }
+
   init_cache();
 
   /// Assemble volume matrix forms.
@@ -611,6 +1734,12 @@ void DiscreteProblem::assemble_one_state(WeakForm::Stage& stage,
                               nat, isurf, e, trav_base, rep_element);
   }
 
+  if (static_condensation) {
+    condense_element(rep_element, element_matrix, element_rhs, global_matrix, global_rhs);
+    delete element_matrix;
+    delete element_rhs;
+  }
+
   // Delete assembly lists.
   for(unsigned int i = 0; i < wf->get_neq(); i++)
     delete al[i];
@@ -676,7 +1805,8 @@ void DiscreteProblem::assemble_volume_matrix_forms(WeakForm::Stage& stage,
               }
             }
           }
-          else if (mat != NULL) {
+          // Without the matrix, only the rows of the transposed block needed for the lift are evaluated.
+          else if (mat != NULL || (tra && al[m]->dof[i] < 0)) {
             scalar val = 0;
             // Numerical integration performed only if all
             // coefficients multiplying the form are nonzero.
@@ -727,7 +1857,7 @@ void DiscreteProblem::assemble_volume_matrix_forms(WeakForm::Stage& stage,
 
     // Insert the local stiffness matrix into the global one.
     if (mat != NULL) {
-      mat->add(al[m]->cnt, al[n]->cnt, local_stiffness_matrix, al[m]->dof, al[n]->dof);
+      add_matrix_block(mat, m, n, -1, al[m], al[n], local_stiffness_matrix);
     }
 
     // Insert also the off-diagonal (anti-)symmetric block, if required.
@@ -738,7 +1868,7 @@ void DiscreteProblem::assemble_volume_matrix_forms(WeakForm::Stage& stage,
       transpose(local_stiffness_matrix, al[m]->cnt, al[n]->cnt);
 
       if (mat != NULL) {
-        mat->add(al[n]->cnt, al[m]->cnt, local_stiffness_matrix, al[n]->dof, al[m]->dof);
+        add_matrix_block(mat, n, m, -1, al[n], al[m], local_stiffness_matrix);
       }
 
       // Linear problems only: Subtracting Dirichlet lift contribution from the RHS:
@@ -1552,7 +2682,7 @@ void DiscreteProblem::assemble_surface_matrix_forms(WeakForm::Stage& stage,
       }
     }
     if (mat != NULL)
-      mat->add(al[m]->cnt, al[n]->cnt, local_stiffness_matrix, al[m]->dof, al[n]->dof);
+      add_matrix_block(mat, m, n, isurf, al[m], al[n], local_stiffness_matrix);
   }
 }
 void DiscreteProblem::assemble_multicomponent_surface_matrix_forms(WeakForm::Stage& stage,
@@ -2002,7 +3132,7 @@ ExtData<Ord>* DiscreteProblem::init_ext_fns_ord(Hermes::vector<MeshFunction *> &
   fake_ext->nf = ext.size();
   Func<Ord>** fake_ext_fn = new Func<Ord>*[fake_ext->nf];
   for (int i = 0; i < fake_ext->nf; i++)
-    fake_ext_fn[i] = get_fn_ord(ext[i]->get_fn_order());
+    fake_ext_fn[i] = get_fn_ord(get_ext_fn(ext[i])->get_fn_order());
   fake_ext->fn = fake_ext_fn;
 
   return fake_ext;
@@ -2018,7 +3148,7 @@ ExtData<scalar>* DiscreteProblem::init_ext_fns(Hermes::vector<MeshFunction *> &e
   // Copy external functions.
   Func<scalar>** ext_fn = new Func<scalar>*[ext.size()];
   for (unsigned i = 0; i < ext.size(); i++) {
-    if (ext[i] != NULL) ext_fn[i] = init_fn(ext[i], order);
+    if (ext[i] != NULL) ext_fn[i] = init_fn(get_ext_fn(ext[i]), order);
     else ext_fn[i] = NULL;
   }
   ext_data->nf = ext.size();
@@ -2038,7 +3168,7 @@ ExtData<Ord>* DiscreteProblem::init_ext_fns_ord(Hermes::vector<MeshFunction *> &
   fake_ext->nf = ext.size();
   Func<Ord>** fake_ext_fn = new Func<Ord>*[fake_ext->nf];
   for (int i = 0; i < fake_ext->nf; i++)
-    fake_ext_fn[i] = get_fn_ord(ext[i]->get_edge_fn_order(edge));
+    fake_ext_fn[i] = get_fn_ord(get_ext_fn(ext[i])->get_edge_fn_order(edge));
   fake_ext->fn = fake_ext_fn;
 
   return fake_ext;
@@ -57,7 +57,9 @@ public:
   DiscreteProblem(WeakForm* wf, Space* space, bool is_linear = false);
 
   /// Non-parameterized constructor (currently used only in KellyTypeAdapt to gain access to NeighborSearch methods).
-  DiscreteProblem() : wf(NULL), pss(NULL) {num_user_pss = 0; sp_seq = NULL;}
+  DiscreteProblem() : wf(NULL), pss(NULL) {num_user_pss = 0; sp_seq = NULL; num_threads = 1; positions_matrix = NULL; state_positions = NULL;
+                                           static_condensation = false; condensed_index = NULL; num_condensed_dofs = 0; have_condensed_rhs = false;
+                                           master_problem = NULL;}
 
   /// Init function. Common code for the constructors.
   void init();
@@ -134,7 +136,9 @@ public:
                 Table* block_weights = NULL);
 
   /// Assembling for linear problems. Same as the previous functions, but
-  /// does not need the coeff_vector.
+  /// does not need the coeff_vector. If mat is NULL, only the right-hand side
+  /// (including the Dirichlet lift) is assembled, so that a matrix that does not
+  /// change (and its factorization) can be reused, e.g. in time stepping.
   void assemble(SparseMatrix* mat, Vector* rhs = NULL, 
                 bool force_diagonal_blocks = false, Table* block_weights = NULL);
 
@@ -249,6 +253,28 @@ public:
 
   void set_fvm() {this->is_fvm = true;}
 
+  /// Sets the number of threads used for assembling (1 by default). Stages with DG forms,
+  /// forms using adaptive quadrature, external functions other than Solutions or meshes
+  /// combining triangles and quads are always assembled by the calling thread only.
+  void set_num_threads(int num_threads);
+  int get_num_threads() const { return num_threads; }
+
+  /// Enables the static condensation (disabled by default). The bubble DOFs of every element
+  /// are eliminated from the local system of the element during the assembling, only the Schur
+  /// complement enters the global system. The matrix and the right hand side passed to assemble()
+  /// are then of size get_num_condensed_dofs(), the solution of this system is expanded to all
+  /// DOFs by expand_condensed_solution(). All spaces and external functions have to be defined
+  /// on one mesh. The right hand side alone can be assembled only after the matrix.
+  void set_static_condensation(bool static_condensation);
+  bool get_static_condensation() const { return static_condensation; }
+
+  /// Get the number of unknowns of the condensed system.
+  int get_num_condensed_dofs() const { return num_condensed_dofs; }
+
+  /// Computes all get_num_dofs() coefficients from the solution of the condensed system,
+  /// using the right hand side assembled last (with or after the matrix).
+  void expand_condensed_solution(scalar* condensed_vec, scalar* coeff_vec);
+
 protected:
   /// Assembling.
   /// Experimental caching of vector valued (vector) forms.
@@ -484,6 +510,128 @@ protected:
   unsigned int min_dg_mesh_seq;
 
 
+  /// Threaded assembling.
+  /// Number of threads used for assembling, see set_num_threads().
+  int num_threads;
+
+  /// Constructor of a worker of the threaded assembling. The worker shares the weak form
+  /// and the spaces (including the enumeration of dofs) with the master problem, but has
+  /// its own precalculated shapesets and caches.
+  DiscreteProblem(DiscreteProblem* master);
+
+  /// Copies of the external functions owned by a worker, indexed by the original functions.
+  std::map<MeshFunction*, MeshFunction*> ext_copies;
+
+  /// Returns the function to be evaluated for the external function fn (its copy in a worker).
+  MeshFunction* get_ext_fn(MeshFunction* fn);
+
+  /// Returns true if the states of the stage can be assembled by several threads at once.
+  bool is_stage_threadable(WeakForm::Stage& stage);
+
+  /// Creates the sparse structure of the matrix in two passes over the elements (counting
+  /// the entries of the columns, then storing them), by num_threads threads if possible.
+  void build_sparse_structure(SparseMatrix* mat, int ndof, bool force_diagonal_blocks, Table* block_weights);
+
+  /// Data of one thread creating the sparse structure.
+  struct StructureThread;
+
+  /// Runs one pass of build_sparse_structure() by all threads.
+  void build_structure_pass(StructureThread* threads, int pass);
+
+  /// Thread function of build_sparse_structure().
+  static void* structure_thread(void* data);
+
+  /// Assembles one stage by num_threads threads. Each one traverses a contiguous range of
+  /// the base elements (see Traverse::split_base_elements()) into its own matrix and right
+  /// hand side, which are added to the global ones when all threads are finished.
+  void assemble_one_stage_threaded(WeakForm::Stage& stage,
+                                   SparseMatrix* mat, Vector* rhs, bool force_diagonal_blocks, Table* block_weights,
+                                   Hermes::vector<Solution *>& u_ext);
+
+  /// Data of one assembling thread.
+  struct AssemblingThread;
+
+  /// Thread function of the threaded assembling.
+  static void* assemble_thread(void* data);
+
+  /// Data of one thread adding the thread matrices to the global one.
+  struct MergingThread;
+
+  /// Thread function adding a range of the positions of the thread matrices to the global one.
+  static void* merge_thread(void* data);
+
+  /// Static condensation, see set_static_condensation().
+  bool static_condensation;
+
+  /// Index of each DOF in the condensed system, -1 for the eliminated ones.
+  int* condensed_index;
+  int num_condensed_dofs;
+
+  /// The eliminated DOFs of the elements (indexed by the element id, NULL for elements
+  /// without bubbles) and the factorization of their blocks.
+  struct CondensedBlock;
+  std::vector<CondensedBlock*> condensed_blocks;
+
+  /// True if a right hand side was condensed since the matrix was assembled.
+  bool have_condensed_rhs;
+
+  /// The problem owning the condensation data of a worker of the threaded assembling.
+  DiscreteProblem* master_problem;
+
+  /// Dense system of one element, collecting the forms during the static condensation.
+  class ElementMatrix;
+  class ElementVector;
+
+  /// Numbers the kept DOFs and creates the blocks of the elements with bubbles.
+  void init_condensation();
+
+  /// Eliminates the bubble DOFs from the system of the element e and adds the Schur complement
+  /// into the global matrix and right hand side (both may be NULL).
+  void condense_element(Element* e, ElementMatrix* em, ElementVector* ev, SparseMatrix* mat, Vector* rhs);
+
+  void free_condensation();
+
+
+  /// Caching of the positions of local stiffness matrices in the global matrix.
+  /// Positions of one block of the local stiffness matrix, see SparseMatrix::find_positions().
+  struct BlockPositions
+  {
+    int m, n;
+    int isurf;              ///< -1 for volume blocks.
+    unsigned int m_cnt, n_cnt;
+    int m_first, n_first;   ///< First DOFs of the block, identify the element of the positions.
+    int* pos;               ///< NULL if the matrix does not support adding to positions.
+  };
+
+  /// Positions of the blocks of all states of one stage, in the order of the traversal.
+  struct StagePositions
+  {
+    Hermes::vector<Mesh*> meshes;
+    Hermes::vector<int> idx;
+    std::vector<unsigned> seqs;   ///< Seqs of the meshes, the states change with them.
+    std::vector<std::vector<BlockPositions> > states;
+    std::vector<unsigned> base_states;  ///< Index of the first state of every base element (set by the threaded assembling).
+  };
+
+  /// Cached positions, valid for positions_matrix until its sparse structure is rebuilt.
+  std::vector<StagePositions*> positions;
+  SparseMatrix* positions_matrix;
+
+  /// Positions of the blocks of the state being assembled, NULL if they are not cached.
+  std::vector<BlockPositions>* state_positions;
+
+  /// Returns the cached positions for the stage (creating an empty record on the first use),
+  /// NULL if no matrix is assembled.
+  StagePositions* get_stage_positions(WeakForm::Stage& stage, SparseMatrix* mat);
+  void free_states(StagePositions* sp);
+  void free_positions();
+
+  /// Adds the local stiffness matrix of the block (m, n) to the global one, using the cached
+  /// positions of the current state if available.
+  void add_matrix_block(SparseMatrix* mat, int m, int n, int isurf,
+                        AsmList* al_m, AsmList* al_n, scalar** local_stiffness_matrix);
+
+
   /// Members.
   WeakForm* wf;
 
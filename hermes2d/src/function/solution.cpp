@@ -18,6 +18,7 @@
 #include "../../../hermes_common/matrix.h"
 #include "../shapeset/precalc.h"
 #include "../mesh/refmap.h"
+#include "../mesh/mesh_hash_grid.h"
 
 //// MeshFunction //////////////////////////////////////////////////////////////////////////////////
 
@@ -285,16 +286,24 @@ void Solution::assign(Solution* sln)
 }
 
 
-void Solution::copy(const Solution* sln)
+void Solution::copy(const Solution* sln, bool copy_mesh)
 {
   if (sln->sln_type == HERMES_UNDEF) error("Solution being copied is uninitialized.");
 
   free();
 
-  mesh = new Mesh;
-  //printf("Copying mesh from Solution and setting own_mesh = true.\n");
-  mesh->copy(sln->mesh);
-  own_mesh = true;
+  if (copy_mesh)
+  {
+    mesh = new Mesh;
+    //printf("Copying mesh from Solution and setting own_mesh = true.\n");
+    mesh->copy(sln->mesh);
+    own_mesh = true;
+  }
+  else
+  {
+    mesh = sln->mesh;
+    own_mesh = false;
+  }
 
   sln_type = sln->sln_type;
   space_type = sln->get_space_type();
@@ -728,6 +737,10 @@ void Solution::multiply(scalar coef)
   {
     for (int i = 0; i < num_coefs; i++)
       mono_coefs[i] *= coef;
+
+    // values precalculated from the old coefficients
+    free_tables();
+    element = NULL;
   }
   else if (sln_type == HERMES_CONST)
   {
@@ -742,6 +755,17 @@ void Solution::multiply(scalar coef)
     error("Uninitialized solution.");
 }
 
+void Solution::set_mono_coefs(const scalar* coefs)
+{
+  if (sln_type != HERMES_SLN) error("Solution::set_mono_coefs() is defined for standard solutions only.");
+
+  memcpy(mono_coefs, coefs, sizeof(scalar) * num_coefs);
+
+  // values precalculated from the old coefficients
+  free_tables();
+  element = NULL;
+}
+
 
 //// set_active_element ////////////////////////////////////////////////////////////////////////////
 
@@ -1171,8 +1195,6 @@ void Solution::precalculate(int order, int mask)
 
 void Solution::save(const char* filename, bool compress)
 {
-  int i;
-
   if (sln_type == HERMES_EXACT) error("Exact solution cannot be saved to a file.");
   if (sln_type == HERMES_CONST)  error("Constant solution cannot be saved to a file.");
   if (sln_type == HERMES_UNDEF) error("Cannot save -- uninitialized solution.");
@@ -1192,6 +1214,18 @@ void Solution::save(const char* filename, bool compress)
     if (f == NULL) error("Could not create compressed stream (command line: %s).", cmdline.str().c_str());
   }
 
+  save(f);
+
+  if (compress) pclose(f); else fclose(f);
+}
+
+
+void Solution::save(FILE* f)
+{
+  int i;
+
+  if (sln_type != HERMES_SLN) error("Only a standard solution can be saved to a stream.");
+
   // write header
   hermes_fwrite("H2DS\001\000\000\000", 1, 8, f);
   int ssize = sizeof(scalar);
@@ -1217,18 +1251,11 @@ void Solution::save(const char* filename, bool compress)
 
   // write the mesh
   mesh->save_raw(f);
-
-  if (compress) pclose(f); else fclose(f);
 }
 
 
 void Solution::load(const char* filename)
 {
-  int i;
-
-  free();
-  sln_type = HERMES_SLN;
-
   int len = strlen(filename);
   bool compressed = (len > 3 && !strcmp(filename + len - 3, ".gz"));
 
@@ -1245,6 +1272,19 @@ void Solution::load(const char* filename)
     if (f == NULL) error("Could not read from compressed stream (command line: %s).", cmdline.str().c_str());
   }
 
+  load(f);
+
+  if (compressed) pclose(f); else fclose(f);
+}
+
+
+void Solution::load(FILE* f)
+{
+  int i;
+
+  free();
+  sln_type = HERMES_SLN;
+
   // load header
   struct {
     char magic[4];
@@ -1316,20 +1356,14 @@ void Solution::load(const char* filename)
   //printf("Loading mesh from file and setting own_mesh = true.\n");
   own_mesh = true;
 
-  if (compressed) pclose(f); else fclose(f);
-
   init_dxdy_buffer();
 }
 
 
 //// getting solution values in arbitrary points ///////////////////////////////////////////////////////////////
 
-scalar Solution::get_ref_value(Element* e, double xi1, double xi2, int component, int item)
+static inline scalar eval_mono(scalar* mono, int o, int mode, double xi1, double xi2)
 {
-  set_active_element(e);
-
-  int o = elem_orders[e->id];
-  scalar* mono = dxdy_coefs[component][item];
   scalar result = 0.0;
   int k = 0;
   for (int i = 0; i <= o; i++)
@@ -1342,6 +1376,13 @@ scalar Solution::get_ref_value(Element* e, double xi1, double xi2, int component
   return result;
 }
 
+scalar Solution::get_ref_value(Element* e, double xi1, double xi2, int component, int item)
+{
+  set_active_element(e);
+
+  return eval_mono(dxdy_coefs[component][item], elem_orders[e->id], mode, xi1, xi2);
+}
+
 
 static inline bool is_in_ref_domain(Element* e, double xi1, double xi2)
 {
@@ -1434,42 +1475,157 @@ scalar Solution::get_pt_value(double x, double y, int item)
           "the solution on its right-hand side.");
   }
 
-  // try the last visited element and its neighbours
-  if (e_last != NULL)
+  Element* e = find_element_pt(x, y, xi1, xi2);
+  if (e != NULL)
+    return get_ref_value_transformed(e, xi1, xi2, a, b);
+
+  warn("Point (%g, %g) does not lie in any element.", x, y);
+  return 0;
+}
+
+// Returns the edge of the element the point (given by the reference coordinates) lies
+// behind the most.
+static inline int get_exit_edge(Element* e, double xi1, double xi2)
+{
+  double dist[4];
+  if (e->is_triangle())
+  {
+    dist[0] = -1.0 - xi2;
+    dist[1] = xi1 + xi2;
+    dist[2] = -1.0 - xi1;
+  }
+  else
+  {
+    dist[0] = -1.0 - xi2;
+    dist[1] = xi1 - 1.0;
+    dist[2] = xi2 - 1.0;
+    dist[3] = -1.0 - xi1;
+  }
+
+  int edge = 0;
+  for (unsigned int i = 1; i < e->nvert; i++)
+    if (dist[i] > dist[edge])
+      edge = i;
+  return edge;
+}
+
+
+Element* Solution::find_element_pt(double x, double y, double& xi1, double& xi2)
+{
+  // walk from the last visited element across the edges the point lies behind,
+  // stops at the boundary and at the edges with hanging nodes
+  const int max_walk = 10;
+  Element* e = e_last;
+  for (int i = 0; e != NULL && i < max_walk; i++)
   {
-    Element* elem[5];
-    elem[0] = e_last;
-    for (unsigned int i = 1; i <= e_last->nvert; i++)
-      elem[i] = e_last->get_neighbor(i-1);
+    refmap->set_active_element(e);
+    refmap->untransform(e, x, y, xi1, xi2);
+    if (is_in_ref_domain(e, xi1, xi2))
+    {
+      e_last = e;
+      return e_last;
+    }
 
-    for (unsigned int i = 0; i <= e_last->nvert; i++)
-      if (elem[i] != NULL)
-      {
-        refmap->set_active_element(elem[i]);
-        refmap->untransform(elem[i], x, y, xi1, xi2);
-        if (is_in_ref_domain(elem[i], xi1, xi2))
-        {
-          e_last = elem[i];
-          return get_ref_value_transformed(elem[i], xi1, xi2, a, b);
-        }
-      }
+    e = e->get_neighbor(get_exit_edge(e, xi1, xi2));
+    if (e != NULL && !e->active) e = NULL;
   }
 
-  // go through all elements
-  Element *e;
-  for_all_active_elements(e, mesh)
+  // go through the elements of the point location grid cell
+  int count;
+  Element** elems = mesh->get_hash_grid()->get_candidates(x, y, count);
+  for (int i = 0; i < count; i++)
   {
+    Element* e = elems[i];
     refmap->set_active_element(e);
     refmap->untransform(e, x, y, xi1, xi2);
     if (is_in_ref_domain(e, xi1, xi2))
     {
       e_last = e;
-      return get_ref_value_transformed(e, xi1, xi2, a, b);
+      return e_last;
     }
   }
 
-  warn("Point (%g, %g) does not lie in any element.", x, y);
-  return 0;
+  return NULL;
+}
+
+struct PtLocation
+{
+  Element* e;
+  double xi1, xi2;
+  int idx;
+};
+
+static bool compare_pt_location(const PtLocation& a, const PtLocation& b)
+{
+  return a.e->id < b.e->id;
+}
+
+void Solution::get_pt_values(int n, const double* x, const double* y, scalar* val, scalar* dx, scalar* dy, Element** elements)
+{
+  for (int i = 0; i < n; i++)
+  {
+    val[i] = dx[i] = dy[i] = 0.0;
+    if (elements != NULL) elements[i] = NULL;
+  }
+
+  if (sln_type == HERMES_UNDEF)
+    error("Cannot obtain values -- uninitialized solution.");
+
+  if (sln_type == HERMES_EXACT || sln_type == HERMES_CONST)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      if (sln_type == HERMES_EXACT && num_components == 1)
+        val[i] = (static_cast<ExactSolutionScalar*>(this))->exact_function(x[i], y[i], dx[i], dy[i]);
+      else
+        val[i] = get_pt_value(x[i], y[i], H2D_FN_VAL_0);
+      if (elements != NULL)
+        elements[i] = mesh->element_on_physical_coordinates(x[i], y[i]);
+    }
+    return;
+  }
+
+  if (num_components != 1)
+    error("Solution::get_pt_values() is implemented for scalar solutions only.");
+
+  // locate all points first, successive points usually lie in the same element
+  std::vector<PtLocation> loc;
+  loc.reserve(n);
+  for (int i = 0; i < n; i++)
+  {
+    PtLocation pt;
+    pt.e = find_element_pt(x[i], y[i], pt.xi1, pt.xi2);
+    pt.idx = i;
+    if (pt.e != NULL)
+      loc.push_back(pt);
+  }
+
+  // evaluate the points grouped by element, the element tables are set up once per group
+  // (and kept from the previous call for the same element)
+  std::stable_sort(loc.begin(), loc.end(), compare_pt_location);
+  for (unsigned int i = 0; i < loc.size(); i++)
+  {
+    PtLocation& pt = loc[i];
+    if (i == 0 || loc[i-1].e != pt.e)
+    {
+      if (pt.e != element)
+        set_active_element(pt.e);
+      else
+        refmap->set_active_element(pt.e); // moved by the search
+    }
+
+    int o = elem_orders[pt.e->id];
+    double2x2 m;
+    double xx, yy;
+    refmap->inv_ref_map_at_point(pt.xi1, pt.xi2, xx, yy, m);
+    scalar rdx = eval_mono(dxdy_coefs[0][1], o, mode, pt.xi1, pt.xi2);
+    scalar rdy = eval_mono(dxdy_coefs[0][2], o, mode, pt.xi1, pt.xi2);
+
+    val[pt.idx] = eval_mono(dxdy_coefs[0][0], o, mode, pt.xi1, pt.xi2);
+    dx[pt.idx] = m[0][0]*rdx + m[0][1]*rdy;
+    dy[pt.idx] = m[1][0]*rdx + m[1][1]*rdy;
+    if (elements != NULL) elements[pt.idx] = pt.e;
+  }
 }
 
 
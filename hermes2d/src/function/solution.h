@@ -52,6 +52,10 @@ public:
   Mesh*   get_mesh() const { return mesh; }
   RefMap* get_refmap() { update_refmap(); return refmap; }
 
+  /// Makes the reference map of the function independent of other reference maps,
+  /// see RefMap::use_private_pss().
+  void use_private_refmap_pss() { refmap->use_private_pss(); }
+
   virtual scalar get_pt_value(double x, double y, int item = H2D_FN_VAL_0) = 0;
 
   /// Virtual function handling overflows. Has to be virtual, because
@@ -108,7 +112,9 @@ public:
 
   void assign(Solution* sln);
   Solution& operator = (Solution& sln) { assign(&sln); return *this; }
-  void copy(const Solution* sln);
+  /// Copies the coefficients of 'sln'. With copy_mesh == false the mesh of 'sln' is
+  /// shared (not owned), which is enough for an independent evaluation of the copy.
+  void copy(const Solution* sln, bool copy_mesh = true);
 
   int* get_element_orders() { return this->elem_orders;}
 
@@ -135,11 +141,18 @@ public:
   /// compressed with gzip and a ".gz" suffix added to the file name.
   void save(const char* filename, bool compress = true);
 
+  /// Writes the solution in the format of Solution::save() to an open stream, so that
+  /// more solutions can be stored in one file.
+  void save(FILE* f);
+
   /// Loads the solution from a file previously created by Solution::save(). This completely
   /// restores the solution in the memory. The file name has to include the ".gz" suffix,
   /// in which case the file is piped through gzip to decompress the data (Linux only).
   void load(const char* filename);
 
+  /// Reads a solution written by Solution::save(FILE*) from an open stream.
+  void load(FILE* f);
+
   /// Returns solution value or derivatives at element e, in its reference domain point (xi1, xi2).
   /// 'item' controls the returned value: 0 = value, 1 = dx, 2 = dy, 3 = dxx, 4 = dyy, 5 = dxy.
   /// NOTE: This function should be used for postprocessing only, it is not effective
@@ -160,6 +173,14 @@ public:
   /// slow. Prefer Solution::get_ref_value if possible.
   virtual scalar get_pt_value(double x, double y, int item = H2D_FN_VAL_0);
 
+  /// Returns the values and the gradients of the first solution component at n physical
+  /// domain points at once. Each point is located only once and the points are evaluated
+  /// grouped by element. Points outside the mesh get zero values.
+  /// \param elements [out] If not NULL, receives the elements containing the points
+  /// (NULL for points outside the mesh).
+  void get_pt_values(int n, const double* x, const double* y, scalar* val, scalar* dx, scalar* dy,
+                     Element** elements = NULL);
+
   /// Returns the number of degrees of freedom of the solution.
   /// Returns -1 for exact or constant solutions.
   int get_num_dofs() const { return num_dofs; };
@@ -167,6 +188,18 @@ public:
   /// Multiplies the function represented by this class by the given coefficient.
   void multiply(scalar coef);
 
+  /// Returns the number of monomial coefficients of a standard solution.
+  int get_num_coefs() const { return num_coefs; }
+
+  /// Returns the monomial coefficients of a standard solution. Solutions of the same
+  /// space differ only in these, so a series of them (e.g. time steps) can be stored
+  /// as coefficients and restored by copy(sln, false) and set_mono_coefs().
+  const scalar* get_mono_coefs() const { return mono_coefs; }
+
+  /// Replaces the monomial coefficients of a standard solution by 'coefs'
+  /// (get_num_coefs() entries).
+  void set_mono_coefs(const scalar* coefs);
+
   /// Returns solution type.
   ESolutionType get_type() const { return sln_type; };
 
@@ -242,6 +275,12 @@ protected:
 
   Element* e_last; ///< last visited element when getting solution values at specific points
 
+  /// Finds the active element containing the point (x, y) and the reference coordinates
+  /// of the point. Walks from e_last through the neighbours towards the point first (successive
+  /// points, e.g. of a trajectory, lie in the same or a near element), then searches the point
+  /// location grid. Returns NULL if there is none.
+  Element* find_element_pt(double x, double y, double& xi1, double& xi2);
+
 };
 
 
@@ -49,6 +49,7 @@
 #include "quadrature/limit_order.h"
 
 #include "mesh/mesh.h"
+#include "mesh/mesh_hash_grid.h"
 #include "mesh/mesh_loader.h"
 #include "mesh/h2d_reader.h"
 #include "mesh/exodusii.h"
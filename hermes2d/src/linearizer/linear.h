@@ -37,13 +37,26 @@ class HERMES_API Linearizer // (implemented in linear1.cpp)
 public:
 
   Linearizer();
-  ~Linearizer();
+  virtual ~Linearizer();
 
   void process_solution(MeshFunction* sln, int item = H2D_FN_VAL_0,
                         double eps = HERMES_EPS_NORMAL, double max_abs = -1.0,
                         MeshFunction* xdisp = NULL, MeshFunction* ydisp = NULL,
                         double dmult = 1.0);
 
+  /// Linearizes the function by slns.size() threads at once, the i-th thread evaluates slns[i].
+  /// The functions have to be independent of each other (e.g. copies made by Solution::copy(),
+  /// with MeshFunction::use_private_refmap_pss()). Every thread processes a contiguous range
+  /// of the base elements into its own buffers, which are merged at the end. Meshes combining
+  /// triangles and quads are processed by the calling thread only (see Traverse::is_mode_uniform()).
+  void process_solution(Hermes::vector<MeshFunction*> slns, int item = H2D_FN_VAL_0,
+                        double eps = HERMES_EPS_NORMAL);
+
+  /// Abandons the linearization running in another thread: no more elements are processed
+  /// and the data stay incomplete, so the linearizer should only be deleted afterwards.
+  void cancel() { cancelled = true; }
+  bool is_cancelled() const { return cancelled || (parent != NULL && parent->is_cancelled()); }
+
   void lock_data() const { pthread_mutex_lock(&data_mutex); }
   void unlock_data() const { pthread_mutex_unlock(&data_mutex); }
 
@@ -98,6 +111,12 @@ protected:
   int cv, ct, ce; ///< capacities of vertex, triangle and edge arrays
   int del_slot;   ///< free slot index after a triangle which was deleted
   int mask;       ///< hash table mask = size-1
+  int top_vertex_id; ///< number of top-level vertices not belonging to a mesh node
+
+  int first_base, last_base; ///< base elements processed by a thread (last_base < 0: all)
+  double max_init; ///< initial maximum of the values (given to the threads)
+  volatile bool cancelled; ///< set by cancel()
+  const Linearizer* parent; ///< linearizer merging the buffers of the thread (cancels it too)
 
   bool curved, disp;
   double min_val, max_val;
@@ -153,6 +172,14 @@ protected:
   void find_min_max();
   void print_hash_stats();
 
+  /// Returns the maximum of the values in the element vertices of the elements processed.
+  double find_vertex_max(MeshFunction* sln, int item);
+
+  /// Data of one thread linearizing a range of the states.
+  struct LinearizerThread;
+  static void* linearizer_thread(void* data);
+  static void run_threads(LinearizerThread* threads, int count, int pass);
+
   mutable pthread_mutex_t data_mutex;
 
   static void calc_aabb(double* x, double* y, int stride, int num, double* min_x, double* max_x, double* min_y, double* max_y); ///< Calculates AABB from an array of X-axis and Y-axis coordinates. The distance between values in the array is stride bytes.
@@ -176,6 +203,9 @@ public:
 
   virtual void save_data(const char* filename);
   virtual void load_data(const char* filename);
+  /// Writes/reads the data to/from an open stream (more objects in one file).
+  void save_data(FILE* f);
+  void load_data(FILE* f);
   // Saves a MeshFunction (Solution, Filter) in VTK format.
   virtual void save_orders_vtk(Space* space, const char* file_name);
   // This function is used by save_solution_vtk().
@@ -208,6 +238,10 @@ public:
 
   void process_solution(MeshFunction* xsln, int xitem, MeshFunction* ysln, int yitem, double eps);
 
+  /// Vectorizes the functions by xslns.size() threads at once, see Linearizer::process_solution().
+  void process_solution(Hermes::vector<MeshFunction*> xslns, int xitem,
+                        Hermes::vector<MeshFunction*> yslns, int yitem, double eps);
+
 public: //accessors
   double4* get_vertices() const { return verts; }
   int get_num_vertices() const { return nv; }
@@ -276,6 +310,13 @@ protected:
 
   void find_min_max();
 
+  /// Returns the maximum of the magnitudes in the element vertices of the elements processed.
+  double find_vertex_max(MeshFunction* xsln, int xitem, MeshFunction* ysln, int yitem);
+
+  struct VectorizerThread;
+  static void* vectorizer_thread(void* data);
+  static void run_threads(VectorizerThread* threads, int count, int pass);
+
 };
 
 
@@ -16,6 +16,7 @@
 #include "../h2d_common.h"
 #include "linear.h"
 #include "../mesh/refmap.h"
+#include "../mesh/traverse.h"
 
 
 //// linearization "quadrature" ////////////////////////////////////////////////////////////////////
@@ -133,6 +134,12 @@ Linearizer::Linearizer()
   tris = NULL;
   edges = NULL;
 
+  first_base = 0;
+  last_base = -1;
+  max_init = 0.0;
+  cancelled = false;
+  parent = NULL;
+
   pthread_mutexattr_t attr;
   pthread_mutexattr_init(&attr);
   pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
@@ -173,7 +180,7 @@ int Linearizer::get_vertex(int p1, int p2, double x, double y, double value)
 int Linearizer::get_top_vertex(int id, double value)
 {
   if (fabs(value - verts[id][2]) < max*1e-24) return id;
-  return get_vertex(-rand(), -rand(), verts[id][0], verts[id][1], value);
+  return get_vertex(-2 - top_vertex_id++, -2, verts[id][0], verts[id][1], value);
 }
 
 
@@ -674,6 +681,7 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
   this->dmult = dmult;
   nv = nt = ne = 0;
   del_slot = -1;
+  top_vertex_id = 0;
 
   if (!item) error("Parameter 'item' cannot be zero.");
   get_gv_a_b(item, ia, ib);
@@ -690,6 +698,8 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
     error("Mesh is NULL in Linearizer:process_solution().");
   }
   int nn = mesh->get_num_elements();
+  if (last_base >= 0)
+    nn = (int) ((long long) nn * (last_base - first_base) / std::max(mesh->get_num_base_elements(), 1));
   /*
   if(disp) {
     if(xdisp->get_mesh()->get_num_elements() > nn)
@@ -766,7 +776,7 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
   */
 
   auto_max = (max_abs < 0.0);
-  max = auto_max ? 0.0 : max_abs;
+  max = auto_max ? max_init : max_abs;
 
   // obtain the solution in vertices, estimate the maximum solution value
   // Init multi-mesh traversal.
@@ -793,11 +803,11 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
   }
   Traverse trav;
   trav.begin(disp ? 3 : 1, meshes, trfs);
+  if (last_base >= 0) trav.set_base_range(first_base, last_base);
 
   // Loop through all elements.
   Element **e;
-  // Loop through all elements.
-  while ((e = trav.get_next_state(NULL, NULL)) != NULL) {
+  while (!is_cancelled() && (e = trav.get_next_state(NULL, NULL)) != NULL) {
     sln->set_quad_order(0, item);
     scalar* val = sln->get_values(ia, ib);
     if (val == NULL) error("Item not defined in the solution.");
@@ -810,6 +820,10 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
       dy = ydisp->get_fn_values();
     }
 
+    // vertices in the mesh nodes are shared by the neighbouring elements (as long as the
+    // values are the same), corners of sub-elements (multi-mesh traversal) are unique
+    bool top = (sln->get_transform() == 0);
+
     int iv[4];
     for (unsigned int i = 0; i < e[0]->nvert; i++)
     {
@@ -825,7 +839,10 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
         y_disp += dmult*realpart(dy[i]);
       }
 
-      iv[i] = get_vertex(-rand(), -rand(), x_disp, y_disp, f);
+      if (top)
+        iv[i] = get_vertex(-1 - e[0]->vn[i]->id, -1, x_disp, y_disp, f);
+      else
+        iv[i] = get_vertex(-2 - top_vertex_id++, -2, x_disp, y_disp, f);
     }
 
     // we won't bother calculating physical coordinates from the refmap if this is not a curved element
@@ -841,6 +858,7 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
     for (unsigned int i = 0; i < e[0]->nvert; i++)
       process_edge(iv[i], iv[e[0]->next_vert(i)], e[0]->en[i]->marker);
   }
+  trav.finish();
 
   /*
   delete [] id2id;
@@ -863,6 +881,12 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
   */
 
   find_min_max();
+
+  // release the unused capacity of the arrays (the estimates above are generous)
+  if (cv > nv && nv > 0) verts = (double3*) realloc(verts, sizeof(double3) * (cv = nv));
+  if (ct > nt && nt > 0) tris = (int3*) realloc(tris, sizeof(int3) * (ct = nt));
+  if (ce > ne && ne > 0) edges = (int3*) realloc(edges, sizeof(int3) * (ce = ne));
+
   //verbose("Linearizer: %d verts, %d tris in %0.3g sec", nv, nt, time_period.tick().last());
   //if (verbose_mode) print_hash_stats();
   unlock_data();
@@ -878,6 +902,170 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
 }
 
 
+struct Linearizer::LinearizerThread
+{
+  Linearizer* lin; // buffers of the thread
+  pthread_t thread;
+
+  MeshFunction* sln;
+  int item;
+  double eps;
+
+  // 1: find the maximum of the values in the vertices, 2: linearize
+  int pass;
+  double max;
+};
+
+
+void Linearizer::process_solution(Hermes::vector<MeshFunction*> slns, int item, double eps)
+{
+  if (slns.size() == 0) error("No solution given to Linearizer:process_solution().");
+
+  Mesh* mesh = slns[0]->get_mesh();
+  if (mesh == NULL) error("Mesh is NULL in Linearizer:process_solution().");
+
+  int count = slns.size();
+  Hermes::vector<Mesh*> meshes(mesh);
+  if (count == 1 || !Traverse::is_mode_uniform(meshes))
+  {
+    process_solution(slns[0], item, eps);
+    return;
+  }
+
+  lock_data();
+
+  // every thread takes a contiguous range of the base elements
+  int* bounds = new int[count + 1];
+  Traverse::split_base_elements(1, &mesh, count, bounds);
+  LinearizerThread* threads = new LinearizerThread[count];
+  for (int t = 0; t < count; t++)
+  {
+    threads[t].lin = new Linearizer();
+    threads[t].lin->first_base = bounds[t];
+    threads[t].lin->last_base = bounds[t + 1];
+    threads[t].lin->parent = this;
+    threads[t].sln = slns[t];
+    threads[t].item = item;
+    threads[t].eps = eps;
+  }
+  delete [] bounds;
+
+  // the error of the linearization is relative to the maximum, so all threads
+  // start with the maximum over all vertices
+  run_threads(threads, count, 1);
+  double vertex_max = 0.0;
+  for (int t = 0; t < count; t++)
+    vertex_max = std::max(vertex_max, threads[t].max);
+  for (int t = 0; t < count; t++)
+    threads[t].max = vertex_max;
+
+  if (!is_cancelled())
+    run_threads(threads, count, 2);
+
+  // merge the buffers of the threads
+  nv = nt = ne = 0;
+  del_slot = -1;
+  for (int t = 0; t < count; t++)
+  {
+    nv += threads[t].lin->nv;
+    nt += threads[t].lin->nt;
+    ne += threads[t].lin->ne;
+  }
+  lin_init_array(verts, double3, cv, std::max(nv, 1));
+  lin_init_array(tris, int3, ct, std::max(nt, 1));
+  lin_init_array(edges, int3, ce, std::max(ne, 1));
+
+  int ov = 0, ot = 0, oe = 0;
+  for (int t = 0; t < count; t++)
+  {
+    Linearizer* lin = threads[t].lin;
+    memcpy(verts + ov, lin->verts, sizeof(double3) * lin->nv);
+    for (int i = 0; i < lin->nt; i++)
+      for (int j = 0; j < 3; j++)
+        tris[ot + i][j] = lin->tris[i][j] + ov;
+    for (int i = 0; i < lin->ne; i++)
+    {
+      edges[oe + i][0] = lin->edges[i][0] + ov;
+      edges[oe + i][1] = lin->edges[i][1] + ov;
+      edges[oe + i][2] = lin->edges[i][2];
+    }
+    ov += lin->nv;
+    ot += lin->nt;
+    oe += lin->ne;
+
+    delete lin;
+  }
+  delete [] threads;
+
+  find_min_max();
+  unlock_data();
+}
+
+
+void Linearizer::run_threads(LinearizerThread* threads, int count, int pass)
+{
+  for (int t = 0; t < count; t++)
+    threads[t].pass = pass;
+
+  // the first range is processed by the calling thread
+  for (int t = 1; t < count; t++)
+    if (pthread_create(&threads[t].thread, NULL, linearizer_thread, threads + t) != 0)
+      error("Could not create a thread in Linearizer::run_threads().");
+  linearizer_thread(threads);
+  for (int t = 1; t < count; t++)
+    pthread_join(threads[t].thread, NULL);
+}
+
+
+void* Linearizer::linearizer_thread(void* data)
+{
+  LinearizerThread* lt = (LinearizerThread*) data;
+  if (lt->pass == 1)
+  {
+    lt->max = lt->lin->find_vertex_max(lt->sln, lt->item);
+  }
+  else
+  {
+    lt->lin->max_init = lt->max;
+    lt->lin->process_solution(lt->sln, lt->item, lt->eps);
+  }
+  return NULL;
+}
+
+
+double Linearizer::find_vertex_max(MeshFunction* sln, int item)
+{
+  int a, b;
+  get_gv_a_b(item, a, b);
+
+  Quad2D* old_quad = sln->get_quad_2d();
+  sln->set_quad_2d(&quad_lin);
+
+  Mesh* mesh = sln->get_mesh();
+  Transformable* fn = sln;
+  Traverse trav;
+  trav.begin(1, &mesh, &fn);
+  if (last_base >= 0) trav.set_base_range(first_base, last_base);
+
+  double vertex_max = 0.0;
+  Element** e;
+  while (!is_cancelled() && (e = trav.get_next_state(NULL, NULL)) != NULL)
+  {
+    sln->set_quad_order(0, item);
+    scalar* val = sln->get_values(a, b);
+    for (unsigned int i = 0; i < e[0]->nvert; i++)
+    {
+      double f = fabs(getval(i));
+      if (finite(f) && f > vertex_max) vertex_max = f;
+    }
+  }
+  trav.finish();
+
+  sln->set_quad_2d(old_quad);
+  return vertex_max;
+}
+
+
 void Linearizer::free()
 {
   lin_free_array(verts, nv, cv);
@@ -197,6 +197,12 @@ void Orderizer::save_data(const char* filename)
 {
   FILE* f = fopen(filename, "wb");
   if (f == NULL) error("Could not open %s for writing.", filename);
+  save_data(f);
+  fclose(f);
+}
+
+void Orderizer::save_data(FILE* f)
+{
   lock_data();
 
   int* orders = new int[nl];
@@ -222,34 +228,40 @@ void Orderizer::save_data(const char* filename)
       fwrite(lbox, sizeof(double2), nl, f) != (unsigned) nl ||
       fwrite(orders, sizeof(int), nl, f) != (unsigned) nl)
   {
-    error("Error writing data to %s", filename);
+    error("Error writing Orderizer data.");
   }
+  delete [] orders;
 
   unlock_data();
-  fclose(f);
 }
 
 void Orderizer::load_data(const char* filename)
 {
   FILE* f = fopen(filename, "rb");
   if (f == NULL) error("Could not open %s for reading.", filename);
+  load_data(f);
+  fclose(f);
+}
+
+void Orderizer::load_data(FILE* f)
+{
   lock_data();
 
   struct { char magic[4]; int ver; } hdr;
   if (fread(&hdr, sizeof(hdr), 1, f) != 1)
-    error("Error reading %s", filename);
+    error("Error reading Orderizer data.");
 
   if (hdr.magic[0] != 'H' || hdr.magic[1] != '2' || hdr.magic[2] != 'D' || hdr.magic[3] != 'O')
-    error("File %s is not a Hermes2D Orderizer file.", filename);
+    error("Not a Hermes2D Orderizer file.");
   if (hdr.ver > 1)
-    error("File %s -- unsupported file version.", filename);
+    error("Unsupported Orderizer file version.");
 
   #define read_array(array, type, n, c, what) \
     if (fread(&n, sizeof(int), 1, f) != 1) \
-      error("Error reading the number of " what " from %s", filename); \
+      error("Error reading the number of " what "."); \
     lin_init_array(array, type, c, n); \
     if (fread(array, sizeof(type), n, f) != (unsigned) n) \
-      error("Error reading " what " from %s", filename);
+      error("Error reading " what ".");
 
   read_array(verts, double3, nv, cv,  "vertices");
   read_array(tris,  int3,    nt, ct,  "triangles");
@@ -258,19 +270,19 @@ void Orderizer::load_data(const char* filename)
 
   lin_init_array(lbox, double2, cl3, nl);
   if (fread(lbox, sizeof(double2), nl, f) != (unsigned) nl)
-    error("Error reading label bounding boxes from %s", filename);
+    error("Error reading label bounding boxes.");
 
   int* orders = new int[nl];
   if (fread(orders, sizeof(int), nl, f) != (unsigned) nl)
-    error("Error reading element orders from %s", filename);
+    error("Error reading element orders.");
 
   lin_init_array(ltext, char*, cl2, nl);
   for (int i = 0; i < nl; i++)
     ltext[i] = labels[H2D_GET_H_ORDER(orders[i])][H2D_GET_V_ORDER(orders[i])];
+  delete [] orders;
 
   find_min_max();
   unlock_data();
-  fclose(f);
 }
 
 void Orderizer::save_orders_vtk(Space* space, const char* file_name)
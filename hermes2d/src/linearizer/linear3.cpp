@@ -387,6 +387,8 @@ void Vectorizer::process_solution(MeshFunction* xsln, int xitem, MeshFunction* y
   // (based on the assumption that the linear mesh will be
   // about four-times finer than the original mesh).
   int nn = meshes[0]->get_num_elements() + meshes[1]->get_num_elements();
+  if (last_base >= 0)
+    nn = (int) ((long long) nn * (last_base - first_base) / std::max(meshes[0]->get_num_base_elements(), 1));
   int ev = std::max(32 * nn, 10000);
   int et = std::max(64 * nn, 20000);
   int ee = std::max(24 * nn, 7500);
@@ -422,28 +424,14 @@ void Vectorizer::process_solution(MeshFunction* xsln, int xitem, MeshFunction* y
   if (xib >= 6) error("Invalid value of paremeter 'xitem'.");
   if (yib >= 6) error("Invalid value of paremeter 'yitem'.");
 
-  max = 1e-10;
-  trav.begin(2, meshes, fns);
-  Element** e;
-  while ((e = trav.get_next_state(NULL, NULL)) != NULL)
-  {
-    xsln->set_quad_order(0, xitem);
-    ysln->set_quad_order(0, yitem);
-    scalar* xval = xsln->get_values(xia, xib);
-    scalar* yval = ysln->get_values(yia, yib);
-
-    for (unsigned int i = 0; i < e[0]->nvert; i++)
-    {
-      double fx = getvalx(i);
-      double fy = getvaly(i);
-      if (fabs(sqrt(fx*fx + fy*fy)) > max) max = fabs(sqrt(fx*fx + fy*fy));
-    }
-  }
-  trav.finish();
+  // the maximum over all states is given to the threads
+  max = (max_init > 0.0) ? max_init : find_vertex_max(xsln, xitem, ysln, yitem);
 
+  Element** e;
   trav.begin(2, meshes, fns);
+  if (last_base >= 0) trav.set_base_range(first_base, last_base);
   // process all elements of the mesh
-  while ((e = trav.get_next_state(NULL, NULL)) != NULL)
+  while (!is_cancelled() && (e = trav.get_next_state(NULL, NULL)) != NULL)
   {
     xsln->set_quad_order(0, xitem);
     ysln->set_quad_order(0, yitem);
@@ -522,6 +510,191 @@ void Vectorizer::process_solution(MeshFunction* xsln, int xitem, MeshFunction* y
 }
 
 
+double Vectorizer::find_vertex_max(MeshFunction* xsln, int xitem, MeshFunction* ysln, int yitem)
+{
+  int xa, xb, ya, yb;
+  get_gv_a_b(xitem, xa, xb);
+  get_gv_a_b(yitem, ya, yb);
+
+  Quad2D* old_quad_x = xsln->get_quad_2d();
+  Quad2D* old_quad_y = ysln->get_quad_2d();
+  xsln->set_quad_2d((Quad2D*) &quad_lin);
+  ysln->set_quad_2d((Quad2D*) &quad_lin);
+
+  Mesh* meshes[2] = { xsln->get_mesh(), ysln->get_mesh() };
+  Transformable* fns[2] = { xsln, ysln };
+  Traverse trav;
+  trav.begin(2, meshes, fns);
+  if (last_base >= 0) trav.set_base_range(first_base, last_base);
+
+  double vertex_max = 1e-10;
+  Element** e;
+  while (!is_cancelled() && (e = trav.get_next_state(NULL, NULL)) != NULL)
+  {
+    xsln->set_quad_order(0, xitem);
+    ysln->set_quad_order(0, yitem);
+    scalar* xval = xsln->get_values(xa, xb);
+    scalar* yval = ysln->get_values(ya, yb);
+
+    for (unsigned int i = 0; i < e[0]->nvert; i++)
+    {
+      double fx = getvalx(i);
+      double fy = getvaly(i);
+      if (fabs(sqrt(fx*fx + fy*fy)) > vertex_max) vertex_max = fabs(sqrt(fx*fx + fy*fy));
+    }
+  }
+  trav.finish();
+
+  xsln->set_quad_2d(old_quad_x);
+  ysln->set_quad_2d(old_quad_y);
+  return vertex_max;
+}
+
+
+struct Vectorizer::VectorizerThread
+{
+  Vectorizer* vec; // buffers of the thread
+  pthread_t thread;
+
+  MeshFunction *xsln, *ysln;
+  int xitem, yitem;
+  double eps;
+
+  // 1: find the maximum of the magnitudes in the vertices, 2: vectorize
+  int pass;
+  double max;
+};
+
+
+void Vectorizer::process_solution(Hermes::vector<MeshFunction*> xslns, int xitem,
+                                  Hermes::vector<MeshFunction*> yslns, int yitem, double eps)
+{
+  if (xslns.size() == 0 || xslns.size() != yslns.size())
+    error("Numbers of the solutions differ in Vectorizer:process_solution().");
+
+  Mesh* meshes[2] = { xslns[0]->get_mesh(), yslns[0]->get_mesh() };
+  if (meshes[0] == NULL || meshes[1] == NULL)
+    error("One of the meshes is NULL in Vectorizer:process_solution().");
+
+  int count = xslns.size();
+  Hermes::vector<Mesh*> mesh_list(meshes[0], meshes[1]);
+  if (count == 1 || !Traverse::is_mode_uniform(mesh_list))
+  {
+    process_solution(xslns[0], xitem, yslns[0], yitem, eps);
+    return;
+  }
+
+  lock_data();
+  TimePeriod cpu_time;
+
+  // every thread takes a contiguous range of the base elements
+  int* bounds = new int[count + 1];
+  Traverse::split_base_elements(2, meshes, count, bounds);
+  VectorizerThread* threads = new VectorizerThread[count];
+  for (int t = 0; t < count; t++)
+  {
+    threads[t].vec = new Vectorizer();
+    threads[t].vec->first_base = bounds[t];
+    threads[t].vec->last_base = bounds[t + 1];
+    threads[t].vec->parent = this;
+    threads[t].xsln = xslns[t];
+    threads[t].ysln = yslns[t];
+    threads[t].xitem = xitem;
+    threads[t].yitem = yitem;
+    threads[t].eps = eps;
+  }
+  delete [] bounds;
+
+  run_threads(threads, count, 1);
+  double vertex_max = 1e-10;
+  for (int t = 0; t < count; t++)
+    vertex_max = std::max(vertex_max, threads[t].max);
+  for (int t = 0; t < count; t++)
+    threads[t].max = vertex_max;
+
+  if (!is_cancelled())
+    run_threads(threads, count, 2);
+
+  // merge the buffers of the threads
+  nv = nt = ne = nd = 0;
+  del_slot = -1;
+  for (int t = 0; t < count; t++)
+  {
+    nv += threads[t].vec->nv;
+    nt += threads[t].vec->nt;
+    ne += threads[t].vec->ne;
+    nd += threads[t].vec->nd;
+  }
+  lin_init_array(verts, double4, cv, std::max(nv, 1));
+  lin_init_array(tris, int3, ct, std::max(nt, 1));
+  lin_init_array(edges, int3, ce, std::max(ne, 1));
+  lin_init_array(dashes, int2, cd, std::max(nd, 1));
+
+  int ov = 0, ot = 0, oe = 0, od = 0;
+  for (int t = 0; t < count; t++)
+  {
+    Vectorizer* vec = threads[t].vec;
+    memcpy(verts + ov, vec->verts, sizeof(double4) * vec->nv);
+    for (int i = 0; i < vec->nt; i++)
+      for (int j = 0; j < 3; j++)
+        tris[ot + i][j] = vec->tris[i][j] + ov;
+    for (int i = 0; i < vec->ne; i++)
+    {
+      edges[oe + i][0] = vec->edges[i][0] + ov;
+      edges[oe + i][1] = vec->edges[i][1] + ov;
+      edges[oe + i][2] = vec->edges[i][2];
+    }
+    for (int i = 0; i < vec->nd; i++)
+    {
+      dashes[od + i][0] = vec->dashes[i][0] + ov;
+      dashes[od + i][1] = vec->dashes[i][1] + ov;
+    }
+    ov += vec->nv;
+    ot += vec->nt;
+    oe += vec->ne;
+    od += vec->nd;
+
+    delete vec;
+  }
+  delete [] threads;
+
+  find_min_max();
+  verbose("Vectorizer created %d verts and %d tris by %d threads in %0.3g s", nv, nt, count, cpu_time.tick().last());
+  unlock_data();
+}
+
+
+void Vectorizer::run_threads(VectorizerThread* threads, int count, int pass)
+{
+  for (int t = 0; t < count; t++)
+    threads[t].pass = pass;
+
+  // the first range is processed by the calling thread
+  for (int t = 1; t < count; t++)
+    if (pthread_create(&threads[t].thread, NULL, vectorizer_thread, threads + t) != 0)
+      error("Could not create a thread in Vectorizer::run_threads().");
+  vectorizer_thread(threads);
+  for (int t = 1; t < count; t++)
+    pthread_join(threads[t].thread, NULL);
+}
+
+
+void* Vectorizer::vectorizer_thread(void* data)
+{
+  VectorizerThread* vt = (VectorizerThread*) data;
+  if (vt->pass == 1)
+  {
+    vt->max = vt->vec->find_vertex_max(vt->xsln, vt->xitem, vt->ysln, vt->yitem);
+  }
+  else
+  {
+    vt->vec->max_init = vt->max;
+    vt->vec->process_solution(vt->xsln, vt->xitem, vt->ysln, vt->yitem, vt->eps);
+  }
+  return NULL;
+}
+
+
 //// save & load ///////////////////////////////////////////////////////////////////////////////////
 
 void Vectorizer::save_data(const char* filename)
@@ -585,7 +758,7 @@ void Vectorizer::load_data(const char* filename)
 Vectorizer::~Vectorizer()
 {
   lin_free_array(verts, nv, cv);
-  // fixme: free dashes?
+  lin_free_array(dashes, nd, cd);
 }
 
 //// others ///////////////////////////////////////////////////////////////////////////////////
@@ -159,19 +159,33 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
   if (!s.good()) error("Mesh file not found.");
   s.close();
   
+  std::string fName(filename);
+  MeshData m(fName);
+  m.parse_mesh();
+
+  return load(&m, mesh, filename);
+}
+
+bool H2DReader::load_str(const char *mesh_str, Mesh *mesh)
+{
+  std::istringstream s(mesh_str);
+  MeshData m("");
+  m.parse_mesh(s);
+
+  return load(&m, mesh, "mesh string");
+}
+
+bool H2DReader::load(MeshData *m, Mesh *mesh, const char *filename)
+{
   int i, j, k, n;
   Node* en;
   bool debug = false;
 
   mesh->free();
 
-  std::string fName(filename);
-  MeshData m(fName);
-  m.parse_mesh();
-
   //// vertices ////////////////////////////////////////////////////////////////
   
-  n = m.n_vert;
+  n = m->n_vert;
   if (n < 0) error("File %s: 'vertices' must be a list.", filename);
   if (n < 2) error("File %s: invalid number of vertices.", filename);
 
@@ -190,14 +204,14 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
     node->bnd = 0;
     node->p1 = node->p2 = -1;
     node->next_hash = NULL;
-	node->x = m.x_vertex[i];
-	node->y = m.y_vertex[i];
+	node->x = m->x_vertex[i];
+	node->y = m->y_vertex[i];
   }
   mesh->ntopvert = n;
 
   //// elements ////////////////////////////////////////////////////////////////
 
-  n = m.n_el;
+  n = m->n_el;
   if (n < 0) error("File %s: 'elements' must be a list.", filename);
   if (n < 1) error("File %s: no elements defined.", filename);
 
@@ -207,7 +221,7 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
   {
     // read and check vertex indices
 	int nv;
-	if (m.en4[i] == -1)	nv = 4;
+	if (m->en4[i] == -1)	nv = 4;
 	else nv = 5;
 	
 	int* idx = new int[nv-1];
@@ -221,19 +235,19 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
        error("File %s: element #%d: wrong number of vertex indices.", filename, i);
     
 	if (nv == 4) {
-	  idx[0] = m.en1[i];
-	  idx[1] = m.en2[i];
-	  idx[2] = m.en3[i];
+	  idx[0] = m->en1[i];
+	  idx[1] = m->en2[i];
+	  idx[2] = m->en3[i];
 	  
-	  el_marker = m.e_mtl[i];
+	  el_marker = m->e_mtl[i];
     } 
     else {
-	  idx[0] = m.en1[i];
-	  idx[1] = m.en2[i];
-	  idx[2] = m.en3[i];
-	  idx[3] = m.en4[i];
+	  idx[0] = m->en1[i];
+	  idx[1] = m->en2[i];
+	  idx[2] = m->en3[i];
+	  idx[3] = m->en4[i];
 	  
-	  el_marker = m.e_mtl[i];
+	  el_marker = m->e_mtl[i];
     }
     for (j = 0; j < nv-1; j++)
       if (idx[j] < 0 || idx[j] >= mesh->ntopvert)
@@ -265,23 +279,23 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
   mesh->nbase = n;
 
   //// boundaries //////////////////////////////////////////////////////////////
-  if (m.n_bdy > 0)
+  if (m->n_bdy > 0)
   {
-	n = m.n_bdy;
+	n = m->n_bdy;
 
     // read boundary data
     for (i = 0; i < n; i++)
     {
       int v1, v2, marker;
-	  v1 = m.bdy_first[i];
-	  v2 = m.bdy_second[i];
+	  v1 = m->bdy_first[i];
+	  v2 = m->bdy_second[i];
 	  
       en = mesh->peek_edge_node(v1, v2);
       if (en == NULL)
         error("File %s: boundary data #%d: edge %d-%d does not exist", filename, i, v1, v2);
 
       std::string bnd_marker;
-	  bnd_marker = m.bdy_type[i];
+	  bnd_marker = m->bdy_type[i];
 
       // This functions check if the user-supplied marker on this element has been
       // already used, and if not, inserts it in the appropriate structure.
@@ -314,9 +328,9 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
 #endif
 
   //// curves //////////////////////////////////////////////////////////////////
-  if (m.n_curv > 0)
+  if (m->n_curv > 0)
   {
-	n = m.n_curv;
+	n = m->n_curv;
     if (n < 0) error("File %s: 'curves' must be a list.", filename);
 
     // load curved edges
@@ -326,7 +340,7 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
       Node* en;
       int p1, p2;
 	  
-      Nurbs* nurbs = load_nurbs(mesh, &m, i, &en, p1, p2);
+      Nurbs* nurbs = load_nurbs(mesh, m, i, &en, p1, p2);
 
       // assign the nurbs to the elements sharing the edge node
       for (k = 0; k < 2; k++)
@@ -370,17 +384,17 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
       e->cm->update_refmap_coeffs(e);
 
   //// refinements /////////////////////////////////////////////////////////////
-  if (m.n_ref > 0)
+  if (m->n_ref > 0)
   {
-	n = m.n_ref;
+	n = m->n_ref;
     if (n < 0) error("File %s: 'refinements' must be a list.", filename);
 
     // perform initial refinements
     for (i = 0; i < n; i++)
     {
       int id, ref;
-	  id = m.ref_elt[i];
-	  ref = m.ref_type[i];
+	  id = m->ref_elt[i];
+	  ref = m->ref_type[i];
       mesh->refine_element_id(id, ref);
     }
   }
@@ -455,12 +469,21 @@ static bool is_twin_nurbs(Element* e, int i)
 
 bool H2DReader::save(const char* filename, Mesh *mesh)
 {
-  int i, mrk;
-  Element* e;
-
   // open output file
   FILE* f = fopen(filename, "w");
   if (f == NULL) error("Could not create mesh file.");
+
+  bool ok = save(f, mesh);
+  fclose(f);
+
+  return ok;
+}
+
+bool H2DReader::save(FILE* f, Mesh *mesh)
+{
+  int i, mrk;
+  Element* e;
+
   //fprintf(f, "# hermes2d saved mesh\n\n");
 
   // save vertices
@@ -478,9 +501,11 @@ bool H2DReader::save(const char* filename, Mesh *mesh)
     if (!e->used)
       fprintf(f, "%s  { }", nl);
     else if (e->is_triangle())
-      fprintf(f, "%s  { %d, %d, %d, %d }", nl, e->vn[0]->id, e->vn[1]->id, e->vn[2]->id, e->marker);
+      fprintf(f, "%s  { %d, %d, %d, \"%s\" }", nl, e->vn[0]->id, e->vn[1]->id, e->vn[2]->id,
+              mesh->element_markers_conversion.get_user_marker(e->marker).c_str());
     else
-      fprintf(f, "%s  { %d, %d, %d, %d, %d }", nl, e->vn[0]->id, e->vn[1]->id, e->vn[2]->id, e->vn[3]->id, e->marker);
+      fprintf(f, "%s  { %d, %d, %d, %d, \"%s\" }", nl, e->vn[0]->id, e->vn[1]->id, e->vn[2]->id, e->vn[3]->id,
+              mesh->element_markers_conversion.get_user_marker(e->marker).c_str());
   }
 
   // save boundary markers
@@ -514,7 +539,6 @@ bool H2DReader::save(const char* filename, Mesh *mesh)
   if (!first) fprintf(f, "\n}\n\n");
 
   mesh->seq = temp;
-  fclose(f);
 
   return true;
 }
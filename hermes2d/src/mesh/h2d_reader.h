@@ -29,7 +29,14 @@ public:
   virtual ~H2DReader();
 
   virtual bool load(const char *file_name, Mesh *mesh);
+  /// Creates the mesh from data parsed from a file or filled in by a mesh generator,
+  /// file_name is used in error messages only.
+  bool load(MeshData *m, Mesh *mesh, const char *file_name = "mesh data");
+  /// Creates the mesh from the mesh text held in memory.
+  bool load_str(const char *mesh_str, Mesh *mesh);
   virtual bool save(const char *file_name, Mesh *mesh);
+  /// Writes the mesh text to an open stream.
+  bool save(FILE* f, Mesh *mesh);
 
 protected:
   Nurbs* load_nurbs_old(Mesh *mesh, FILE* f, Node** en, int &p1, int &p2);
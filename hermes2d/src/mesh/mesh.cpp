@@ -16,6 +16,7 @@
 #include "../h2d_common.h"
 #include "mesh.h"
 #include "h2d_reader.h"
+#include "mesh_hash_grid.h"
 
 
 //// nodes, element ////////////////////////////////////////////////////////////////////////////////
@@ -125,6 +126,8 @@ Mesh::Mesh() : HashTable()
 {
   nbase = nactive = ntopvert = ninitial = 0;
   seq = g_mesh_seq++;
+  hash_grid = NULL;
+  pthread_mutex_init(&hash_grid_mutex, NULL);
 }
 
 Element* Mesh::get_element(int id) const
@@ -134,6 +137,27 @@ Element* Mesh::get_element(int id) const
   return &(elements[id]);
 }
 
+MeshHashGrid* Mesh::get_hash_grid()
+{
+  pthread_mutex_lock(&hash_grid_mutex);
+  if (hash_grid != NULL && hash_grid->get_mesh_seq() != seq)
+  {
+    delete hash_grid;
+    hash_grid = NULL;
+  }
+  if (hash_grid == NULL)
+    hash_grid = new MeshHashGrid(this);
+  MeshHashGrid* grid = hash_grid;
+  pthread_mutex_unlock(&hash_grid_mutex);
+
+  return grid;
+}
+
+Element* Mesh::element_on_physical_coordinates(double x, double y)
+{
+  return get_hash_grid()->get_element(x, y);
+}
+
 int Mesh::get_edge_sons(Element* e, int edge, int& son1, int& son2)
 {
   assert(!e->active);
@@ -1110,6 +1134,13 @@ bool Mesh::rescale(double x_ref, double y_ref)
     n->y /= y_ref;
   }
 
+  // the point location grid is no longer valid
+  if (hash_grid != NULL)
+  {
+    delete hash_grid;
+    hash_grid = NULL;
+  }
+
   return true;
 }
 
@@ -1253,6 +1284,12 @@ void Mesh::free()
 
   elements.free();
   HashTable::free();
+
+  if (hash_grid != NULL)
+  {
+    delete hash_grid;
+    hash_grid = NULL;
+  }
 }
 
 void Mesh::copy_converted(Mesh* mesh)
@@ -21,6 +21,7 @@
 
 class Element;
 class HashTable;
+class MeshHashGrid;
 class Space;
 struct MItem;
 
@@ -161,6 +162,7 @@ public:
   ~Mesh() {
     free();
     dump_hash_stat();
+    pthread_mutex_destroy(&hash_grid_mutex);
   }
   /// Creates a copy of another mesh.
   void copy(const Mesh* mesh);
@@ -198,6 +200,15 @@ public:
   /// Retrieves an element by its id number.
   Element* get_element(int id) const;
 
+  /// Returns the active element containing the point (x, y), NULL if the point
+  /// lies outside the mesh. Ignores element curvature.
+  Element* element_on_physical_coordinates(double x, double y);
+
+  /// Returns the point location grid of the active elements. The grid is
+  /// (re)built on the first call after the mesh has changed; concurrent
+  /// calls are safe as long as the mesh itself is not being modified.
+  MeshHashGrid* get_hash_grid();
+
   /// Returns the total number of elements stored.
   int get_num_elements() const {
     if (this == NULL) error("this == NULL in Mesh::get_num_elements().");
@@ -332,6 +343,12 @@ protected:
   int* parents;
   int parents_size;
 
+  MeshHashGrid* hash_grid; ///< point location grid, see get_hash_grid()
+  pthread_mutex_t hash_grid_mutex; ///< guards building of hash_grid
+
+  Mesh(const Mesh&); ///< not copyable (owns hash_grid), use copy()
+  Mesh& operator=(const Mesh&);
+
   int  get_edge_degree(Node* v1, Node* v2);
   void assign_parent(Element* e, int i);
   void regularize_triangle(Element* e);
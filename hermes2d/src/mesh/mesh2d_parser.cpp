@@ -83,6 +83,12 @@ std::string MeshData::restore(std::string &str)
 }
 
 void MeshData::parse_mesh(void)
+{
+	std::ifstream inFile(mesh_file_.c_str());
+	parse_mesh(inFile);
+}
+
+void MeshData::parse_mesh(std::istream &inFile)
 {
 	std::vector<std::string> varlist;
 
@@ -90,7 +96,6 @@ void MeshData::parse_mesh(void)
 	double dummy_dbl;
 	std::string dummy_str;
 	
-	std::ifstream inFile(mesh_file_.c_str());
 	std::string line, word, temp_word, next_word;
 
 	int counter(0);
@@ -82,6 +82,8 @@ public:
 	
 	/// This function parses a given input mesh file line by line and extracts the necessary information into the MeshData class variables
 	void parse_mesh(void);
+	/// Parses the mesh from the stream (e.g. mesh text held in memory)
+	void parse_mesh(std::istream &inFile);
 	
 	/// MeshData Constructor
 	MeshData(const std::string &mesh_file) 
@@ -0,0 +1,161 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "../h2d_common.h"
+#include "mesh.h"
+#include "mesh_hash_grid.h"
+
+#include <limits>
+
+
+MeshHashGrid::MeshHashGrid(Mesh* mesh)
+{
+  _F_
+  mesh_seq = mesh->get_seq();
+  cell_start = NULL;
+  cell_elems = NULL;
+  nx = ny = 0;
+
+  // bounding box of the active elements
+  Element* e;
+  x_min = y_min = std::numeric_limits<double>::max();
+  double x_max = -std::numeric_limits<double>::max(), y_max = -std::numeric_limits<double>::max();
+  for_all_active_elements(e, mesh)
+  {
+    for (unsigned int i = 0; i < e->nvert; i++)
+    {
+      x_min = std::min(x_min, e->vn[i]->x);
+      x_max = std::max(x_max, e->vn[i]->x);
+      y_min = std::min(y_min, e->vn[i]->y);
+      y_max = std::max(y_max, e->vn[i]->y);
+    }
+  }
+  int nactive = mesh->get_num_active_elements();
+  if (nactive == 0) return;
+
+  // curved elements may bulge out of the vertex bounding box
+  double margin = 1e-3 * std::max(x_max - x_min, y_max - y_min);
+  for_all_active_elements(e, mesh)
+    if (e->is_curved())
+      margin = std::max(margin, 0.5 * e->get_diameter());
+  x_min -= margin; y_min -= margin;
+  x_max += margin; y_max += margin;
+
+  // about one element per cell, cells as square as possible
+  double w = x_max - x_min, h = y_max - y_min;
+  nx = std::max(1, std::min(nactive, (int) ceil(sqrt(nactive * w / h))));
+  ny = std::max(1, std::min(nactive, (int) ceil((double) nactive / nx)));
+  h_x = w / nx;
+  h_y = h / ny;
+
+  // first pass: count the elements in cells
+  cell_start = new int[nx * ny + 1];
+  memset(cell_start, 0, (nx * ny + 1) * sizeof(int));
+  int i1, j1, i2, j2;
+  for_all_active_elements(e, mesh)
+  {
+    get_cell_range(e, i1, j1, i2, j2);
+    for (int j = j1; j <= j2; j++)
+      for (int i = i1; i <= i2; i++)
+        cell_start[j * nx + i + 1]++;
+  }
+  for (int i = 0; i < nx * ny; i++)
+    cell_start[i + 1] += cell_start[i];
+
+  // second pass: fill the cells
+  cell_elems = new Element*[cell_start[nx * ny]];
+  int* pos = new int[nx * ny];
+  memcpy(pos, cell_start, nx * ny * sizeof(int));
+  for_all_active_elements(e, mesh)
+  {
+    get_cell_range(e, i1, j1, i2, j2);
+    for (int j = j1; j <= j2; j++)
+      for (int i = i1; i <= i2; i++)
+        cell_elems[pos[j * nx + i]++] = e;
+  }
+  delete [] pos;
+}
+
+MeshHashGrid::~MeshHashGrid()
+{
+  delete [] cell_start;
+  delete [] cell_elems;
+}
+
+void MeshHashGrid::get_cell_range(Element* e, int& i1, int& j1, int& i2, int& j2) const
+{
+  double ex_min = e->vn[0]->x, ex_max = e->vn[0]->x;
+  double ey_min = e->vn[0]->y, ey_max = e->vn[0]->y;
+  for (unsigned int i = 1; i < e->nvert; i++)
+  {
+    ex_min = std::min(ex_min, e->vn[i]->x);
+    ex_max = std::max(ex_max, e->vn[i]->x);
+    ey_min = std::min(ey_min, e->vn[i]->y);
+    ey_max = std::max(ey_max, e->vn[i]->y);
+  }
+  if (e->is_curved())
+  {
+    double margin = 0.5 * e->get_diameter();
+    ex_min -= margin; ey_min -= margin;
+    ex_max += margin; ey_max += margin;
+  }
+
+  i1 = std::max(0, std::min(nx - 1, (int) floor((ex_min - x_min) / h_x)));
+  i2 = std::max(0, std::min(nx - 1, (int) floor((ex_max - x_min) / h_x)));
+  j1 = std::max(0, std::min(ny - 1, (int) floor((ey_min - y_min) / h_y)));
+  j2 = std::max(0, std::min(ny - 1, (int) floor((ey_max - y_min) / h_y)));
+}
+
+Element** MeshHashGrid::get_candidates(double x, double y, int& count) const
+{
+  count = 0;
+  if (cell_start == NULL) return NULL;
+
+  int i = (int) floor((x - x_min) / h_x);
+  int j = (int) floor((y - y_min) / h_y);
+  if (i < 0 || i >= nx || j < 0 || j >= ny) return NULL;
+
+  int cell = j * nx + i;
+  count = cell_start[cell + 1] - cell_start[cell];
+  return cell_elems + cell_start[cell];
+}
+
+bool MeshHashGrid::is_in_element(Element* e, double x, double y)
+{
+  // the point has to lie on the same side of all edges
+  const double TOL = 1e-10;
+  double tol = TOL * sqr(e->get_diameter());
+  bool pos = true, neg = true;
+  for (unsigned int i = 0; i < e->nvert; i++)
+  {
+    Node* v1 = e->vn[i];
+    Node* v2 = e->vn[e->next_vert(i)];
+    double z = (v2->x - v1->x) * (y - v1->y) - (v2->y - v1->y) * (x - v1->x);
+    if (z < -tol) pos = false;
+    if (z > tol) neg = false;
+  }
+  return pos || neg;
+}
+
+Element* MeshHashGrid::get_element(double x, double y) const
+{
+  int count;
+  Element** elems = get_candidates(x, y, count);
+  for (int i = 0; i < count; i++)
+    if (is_in_element(elems[i], x, y))
+      return elems[i];
+
+  return NULL;
+}
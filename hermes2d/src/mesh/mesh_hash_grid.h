@@ -0,0 +1,72 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __H2D_MESH_HASH_GRID_H
+#define __H2D_MESH_HASH_GRID_H
+
+#include "../h2d_common.h"
+
+class Mesh;
+class Element;
+
+
+/// \brief Uniform bucket grid over the active elements of a mesh.
+///
+/// The bounding box of the mesh is divided into roughly as many cells as there
+/// are active elements, and every cell stores the elements whose bounding box
+/// overlaps it. Point location then only has to test the few elements of one
+/// cell instead of all active elements. The grid remembers the sequence number
+/// of the mesh it was built for, see Mesh::get_hash_grid().
+///
+class HERMES_API MeshHashGrid
+{
+public:
+
+  MeshHashGrid(Mesh* mesh);
+  ~MeshHashGrid();
+
+  /// Returns the sequence number of the mesh the grid was built for.
+  unsigned get_mesh_seq() const { return mesh_seq; }
+
+  /// Returns the candidate elements for the point (x, y). The elements are not
+  /// guaranteed to contain the point, they only have overlapping bounding boxes.
+  /// \param count [out] Number of returned elements, zero if the point lies
+  /// outside the mesh bounding box.
+  Element** get_candidates(double x, double y, int& count) const;
+
+  /// Returns the active element containing the point (x, y), NULL if there
+  /// is no such element. Ignores element curvature.
+  Element* get_element(double x, double y) const;
+
+  /// Returns true if the point (x, y) lies in the element. Ignores element
+  /// curvature, the element is assumed to be convex.
+  static bool is_in_element(Element* e, double x, double y);
+
+protected:
+
+  unsigned mesh_seq;
+
+  double x_min, y_min; ///< lower left corner of the grid
+  double h_x, h_y;     ///< cell size
+  int nx, ny;          ///< number of cells
+
+  int* cell_start;     ///< cell i holds elements cell_elems[cell_start[i]..cell_start[i+1]-1]
+  Element** cell_elems;
+
+  /// Returns the range of cells covered by the bounding box of the element.
+  void get_cell_range(Element* e, int& i1, int& j1, int& i2, int& j2) const;
+};
+
+#endif
@@ -20,7 +20,7 @@
 
 
 H1ShapesetJacobi ref_map_shapeset;
-PrecalcShapeset ref_map_pss(&ref_map_shapeset);
+PrecalcShapeset shared_ref_map_pss(&ref_map_shapeset);
 
 
 RefMap::RefMap()
@@ -29,16 +29,35 @@ RefMap::RefMap()
   num_tables = 0;
   cur_node = NULL;
   overflow = NULL;
+  ref_map_pss = &shared_ref_map_pss;
   set_quad_2d(&g_quad_2d_std); // default quadrature
 }
 
 
+RefMap::~RefMap()
+{
+  free();
+  if (ref_map_pss != &shared_ref_map_pss)
+    delete ref_map_pss;
+}
+
+
+void RefMap::use_private_pss()
+{
+  if (ref_map_pss != &shared_ref_map_pss)
+    return;
+
+  ref_map_pss = new PrecalcShapeset(&ref_map_shapeset);
+  ref_map_pss->set_quad_2d(quad_2d);
+}
+
+
 
 void RefMap::set_quad_2d(Quad2D* quad_2d)
 {
   free();
   this->quad_2d = quad_2d;
-  ref_map_pss.set_quad_2d(quad_2d);
+  ref_map_pss->set_quad_2d(quad_2d);
 }
 
 
@@ -46,7 +65,7 @@ void RefMap::set_active_element(Element* e)
 {
   if (e != element) free();
 
-  ref_map_pss.set_active_element(e);
+  ref_map_pss->set_active_element(e);
   quad_2d->set_mode(e->get_mode());
   num_tables = quad_2d->get_num_tables();
   assert(num_tables <= H2D_MAX_TABLES);
@@ -128,13 +147,13 @@ void RefMap::calc_inv_ref_map(int order)
 
   double2x2* m = new double2x2[np];
   memset(m, 0, np * sizeof(double2x2));
-  ref_map_pss.force_transform(sub_idx, ctm);
+  ref_map_pss->force_transform(sub_idx, ctm);
   for (i = 0; i < nc; i++)
   {
     double *dx, *dy;
-    ref_map_pss.set_active_shape(indices[i]);
-    ref_map_pss.set_quad_order(order);
-    ref_map_pss.get_dx_dy_values(dx, dy);
+    ref_map_pss->set_active_shape(indices[i]);
+    ref_map_pss->set_quad_order(order);
+    ref_map_pss->get_dx_dy_values(dx, dy);
     for (j = 0; j < np; j++)
     {
       m[j][0][0] += coeffs[i][0] * dx[j];
@@ -175,15 +194,15 @@ void RefMap::calc_second_ref_map(int order)
 
   double3x2* k = new double3x2[np];
   memset(k, 0, np * sizeof(double3x2));
-  ref_map_pss.force_transform(sub_idx, ctm);
+  ref_map_pss->force_transform(sub_idx, ctm);
   for (i = 0; i < nc; i++)
   {
     double *dxy, *dxx, *dyy;
-    ref_map_pss.set_active_shape(indices[i]);
-    ref_map_pss.set_quad_order(order, H2D_FN_ALL);
-    dxx = ref_map_pss.get_dxx_values();
-    dyy = ref_map_pss.get_dyy_values();
-    dxy = ref_map_pss.get_dxy_values();
+    ref_map_pss->set_active_shape(indices[i]);
+    ref_map_pss->set_quad_order(order, H2D_FN_ALL);
+    dxx = ref_map_pss->get_dxx_values();
+    dyy = ref_map_pss->get_dyy_values();
+    dxy = ref_map_pss->get_dxy_values();
     for (j = 0; j < np; j++)
     {
       k[j][0][0] += coeffs[i][0] * dxx[j];
@@ -266,12 +285,12 @@ void RefMap::calc_phys_x(int order)
   int i, j, np = quad_2d->get_num_points(order);
   double* x = cur_node->phys_x[order] = new double[np];
   memset(x, 0, np * sizeof(double));
-  ref_map_pss.force_transform(sub_idx, ctm);
+  ref_map_pss->force_transform(sub_idx, ctm);
   for (i = 0; i < nc; i++)
   {
-    ref_map_pss.set_active_shape(indices[i]);
-    ref_map_pss.set_quad_order(order);
-    double* fn = ref_map_pss.get_fn_values();
+    ref_map_pss->set_active_shape(indices[i]);
+    ref_map_pss->set_quad_order(order);
+    double* fn = ref_map_pss->get_fn_values();
     for (j = 0; j < np; j++)
       x[j] += coeffs[i][0] * fn[j];
   }
@@ -284,12 +303,12 @@ void RefMap::calc_phys_y(int order)
   int i, j, np = quad_2d->get_num_points(order);
   double* y = cur_node->phys_y[order] = new double[np];
   memset(y, 0, np * sizeof(double));
-  ref_map_pss.force_transform(sub_idx, ctm);
+  ref_map_pss->force_transform(sub_idx, ctm);
   for (i = 0; i < nc; i++)
   {
-    ref_map_pss.set_active_shape(indices[i]);
-    ref_map_pss.set_quad_order(order);
-    double* fn = ref_map_pss.get_fn_values();
+    ref_map_pss->set_active_shape(indices[i]);
+    ref_map_pss->set_quad_order(order);
+    double* fn = ref_map_pss->get_fn_values();
     for (j = 0; j < np; j++)
       y[j] += coeffs[i][1] * fn[j];
   }
@@ -320,16 +339,16 @@ void RefMap::calc_tangent(int edge, int eo)
   else
   {
     // construct jacobi matrices of the direct reference map at integration points along the edge
-    static double2x2 m[15];
+    double2x2 m[15];
     assert(np <= 15);
     memset(m, 0, np*sizeof(double2x2));
-    ref_map_pss.force_transform(sub_idx, ctm);
+    ref_map_pss->force_transform(sub_idx, ctm);
     for (i = 0; i < nc; i++)
     {
       double *dx, *dy;
-      ref_map_pss.set_active_shape(indices[i]);
-      ref_map_pss.set_quad_order(eo);
-      ref_map_pss.get_dx_dy_values(dx, dy);
+      ref_map_pss->set_active_shape(indices[i]);
+      ref_map_pss->set_quad_order(eo);
+      ref_map_pss->get_dx_dy_values(dx, dy);
       for (j = 0; j < np; j++)
       {
         m[j][0][0] += coeffs[i][0] * dx[j];
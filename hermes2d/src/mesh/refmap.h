@@ -36,7 +36,7 @@ class HERMES_API RefMap : public Transformable
 public:
 
   RefMap();
-  ~RefMap() { free(); }
+  ~RefMap();
 
   /// Sets the quadrature points in which the reference map will be evaluated.
   /// \param quad_2d [in] The quadrature points.
@@ -45,6 +45,12 @@ public:
   /// Returns the current quadrature points.
   Quad2D* get_quad_2d() const { return quad_2d; }
 
+  /// By default, all reference maps share one precalculated shapeset for the
+  /// evaluation of the mapping. This makes the reference map use its own one,
+  /// so that it can be used concurrently with other reference maps in another
+  /// thread. Has to be called from the main thread.
+  void use_private_pss();
+
   /// Returns the 1D quadrature for use in surface integrals.
   const Quad1D* get_quad_1d() const { return &quad_1d; }
 
@@ -165,6 +171,9 @@ protected:
   Quad2D* quad_2d;
   int num_tables;
 
+  /// Precalculated shapeset of the reference mapping, see use_private_pss().
+  PrecalcShapeset* ref_map_pss;
+
   bool is_const;
   int inv_ref_order;
 
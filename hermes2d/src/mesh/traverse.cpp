@@ -241,7 +241,7 @@ Element** Traverse::get_next_state(bool* bnd, SurfPos* surf_pos)
       {
         // No more base elements? we're finished.
 				// Id is set to zero at the beginning by the function trav.begin(..).
-        if (id >= meshes[0]->get_num_base_elements())
+        if (id >= last_id)
           return NULL;
         int nused = 0;
 				// The variable num is the number of meshes in the stage
@@ -502,6 +502,7 @@ void Traverse::begin(int n, Mesh** meshes, Transformable** fn)
   sons = new int4[num];
   subs = new uint64_t[num];
   id = 0;
+  last_id = meshes[0]->get_num_base_elements();
 
 #ifndef H2D_DISABLE_MULTIMESH_TESTS
   // Test whether all master meshes have the same number of elements.
@@ -568,6 +569,65 @@ void Traverse::finish()
 }
 
 
+void Traverse::set_base_range(int first, int last)
+{
+  assert(top == 0 && first >= 0);
+  id = first;
+  last_id = std::min(last, meshes[0]->get_num_base_elements());
+}
+
+
+void Traverse::split_base_elements(int n, Mesh** meshes, int count, int* bounds)
+{
+  // weight of a base element: the number of its active descendants in all meshes
+  int nbase = meshes[0]->get_num_base_elements();
+  int* weight = new int[nbase];
+  memset(weight, 0, sizeof(int) * nbase);
+  int total = 0;
+  for (int i = 0; i < n; i++)
+  {
+    Element* e;
+    for_all_active_elements(e, meshes[i])
+    {
+      Element* b = e;
+      while (b->parent != NULL) b = b->parent;
+      weight[b->id]++;
+      total++;
+    }
+  }
+
+  bounds[0] = 0;
+  int t = 1, sum = 0;
+  for (int id = 0; id < nbase && t < count; id++)
+  {
+    sum += weight[id];
+    while (t < count && sum >= (int) ((long long) total * t / count))
+      bounds[t++] = id + 1;
+  }
+  while (t <= count)
+    bounds[t++] = nbase;
+
+  delete [] weight;
+}
+
+
+bool Traverse::is_mode_uniform(Hermes::vector<Mesh *>& meshes)
+{
+  int mode = -1;
+  for (unsigned int i = 0; i < meshes.size(); i++) {
+    Element* e;
+    for_all_active_elements(e, meshes[i]) {
+      if (mode == -1)
+        mode = e->get_mode();
+      else if (e->get_mode() != mode)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+
 
 //// union mesh ////////////////////////////////////////////////////////////////////////////////////
 
@@ -60,6 +60,20 @@ public:
   Element** get_next_state(bool* bnd, SurfPos* surf_pos);
   Element*  get_base() const { return base; }
 
+  /// Restricts the traversal to the states of the base elements first <= id < last.
+  /// Has to be called after begin() and before the first get_next_state().
+  void set_base_range(int first, int last);
+
+  /// Splits the base elements of the meshes into count contiguous ranges
+  /// [bounds[t], bounds[t+1]) with about the same numbers of active elements,
+  /// e.g. for several threads traversing the meshes at once (see set_base_range()).
+  static void split_base_elements(int n, Mesh** meshes, int count, int* bounds);
+
+  /// Returns true if all active elements of the meshes are of the same type. The global
+  /// quadratures and shapesets switch the mode per element, so only such meshes can be
+  /// traversed by several threads at once.
+  static bool is_mode_uniform(Hermes::vector<Mesh *>& meshes);
+
   UniData** construct_union_mesh(Mesh* unimesh);
 
 private:
@@ -71,7 +85,7 @@ private:
   State* stack;
   int top, size;
 
-  int id;
+  int id, last_id;
   bool tri;
   Element* base;
   int4* sons;
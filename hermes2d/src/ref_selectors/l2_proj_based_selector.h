@@ -75,6 +75,10 @@ namespace RefinementSelectors {
     /**  Overriden function. For details, see ProjBasedSelector::evaluate_error_squared_subdomain(). */
     virtual double evaluate_error_squared_subdomain(Element* sub_elem, const ElemGIP& sub_gip, const ElemSubTrf& sub_trf, const ElemProj& elem_proj);
 
+    /// Creates a new selector with the same settings and the same shapeset.
+    /**  Overriden function. For details, see Selector::clone(). */
+    virtual Selector* clone();
+
   protected: //defaults
     static L2Shapeset default_shapeset; ///< A default shapeset.
   };
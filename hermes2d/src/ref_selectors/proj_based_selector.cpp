@@ -45,6 +45,13 @@ namespace RefinementSelectors {
         }
   }
 
+  Selector* ProjBasedSelector::copy_settings(ProjBasedSelector* copy) const {
+    copy->opt_symmetric_mesh = opt_symmetric_mesh;
+    copy->opt_apply_exp_dof = opt_apply_exp_dof;
+    copy->set_error_weights(error_weight_h, error_weight_p, error_weight_aniso);
+    return copy;
+  }
+
   void ProjBasedSelector::set_error_weights(double weight_h, double weight_p, double weight_aniso) {
     error_weight_h = weight_h;
     error_weight_p = weight_p;
@@ -168,7 +175,8 @@ namespace RefinementSelectors {
 
     // obtain reference solution values on all four refined sons
     scalar** rval[H2D_MAX_ELEMENT_SONS];
-    Element* base_element = rsln->get_mesh()->get_element(e->id);
+    // the ids of the reference mesh may differ, see Space::update_refined_spaces()
+    Element* base_element = Space::get_ref_element(rsln->get_mesh(), e);
     if(base_element->active) {
       info("Have you calculated element errors twice with solutions_for_adaptivity == true?");
       error("Program is aborting based on a failed assertion in ProjBasedSelector::calc_projection_errors().");
@@ -173,6 +173,11 @@ namespace RefinementSelectors {
      *  \param[in] edge_bubble_order A range of orders for edge and bubble functions. Use an empty range (i.e. Range<int>()) to skip edge and bubble functions. */
     ProjBasedSelector(CandList cand_list, double conv_exp, int max_order, Shapeset* shapeset, const Range<int>& vertex_order, const Range<int>& edge_bubble_order);
 
+    /// Copies the options and the error weights of the selector to a new selector. Used by clone() of derived classes.
+    /** \param[in] copy A new selector created with the same parameters of the constructor.
+     *  \return The selector \a copy. */
+    Selector* copy_settings(ProjBasedSelector* copy) const;
+
   protected: //internal logic
     /// True if the selector has already warned about possible inefficiency.
     /** If OptimumSelector::cand_list does not generate candidates with elements of
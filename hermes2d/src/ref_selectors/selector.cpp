@@ -5,6 +5,19 @@
 
 namespace RefinementSelectors {
 
+  Selector::~Selector() {
+    for (unsigned int i = 0; i < thread_copies.size(); i++)
+      delete thread_copies[i];
+  }
+
+  Selector* Selector::get_thread_copy(int thread) {
+    if ((int) thread_copies.size() <= thread)
+      thread_copies.resize(thread + 1, NULL);
+    if (thread_copies[thread] == NULL)
+      thread_copies[thread] = clone();
+    return thread_copies[thread];
+  }
+
   bool HOnlySelector::select_refinement(Element* element, int quad_order, Solution* rsln, ElementToRefine& refinement) {
     refinement.split = H2D_REFINEMENT_H;
     refinement.p[0] = refinement.p[1] = refinement.p[2] = refinement.p[3] = quad_order;
@@ -21,10 +34,14 @@ namespace RefinementSelectors {
         tgt_quad_orders[i] = orig_quad_order;
   }
 
+  Selector* HOnlySelector::clone() {
+    return new HOnlySelector();
+  }
+
   POnlySelector::POnlySelector(int max_order, int order_h_inc, int order_v_inc)
   : Selector(max_order), order_h_inc(order_h_inc), order_v_inc(order_v_inc) {
-    error_if(order_h_inc >= 0, "Horizontal increase has to be greater or equal to zero.");
-    error_if(order_v_inc >= 0, "Vertical increase has to be greater or equal to zero.");
+    error_if(order_h_inc < 0, "Horizontal increase has to be greater or equal to zero.");
+    error_if(order_v_inc < 0, "Vertical increase has to be greater or equal to zero.");
   }
 
   bool POnlySelector::select_refinement(Element* element, int quad_order, Solution* rsln, ElementToRefine& refinement) {
@@ -61,4 +78,8 @@ namespace RefinementSelectors {
       tgt_quad_orders[i] = 0;
 #endif
   }
+
+  Selector* POnlySelector::clone() {
+    return new POnlySelector(max_order, order_h_inc, order_v_inc);
+  }
 }
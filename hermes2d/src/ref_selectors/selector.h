@@ -16,6 +16,8 @@
 #ifndef __H2D_REFINEMENT_SELECTOR_H
 #define __H2D_REFINEMENT_SELECTOR_H
 
+#include <vector>
+
 #ifndef _MSC_VER
 #include "../mesh/refinement_type.h"
 
@@ -70,8 +72,8 @@ namespace RefinementSelectors {
     /// Constructor
     /** \param[in] max_order A maximum order used by this selector. If it is ::H2DRS_DEFAULT_ORDER, a maximum supported order is used. */
     Selector(int max_order = H2DRS_DEFAULT_ORDER) : max_order(max_order) {};
-    /// Destructor.
-    virtual ~Selector() {};
+    /// Destructor. Deletes the copies of the selector created for threads.
+    virtual ~Selector();
 
     /// Selects a refinement.
     /** This methods has to be implemented.
@@ -89,6 +91,22 @@ namespace RefinementSelectors {
      *  \param[out] tgt_quad_orders Generated encoded orders.
      *  \param[in] suggested_quad_orders Suggested encoded orders. If not NULL, the method should copy them to the output. If NULL, the method have to calculate orders. */
     virtual void generate_shared_mesh_orders(const Element* element, const int orig_quad_order, const int refinement, int tgt_quad_orders[H2D_MAX_ELEMENT_SONS], const int* suggested_quad_orders) = 0;
+
+    /// Returns a copy of the selector used by a thread that selects refinements simultaneously with other threads.
+    /** The copy has the same settings as the selector but its own caches. It is created by the first call and
+     *  kept (including the caches) until the selector is destroyed.
+     *  \param[in] thread An index of the thread.
+     *  \return The copy of the selector, or NULL if the selector cannot be copied (see clone()). */
+    Selector* get_thread_copy(int thread);
+
+  protected:
+    /// Creates a new selector with the same settings.
+    /** Override to allow selecting refinements by several threads at once.
+     *  \return The new selector, or NULL if the selector cannot be copied (default). */
+    virtual Selector* clone() { return NULL; };
+
+  private:
+    std::vector<Selector*> thread_copies; ///< Copies of the selector used by threads, see get_thread_copy().
   };
 
   /// A selector that selects H-refinements only. \ingroup g_selectors
@@ -105,6 +123,10 @@ namespace RefinementSelectors {
     /** If a parameter suggested_quad_orders is NULL, the method uses an encoded order in orig_quad_order.
      *  For details, see Selector::generate_shared_mesh_orders. */
     virtual void generate_shared_mesh_orders(const Element* element, const int orig_quad_order, const int refinement, int tgt_quad_orders[H2D_MAX_ELEMENT_SONS], const int* suggested_quad_orders);
+
+  protected:
+    /// Creates a new selector with the same settings. For details, see Selector::clone().
+    virtual Selector* clone();
   };
 
   /// A selector that increases order (i.e., it selects P-refinements only). \ingroup g_selectors
@@ -126,6 +148,10 @@ namespace RefinementSelectors {
     /** If a parameter suggested_quad_orders is NULL, the method uses an encoded order in orig_quad_order.
      *  For details, see Selector::generate_shared_mesh_orders. */
     virtual void generate_shared_mesh_orders(const Element* element, const int orig_quad_order, const int refinement, int tgt_quad_orders[H2D_MAX_ELEMENT_SONS], const int* suggested_quad_orders);
+
+  protected:
+    /// Creates a new selector with the same settings. For details, see Selector::clone().
+    virtual Selector* clone();
   };
 }
 
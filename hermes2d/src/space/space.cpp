@@ -31,6 +31,7 @@ Space::Space(Mesh* mesh, Shapeset* shapeset, EssentialBCs* essential_bcs, Ord2 p
   this->mesh_seq = -1;
   this->seq = 0;
   this->was_assigned = false;
+  this->rcm_ordering = false;
   this->ndof = 0;
 
   if(essential_bcs != NULL)
@@ -270,19 +271,14 @@ void Space::copy_orders(const Space* space, int inc)
   _F_
   Element* e;
   resize_tables();
+  // the spaces of reference solutions are ordered as the coarse ones
+  rcm_ordering = space->rcm_ordering;
   for_all_active_elements(e, space->get_mesh())
   {
     int oo = space->get_element_order(e->id);
     if (oo < 0) error("Source space has an uninitialized order (element id = %d)", e->id);
 
-    int mo = shapeset->get_max_order();
-    int lower_limit = (get_type() == HERMES_L2_SPACE || get_type() == HERMES_HCURL_SPACE) ? 0 : 1; // L2 and Hcurl may use zero orders.
-    int ho = std::max(lower_limit, std::min(H2D_GET_H_ORDER(oo) + inc, mo));
-    int vo = std::max(lower_limit, std::min(H2D_GET_V_ORDER(oo) + inc, mo));
-    oo = e->is_triangle() ? ho : H2D_MAKE_QUAD_ORDER(ho, vo);
-
-    H2D_CHECK_ORDER(oo);
-    copy_orders_recurrent(mesh->get_element/*sic!*/(e->id), oo);
+    copy_orders_recurrent(mesh->get_element/*sic!*/(e->id), increase_order(e, oo, inc));
   }
   seq++;
 
@@ -291,6 +287,20 @@ void Space::copy_orders(const Space* space, int inc)
 }
 
 
+int Space::increase_order(Element* e, int order, int inc)
+{
+  _F_
+  int mo = shapeset->get_max_order();
+  int lower_limit = (get_type() == HERMES_L2_SPACE || get_type() == HERMES_HCURL_SPACE) ? 0 : 1; // L2 and Hcurl may use zero orders.
+  int ho = std::max(lower_limit, std::min(H2D_GET_H_ORDER(order) + inc, mo));
+  int vo = std::max(lower_limit, std::min(H2D_GET_V_ORDER(order) + inc, mo));
+  order = e->is_triangle() ? ho : H2D_MAKE_QUAD_ORDER(ho, vo);
+
+  H2D_CHECK_ORDER(order);
+  return order;
+}
+
+
 int Space::get_edge_order(Element* e, int edge)
 {
   _F_
@@ -413,6 +423,8 @@ int Space::assign_dofs(int first_dof, int stride)
   assign_vertex_dofs();
   assign_edge_dofs();
   assign_bubble_dofs();
+  if (rcm_ordering)
+    reorder_dofs_rcm();
 
   free_extra_data();
   update_essential_bc_values();
@@ -426,6 +438,133 @@ int Space::assign_dofs(int first_dof, int stride)
   return this->ndof;
 }
 
+void Space::set_rcm_ordering(bool rcm_ordering)
+{
+  _F_
+  this->rcm_ordering = rcm_ordering;
+
+  // since space changed, enumerate basis functions
+  this->assign_dofs();
+}
+
+void Space::reorder_dofs_rcm()
+{
+  _F_
+  // groups of DOFs: assigned vertex and edge nodes, bubbles of elements
+  int num_elems = mesh->get_max_element_id();
+  int* node_group = new int[nsize];
+  int* elem_group = new int[num_elems];
+  std::vector<int> group_start;
+  std::vector<int> group_size;
+  std::vector<int> group_id; // node id, or -1 - element id for bubbles
+  for (int i = 0; i < nsize; i++) node_group[i] = -1;
+  for (int i = 0; i < num_elems; i++) elem_group[i] = -1;
+
+  // the groups of the elements, stored as a compressed table
+  std::vector<int> elem_ptr(1, 0);
+  std::vector<int> elem_groups;
+  Element* e;
+  for_all_active_elements(e, mesh)
+  {
+    int nodes[8]; // vertex and edge nodes
+    int num_nodes = 0;
+    for (unsigned int i = 0; i < e->nvert; i++) {
+      nodes[num_nodes++] = e->vn[i]->id;
+      nodes[num_nodes++] = e->en[i]->id;
+    }
+    for (int i = 0; i < num_nodes; i++) {
+      NodeData* nd = ndata + nodes[i];
+      if (nd->dof < 0 || nd->n <= 0) continue;
+      if (node_group[nodes[i]] < 0) {
+        node_group[nodes[i]] = group_start.size();
+        group_start.push_back(nd->dof);
+        group_size.push_back(nd->n);
+        group_id.push_back(nodes[i]);
+      }
+      elem_groups.push_back(node_group[nodes[i]]);
+    }
+    if (edata[e->id].n > 0) {
+      elem_group[e->id] = group_start.size();
+      group_start.push_back(edata[e->id].bdof);
+      group_size.push_back(edata[e->id].n);
+      group_id.push_back(-1 - e->id);
+      elem_groups.push_back(elem_group[e->id]);
+    }
+    elem_ptr.push_back(elem_groups.size());
+  }
+  int num_groups = group_start.size();
+  int num_active = elem_ptr.size() - 1;
+
+  // the elements of the groups
+  std::vector<int> group_ptr(num_groups + 1, 0);
+  std::vector<int> group_elems(elem_groups.size());
+  for (unsigned int i = 0; i < elem_groups.size(); i++)
+    group_ptr[elem_groups[i] + 1]++;
+  for (int i = 0; i < num_groups; i++)
+    group_ptr[i + 1] += group_ptr[i];
+  std::vector<int> fill(group_ptr.begin(), group_ptr.end() - 1);
+  for (int k = 0; k < num_active; k++)
+    for (int i = elem_ptr[k]; i < elem_ptr[k + 1]; i++)
+      group_elems[fill[elem_groups[i]]++] = k;
+
+  // degrees of the groups (the number of neighbouring groups)
+  std::vector<int> mark(num_groups, -1);
+  std::vector<int> degree(num_groups, 0);
+  for (int g = 0; g < num_groups; g++)
+    for (int i = group_ptr[g]; i < group_ptr[g + 1]; i++)
+      for (int j = elem_ptr[group_elems[i]]; j < elem_ptr[group_elems[i] + 1]; j++)
+        if (elem_groups[j] != g && mark[elem_groups[j]] != g) {
+          mark[elem_groups[j]] = g;
+          degree[elem_groups[j]]++;
+        }
+
+  // Cuthill-McKee: breadth-first search from a group of minimal degree of each connected part,
+  // the neighbours are visited in the order of increasing degree
+  std::vector<int> order;
+  std::vector<bool> visited(num_groups, false);
+  std::vector<std::pair<int, int> > next;
+  order.reserve(num_groups);
+  for (int start = 0; start < num_groups; start++) {
+    if (visited[start]) continue;
+    int first = order.size();
+    int root = start;
+    for (int g = start; g < num_groups; g++)
+      if (!visited[g] && degree[g] < degree[root]) root = g;
+    visited[root] = true;
+    order.push_back(root);
+    for (unsigned int q = first; q < order.size(); q++) {
+      int g = order[q];
+      next.clear();
+      for (int i = group_ptr[g]; i < group_ptr[g + 1]; i++)
+        for (int j = elem_ptr[group_elems[i]]; j < elem_ptr[group_elems[i] + 1]; j++)
+          if (!visited[elem_groups[j]]) {
+            visited[elem_groups[j]] = true;
+            next.push_back(std::pair<int, int>(degree[elem_groups[j]], elem_groups[j]));
+          }
+      std::sort(next.begin(), next.end());
+      for (unsigned int i = 0; i < next.size(); i++)
+        order.push_back(next[i].second);
+    }
+    // the root may belong to another connected part, start is processed again then
+    if (!visited[start]) start--;
+  }
+
+  // renumber in the reverse order
+  int dof = first_dof;
+  for (int i = num_groups - 1; i >= 0; i--) {
+    int g = order[i];
+    if (group_id[g] >= 0)
+      ndata[group_id[g]].dof = dof;
+    else
+      edata[-1 - group_id[g]].bdof = dof;
+    dof += group_size[g] * stride;
+  }
+  assert(dof == next_dof);
+
+  delete [] node_group;
+  delete [] elem_group;
+}
+
 void Space::reset_dof_assignment()
 {
   _F_
@@ -685,6 +824,122 @@ Space* Space::construct_refined_space(Space* coarse, int order_increase)
   return ref_space;
 }
 
+int Space::get_refinement(Element* e)
+{
+  _F_
+  if (e->is_triangle()) {
+    if (e->sons[3] != NULL) return 0;
+    if (e->sons[0] != NULL && e->sons[0]->is_quad()) return 3;
+    return -1;
+  }
+  if (e->sons[0] != NULL && e->sons[2] != NULL) return 0;
+  if (e->sons[0] != NULL && e->sons[0]->is_quad()) return 1;
+  if (e->sons[2] != NULL && e->sons[2]->is_quad()) return 2;
+  return -1; // quad split to triangles
+}
+
+bool Space::update_refined_element(const Space* coarse, Element* e, Element* re, int order_increase)
+{
+  _F_
+  // active elements of the coarse mesh are refined once as by Mesh::refine_all_elements()
+  int refinement = e->active ? 0 : get_refinement(e);
+  if (refinement < 0) return false;
+
+  if (!re->active && get_refinement(re) != refinement)
+    mesh->unrefine_element_id(re->id);
+  if (re->active)
+    mesh->refine_element_id(re->id, refinement);
+
+  if (e->active) {
+    for (int i = 0; i < 4; i++)
+      if (re->sons[i] != NULL && !re->sons[i]->active)
+        mesh->unrefine_element_id(re->sons[i]->id);
+
+    int oo = coarse->get_element_order(e->id);
+    if (oo < 0) error("Source space has an uninitialized order (element id = %d)", e->id);
+    resize_tables();
+    copy_orders_recurrent(re, increase_order(e, oo, order_increase));
+    return true;
+  }
+
+  for (int i = 0; i < 4; i++)
+    if (e->sons[i] != NULL && !update_refined_element(coarse, e->sons[i], re->sons[i], order_increase))
+      return false;
+  return true;
+}
+
+void Space::update_refined_mesh(const Space* coarse, int order_increase)
+{
+  _F_
+  // both meshes share the base elements
+  bool updated = true;
+  Element* e;
+  for_all_base_elements(e, coarse->get_mesh())
+    if (!update_refined_element(coarse, e, mesh->get_element(e->id), order_increase)) {
+      updated = false;
+      break;
+    }
+
+  if (!updated) {
+    // the refinement cannot be repeated, refine a new copy of the coarse mesh
+    mesh->copy(coarse->get_mesh());
+    mesh->refine_all_elements();
+    resize_tables();
+    for_all_active_elements(e, coarse->get_mesh()) {
+      int oo = coarse->get_element_order(e->id);
+      if (oo < 0) error("Source space has an uninitialized order (element id = %d)", e->id);
+      copy_orders_recurrent(mesh->get_element(e->id), increase_order(e, oo, order_increase));
+    }
+  }
+  seq++;
+}
+
+void Space::update_refined_spaces(Hermes::vector<Space *> coarse, Hermes::vector<Space *> ref, int order_increase)
+{
+  _F_
+  bool same_meshes = true;
+  unsigned int same_seq = coarse[0]->get_mesh()->get_seq();
+  for (unsigned int i = 0; i < coarse.size(); i++) {
+    if(coarse[i]->get_mesh()->get_seq() != same_seq)
+      same_meshes = false;
+    ref[i]->update_refined_mesh(coarse[i], order_increase);
+  }
+
+  if(same_meshes)
+    for (unsigned int i = 0; i < coarse.size(); i++)
+      ref[i]->get_mesh()->set_seq(same_seq);
+
+  // since spaces changed, enumerate basis functions
+  for (unsigned int i = 0; i < coarse.size(); i++)
+    ref[i]->assign_dofs();
+}
+
+// Light version for a single space.
+void Space::update_refined_space(Space* coarse, Space* ref, int order_increase)
+{
+  _F_
+  ref->update_refined_mesh(coarse, order_increase);
+  ref->assign_dofs();
+}
+
+Element* Space::get_ref_element(Mesh* ref_mesh, Element* e)
+{
+  _F_
+  // the meshes share the base elements
+  if (e->parent == NULL)
+    return ref_mesh->get_element(e->id);
+
+  Element* re = get_ref_element(ref_mesh, e->parent);
+  if (re->active)
+    error("Element #%d of the coarse mesh is not refined in the reference mesh.", e->parent->id);
+  for (int i = 0; i < 4; i++)
+    if (e->parent->sons[i] == e)
+      return re->sons[i];
+
+  error("Element #%d is not a son of its parent.", e->id);
+  return NULL;
+}
+
 // updating time-dependent essential BC
 void Space::update_essential_bc_values(Hermes::vector<Space*> spaces, double time) {
   int n = spaces.size();
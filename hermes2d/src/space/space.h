@@ -132,6 +132,13 @@ public:
   /// \return The number of basis functions contained in the space.
   virtual int assign_dofs(int first_dof = 0, int stride = 1);
 
+  /// \brief Enables the reverse Cuthill-McKee ordering of the DOFs (disabled by default).
+  /// \details The DOFs of a vertex, of an edge and the bubble DOFs of an element are kept together,
+  /// the groups are renumbered so that the groups of neighbouring elements get close numbers.
+  /// This reduces the bandwidth of the matrix. Calls assign_dofs().
+  void set_rcm_ordering(bool rcm_ordering);
+  bool get_rcm_ordering() const { return rcm_ordering; }
+
   /// \brief Returns the number of basis functions contained in the space.
   int get_num_dofs() { return ndof; }
   /// \brief Returns the DOF number of the last basis function.
@@ -167,6 +174,9 @@ public:
   /// Obtains an edge assembly list (contains shape functions that are nonzero on the specified edge).
   void get_boundary_assembly_list(Element* e, int surf_num, AsmList* al);
 
+  /// Obtains an assembly list of the bubble functions of the given element.
+  virtual void get_bubble_assembly_list(Element* e, AsmList* al);
+
   /// Updates essential BC values. Typically used for time-dependent
   /// essnetial boundary conditions.
   void update_essential_bc_values();
@@ -196,6 +206,7 @@ protected:
   int stride;
   int seq, mesh_seq;
   bool was_assigned;
+  bool rcm_ordering;
 
   struct BaseComponent
   {
@@ -254,6 +265,15 @@ protected: //debugging support
 
   void H2D_CHECK_ORDER(int order);
   void copy_orders_recurrent(Element* e, int order);
+  int increase_order(Element* e, int order, int inc);
+
+  /// Refinement of an element (as in Mesh::refine_element_id()), -1 if not known.
+  static int get_refinement(Element* e);
+  /// Refines (or unrefines) the element re of the reference mesh and its sons to be the element e
+  /// of the coarse mesh refined once more. Returns false if a refinement of e cannot be repeated.
+  bool update_refined_element(const Space* coarse, Element* e, Element* re, int order_increase);
+  /// Updates the reference mesh and the orders of this space, see update_refined_spaces().
+  void update_refined_mesh(const Space* coarse, int order_increase);
 
   virtual void reset_dof_assignment(); ///< Resets assignment of DOF to an unassigned state.
   virtual void assign_vertex_dofs() = 0;
@@ -262,7 +282,6 @@ protected: //debugging support
 
   virtual void get_vertex_assembly_list(Element* e, int iv, AsmList* al) = 0;
   virtual void get_boundary_assembly_list_internal(Element* e, int surf_num, AsmList* al) = 0;
-  virtual void get_bubble_assembly_list(Element* e, AsmList* al);
 
   double** proj_mat;
   double*  chol_p;
@@ -286,6 +305,9 @@ protected: //debugging support
 
   void propagate_zero_orders(Element* e);
 
+  /// Renumbers the assigned DOFs in the reverse Cuthill-McKee order, see set_rcm_ordering().
+  void reorder_dofs_rcm();
+
 public:
   /// Internal. Used by DiscreteProblem to detect changes in the space.
   int get_seq() const { return seq; }
@@ -299,6 +321,15 @@ public:
   static Hermes::vector<Space *>* construct_refined_spaces(Hermes::vector<Space *> coarse, int order_increase = 1);
   static Space* construct_refined_space(Space* coarse, int order_increase = 1);
 
+  /// Updates the spaces created by construct_refined_spaces() after the coarse spaces were adapted.
+  /// Only the elements whose refinement changed are refined or unrefined in the reference meshes,
+  /// the ids of the elements of the reference meshes do not correspond to the coarse meshes then.
+  static void update_refined_spaces(Hermes::vector<Space *> coarse, Hermes::vector<Space *> ref, int order_increase = 1);
+  static void update_refined_space(Space* coarse, Space* ref, int order_increase = 1);
+  /// Returns the element of the reference mesh matching the element e of the coarse mesh, i.e. the
+  /// element with the same path of sons from the common base element (the ids may differ).
+  static Element* get_ref_element(Mesh* ref_mesh, Element* e);
+
   // updating time-dependent essential (Dirichlet) boundary conditions
   static void update_essential_bc_values(Hermes::vector<Space*> spaces, double time);  // multiple spaces
   static void update_essential_bc_values(Space *s, double time);    // one space
@@ -21,6 +21,11 @@
 #include "third_party_codes/trilinos-teuchos/Teuchos_stacktrace.hpp"
 #include <signal.h>
 #include <stdlib.h>
+#include <pthread.h>
+
+// the call stack is not synchronized, only the thread that created it (the main one)
+// records into it; calls from worker threads (e.g. threaded assembling) are ignored
+static pthread_t callstack_thread = pthread_self();
 
 // global instance of the call stack object
 static CallStack callstack;
@@ -32,6 +37,9 @@ CallStackObj::CallStackObj(int ln, const char *func, const char *file) {
 	this->func = func;
 	this->file = file;
 
+	if (!pthread_equal(pthread_self(), callstack_thread))
+		return;
+
 	// add this object to the call stack
 	if (callstack.size < callstack.max_size) {
 		callstack.stack[callstack.size] = this;
@@ -40,6 +48,9 @@ CallStackObj::CallStackObj(int ln, const char *func, const char *file) {
 }
 
 CallStackObj::~CallStackObj() {
+	if (!pthread_equal(pthread_self(), callstack_thread))
+		return;
+
 	// remove the object only if it is on the top of the call stack
 	if (callstack.size > 0 && callstack.stack[callstack.size - 1] == this) {
 		callstack.size--;
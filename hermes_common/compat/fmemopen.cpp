@@ -10,18 +10,24 @@
 FILE *fmemopen (void *buf, size_t size, const char *opentype)
 {
   FILE *f;
-  assert(strcmp(opentype, "r") == 0);
+  // only reading is supported, the temporary file is always binary (the buffer is copied as it is)
+  assert(strcmp(opentype, "r") == 0 || strcmp(opentype, "rb") == 0);
 #ifdef WIN32
+  // "D" deletes the file when it is closed
   char* tmp_fname = _tempnam("%TMP%", "fmemopen");
-  f = fopen(tmp_fname, "wt");
-  fwrite(buf, 1, size, f);
-  fclose(f);
-  f = fopen(tmp_fname, "rt");
+  f = fopen(tmp_fname, "w+bD");
+  free(tmp_fname);
 #else
   f = tmpfile();
-  fwrite(buf, 1, size, f);
-  rewind(f);
 #endif
+  if (f == NULL)
+    return NULL;
+  if (fwrite(buf, 1, size, f) != size)
+  {
+    fclose(f);
+    return NULL;
+  }
+  rewind(f);
   return f;
 }
 
@@ -179,6 +179,16 @@ void SparseMatrix::pre_add_ij(unsigned int row, unsigned int col)
   pages[col]->idx[pages[col]->count++] = row;
 }
 
+void SparseMatrix::alloc_structure(unsigned int n, int *ptr, int *idx)
+{
+  _F_
+  prealloc(n);
+  for (unsigned int col = 0; col < n; col++)
+    for (int i = ptr[col]; i < ptr[col + 1]; i++)
+      pre_add_ij(idx[i], col);
+  alloc();
+}
+
 int SparseMatrix::sort_and_store_indices(Page *page, int *buffer, int *max)
 {
   _F_
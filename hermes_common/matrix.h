@@ -310,6 +310,14 @@ public:
   /// @param[in] col  - column index
   virtual void pre_add_ij(unsigned int row, unsigned int col);
 
+  /// allocate the matrix with a complete sparse structure, replaces prealloc(),
+  /// pre_add_ij() and alloc()
+  ///
+  /// @param[in] n    - number of unknowns
+  /// @param[in] ptr  - n + 1 offsets of the columns in idx
+  /// @param[in] idx  - row indexes of the columns, sorted and without duplicities
+  virtual void alloc_structure(unsigned int n, int *ptr, int *idx);
+
   virtual void finish() { }
 
   virtual unsigned int get_size() { return size; }
@@ -319,6 +327,29 @@ public:
     error("add_sparse_matrix() undefined.");
   };
 
+  /// Find the positions of a block of entries in the storage of the matrix,
+  /// so that the block can be later added by add_to_positions() without searching.
+  /// The positions are valid until the sparse structure of the matrix changes.
+  ///
+  /// @param[in] m      - number of rows of the block
+  /// @param[in] n      - number of columns of the block
+  /// @param[in] rows   - array with row indexes
+  /// @param[in] cols   - array with column indexes
+  /// @param[out] pos   - m * n positions (row-wise), negative for skipped entries
+  /// @return - false if the matrix does not support adding to positions
+  virtual bool find_positions(unsigned int m, unsigned int n, int *rows, int *cols, int *pos) { return false; }
+
+  /// Add a block of values to the positions found by find_positions().
+  ///
+  /// @param[in] m      - number of rows of the block
+  /// @param[in] n      - number of columns of the block
+  /// @param[in] mat    - block of values
+  /// @param[in] pos    - positions returned by find_positions()
+  virtual void add_to_positions(unsigned int m, unsigned int n, scalar **mat, int *pos)
+  {
+    error("add_to_positions() undefined.");
+  }
+
   /// Return the number of entries in a specified row
   ///
   /// @param[in] row - index of the row
@@ -124,6 +124,26 @@ void CSCMatrix::alloc() {
   memset(Ax, 0, sizeof(scalar) * nnz);
 }
 
+void CSCMatrix::alloc_structure(unsigned int n, int *ptr, int *idx) {
+  _F_
+  this->size = n;
+  delete [] pages;
+  pages = NULL;
+
+  Ap = new int [size + 1];
+  MEM_CHECK(Ap);
+  memcpy(Ap, ptr, sizeof(int) * (size + 1));
+
+  nnz = Ap[size];
+  Ai = new int [nnz];
+  MEM_CHECK(Ai);
+  memcpy(Ai, idx, sizeof(int) * nnz);
+
+  Ax = new scalar [nnz];
+  MEM_CHECK(Ax);
+  memset(Ax, 0, sizeof(scalar) * nnz);
+}
+
 void CSCMatrix::free() {
   _F_
   nnz = 0;
@@ -255,6 +275,34 @@ void CSCMatrix::add(unsigned int m, unsigned int n, scalar **mat, int *rows, int
         add(rows[i], cols[j], mat[i][j]);
 }
 
+bool CSCMatrix::find_positions(unsigned int m, unsigned int n, int *rows, int *cols, int *pos) {
+  _F_
+  for (unsigned int i = 0; i < m; i++)       // rows
+    for (unsigned int j = 0; j < n; j++) {   // cols
+      int *p = pos + i * n + j;
+      if (rows[i] < 0 || cols[j] < 0)        // Dir. dofs.
+        *p = -1;
+      else {
+        int k = find_position(Ai + Ap[cols[j]], Ap[cols[j] + 1] - Ap[cols[j]], rows[i]);
+        // Missing entries are reported when a nonzero value is added there.
+        *p = (k < 0) ? -2 : Ap[cols[j]] + k;
+      }
+    }
+  return true;
+}
+
+void CSCMatrix::add_to_positions(unsigned int m, unsigned int n, scalar **mat, int *pos) {
+  _F_
+  for (unsigned int i = 0; i < m; i++)       // rows
+    for (unsigned int j = 0; j < n; j++) {   // cols
+      int p = pos[i * n + j];
+      if (p >= 0)
+        Ax[p] += mat[i][j];
+      else if (p == -2 && mat[i][j] != 0.0)
+        error("Sparse matrix entry not found");
+    }
+}
+
 /// dumping matrix and right-hand side
 ///
 bool CSCMatrix::dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt) {
@@ -392,7 +440,7 @@ CSCMatrix* CSCMatrix::duplicate()
 {
   _F_
   CSCMatrix* new_matrix = new CSCMatrix();
-  create(this->get_size(), this->get_nnz(), this->get_Ap(),  this->get_Ai(),  this->get_Ax());
+  new_matrix->create(this->get_size(), this->get_nnz(), this->get_Ap(),  this->get_Ai(),  this->get_Ax());
   return new_matrix;
 }
 
@@ -509,6 +557,7 @@ bool UMFPackVector::dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt
   #define umfpack_free_symbolic                         umfpack_di_free_symbolic
   #define umfpack_free_numeric                          umfpack_di_free_numeric
   #define umfpack_defaults                              umfpack_di_defaults
+  #define umfpack_get_lunz(L, U, R, C, D, N)            umfpack_di_get_lunz(L, U, R, C, D, N)
 #else
   // macros for calling complex UMFPACK in packed-complex mode
   #define umfpack_symbolic(m, n, Ap, Ai, Ax, S, C, I)   umfpack_zi_symbolic(m, n, Ap, Ai, (double *) (Ax), NULL, S, C, I)
@@ -517,11 +566,12 @@ bool UMFPackVector::dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt
   #define umfpack_free_symbolic                         umfpack_di_free_symbolic
   #define umfpack_free_numeric                          umfpack_zi_free_numeric
   #define umfpack_defaults                              umfpack_zi_defaults
+  #define umfpack_get_lunz(L, U, R, C, D, N)            umfpack_zi_get_lunz(L, U, R, C, D, N)
 #endif
 
 
 UMFPackLinearSolver::UMFPackLinearSolver(UMFPackMatrix *m, UMFPackVector *rhs)
-  : LinearSolver(HERMES_FACTORIZE_FROM_SCRATCH), m(m), rhs(rhs), symbolic(NULL), numeric(NULL)
+  : LinearSolver(HERMES_FACTORIZE_FROM_SCRATCH), m(m), rhs(rhs), symbolic(NULL), numeric(NULL), lu_nnz(0)
 {
   _F_
 #ifdef WITH_UMFPACK
@@ -633,6 +683,16 @@ bool UMFPackLinearSolver::setup_factorization()
         return false;
       }
       if (numeric == NULL) EXIT("umfpack_di_numeric error: numeric == NULL");
+
+      // Fill-in of the factorization (L has a unit diagonal).
+      int lnz, unz, n_row, n_col, nz_udiag;
+      status = umfpack_get_lunz(&lnz, &unz, &n_row, &n_col, &nz_udiag, numeric);
+      if (status != UMFPACK_OK) {
+        check_status("umfpack_di_get_lunz", status);
+        return false;
+      }
+      lu_nnz = lnz + unz - n_row;
+      info("LU factors: %d nonzeros, %g times the matrix.", lu_nnz, (double) lu_nnz / m->nnz);
   }
   
   return true;
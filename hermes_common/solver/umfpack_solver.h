@@ -33,6 +33,7 @@ public:
   virtual ~CSCMatrix();
 
   virtual void alloc();
+  virtual void alloc_structure(unsigned int n, int *ptr, int *idx);
   virtual void free();
   virtual scalar get(unsigned int m, unsigned int n);
   virtual void zero();
@@ -45,6 +46,8 @@ public:
   // TODO: implement this for other matrix types.
   virtual void add_as_block(unsigned int i, unsigned int j, CSCMatrix* mat);
   virtual void add(unsigned int m, unsigned int n, scalar **mat, int *rows, int *cols);
+  virtual bool find_positions(unsigned int m, unsigned int n, int *rows, int *cols, int *pos);
+  virtual void add_to_positions(unsigned int m, unsigned int n, scalar **mat, int *pos);
   virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE);
   virtual unsigned int get_matrix_size() const;
   unsigned int get_nnz() {return this->nnz;}
@@ -127,6 +130,9 @@ public:
   virtual ~UMFPackLinearSolver();
 
   virtual bool solve();
+
+  /// Number of nonzeros of the L and U factors of the last factorization.
+  int get_lu_nnz() const { return lu_nnz; }
     
 protected:
   UMFPackMatrix *m;
@@ -135,6 +141,7 @@ protected:
   // Reusable factorization information (A denotes matrix represented by the pointer 'm').
   void *symbolic; // Reordering of matrix A to reduce fill-in during factorization.
   void *numeric;  // LU factorization of matrix A.
+  int lu_nnz;     // Nonzeros of the factors (without the unit diagonal of L).
   
   bool setup_factorization();
   void free_factorization_data();
@@ -417,10 +417,12 @@ void ChartDialog::plotGeometry()
     QList<Point> points = chartLine.getPoints();
 
     // calculate values
+    QList<LocalPointValue *> localPointValues = Util::scene()->problemInfo()->hermes()->localPointValues(points);
+
     QStringList row;
     for (int i = 0; i < points.length(); i++)
     {
-        LocalPointValue *localPointValue = Util::scene()->problemInfo()->hermes()->localPointValue(points.at(i));
+        LocalPointValue *localPointValue = localPointValues.at(i);
 
         // x value
         if (radAxisLength->isChecked())
@@ -490,9 +492,6 @@ void ChartDialog::plotTime()
     PhysicFieldVariableComp physicFieldVariableComp = (PhysicFieldVariableComp) cmbFieldVariableComp->itemData(cmbFieldVariableComp->currentIndex()).toInt();
     if (physicFieldVariableComp == PhysicFieldVariableComp_Undefined) return;
 
-    // store timestep
-    int timeStep = Util::scene()->sceneSolution()->timeStep();
-
     int count = Util::scene()->sceneSolution()->timeStepCount();
     double *xval = new double[count];
     double *yval = new double[count];
@@ -516,18 +515,18 @@ void ChartDialog::plotTime()
     text.setText(tr("Time (s)"));
     chart->setAxisTitle(QwtPlot::xBottom, text);
 
-    // calculate values
+    // calculate values in all time steps
+    QList<Point> points;
+    points.append(Point(txtPointX->value().number, txtPointY->value().number));
+    QList<QList<LocalPointValue *> > localPointValues = Util::scene()->sceneSolution()->localPointValuesTimeSeries(points);
+
     QStringList row;
-    for (int i = 0; i<Util::scene()->sceneSolution()->timeStepCount(); i++)
+    for (int i = 0; i<localPointValues.count(); i++)
     {
-        // change time level
-        Util::scene()->sceneSolution()->setTimeStep(i, false);
-
-        Point point(txtPointX->value().number, txtPointY->value().number);
-        LocalPointValue *localPointValue = Util::scene()->problemInfo()->hermes()->localPointValue(point);
+        LocalPointValue *localPointValue = localPointValues.at(i).first();
 
         // x value
-        xval[i] = Util::scene()->sceneSolution()->time();
+        xval[i] = Util::scene()->sceneSolution()->time(i);
 
         // y value
         yval[i] = localPointValue->variableValue(physicFieldVariable, physicFieldVariableComp);
@@ -546,9 +545,6 @@ void ChartDialog::plotTime()
 
     delete[] xval;
     delete[] yval;
-
-    // restore previous timestep
-    Util::scene()->sceneSolution()->setTimeStep(timeStep);
 }
 
 void ChartDialog::doPlot()
@@ -62,9 +62,15 @@ void Config::loadWorkspace()
     enabledProgressLog = settings.value("General/EnabledProgressLog", true).toBool();
     lineEditValueShowResult = settings.value("General/LineEditValueShowResult", false).toBool();
     if (showExperimentalFeatures)
+    {
         saveProblemWithSolution = settings.value("Solver/SaveProblemWithSolution", false).toBool();
+        compressSolution = settings.value("Solver/CompressSolution", false).toBool();
+    }
     else
+    {
         saveProblemWithSolution = false;
+        compressSolution = false;
+    }
 
     // zoom
     zoomToMouse = settings.value("Geometry/ZoomToMouse", true).toBool();
@@ -73,6 +79,13 @@ void Config::loadWorkspace()
     deleteTriangleMeshFiles = settings.value("Solver/DeleteTriangleMeshFiles", true).toBool();
     deleteHermes2DMeshFile = settings.value("Solver/DeleteHermes2DMeshFile", true).toBool();
 
+    // assembling
+    numberOfThreads = settings.value("Solver/NumberOfThreads", QThread::idealThreadCount()).toInt();
+    if (numberOfThreads < 1) numberOfThreads = 1;
+
+    // save matrix and rhs (diagnostics)
+    saveMatrixRHS = settings.value("Solver/SaveMatrixAndRHS", false).toBool();
+
     // colors
     colorBackground = settings.value("SceneViewSettings/ColorBackground", COLORBACKGROUND).value<QColor>();
     colorGrid = settings.value("SceneViewSettings/ColorGrid", COLORGRID).value<QColor>();
@@ -235,9 +248,15 @@ void Config::saveWorkspace()
     settings.setValue("General/EnabledProgressLog", enabledProgressLog);
     settings.setValue("General/LineEditValueShowResult", lineEditValueShowResult);
     if (showExperimentalFeatures)
+    {
         settings.setValue("General/SaveProblemWithSolution", saveProblemWithSolution);
+        settings.setValue("Solver/CompressSolution", compressSolution);
+    }
     else
+    {
         saveProblemWithSolution = false;
+        compressSolution = false;
+    }
 
     // zoom
     settings.setValue("General/ZoomToMouse", zoomToMouse);
@@ -246,6 +265,12 @@ void Config::saveWorkspace()
     settings.setValue("Solver/DeleteTriangleMeshFiles", deleteTriangleMeshFiles);
     settings.setValue("Solver/DeleteHermes2DMeshFile", deleteHermes2DMeshFile);
 
+    // assembling
+    settings.setValue("Solver/NumberOfThreads", numberOfThreads);
+
+    // save matrix and rhs (diagnostics)
+    settings.setValue("Solver/SaveMatrixAndRHS", saveMatrixRHS);
+
     // colors
     settings.setValue("SceneViewSettings/ColorBackground", colorBackground);
     settings.setValue("SceneViewSettings/ColorGrid", colorGrid);
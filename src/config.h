@@ -41,6 +41,7 @@ public:
     bool enabledProgressLog;
     bool lineEditValueShowResult;
     bool saveProblemWithSolution;
+    bool compressSolution;
 
     QString collaborationServerURL;
 
@@ -61,6 +62,12 @@ public:
     bool deleteTriangleMeshFiles;
     bool deleteHermes2DMeshFile;
 
+    // assembling
+    int numberOfThreads;
+
+    // save matrix and rhs (diagnostics)
+    bool saveMatrixRHS;
+
     // grid
     bool showGrid;
     double gridStep;
@@ -79,9 +79,18 @@ void ConfigDialog::load()
     chkDeleteTriangleMeshFiles->setChecked(Util::config()->deleteTriangleMeshFiles);
     chkDeleteHermes2DMeshFile->setChecked(Util::config()->deleteHermes2DMeshFile);
 
+    // assembling
+    txtNumberOfThreads->setValue(Util::config()->numberOfThreads);
+
+    // save matrix and rhs (diagnostics)
+    chkSaveMatrixRHS->setChecked(Util::config()->saveMatrixRHS);
+
     // save problem with solution
     if (Util::config()->showExperimentalFeatures)
+    {
         chkSaveWithSolution->setChecked(Util::config()->saveProblemWithSolution);
+        chkCompressSolution->setChecked(Util::config()->compressSolution);
+    }
 
     // colors
     colorBackground->setColor(Util::config()->colorBackground);
@@ -166,9 +175,18 @@ void ConfigDialog::save()
     Util::config()->deleteTriangleMeshFiles = chkDeleteTriangleMeshFiles->isChecked();
     Util::config()->deleteHermes2DMeshFile = chkDeleteHermes2DMeshFile->isChecked();
 
+    // assembling
+    Util::config()->numberOfThreads = txtNumberOfThreads->value();
+
+    // save matrix and rhs (diagnostics)
+    Util::config()->saveMatrixRHS = chkSaveMatrixRHS->isChecked();
+
     // save problem with solution
     if (Util::config()->showExperimentalFeatures)
+    {
         Util::config()->saveProblemWithSolution = chkSaveWithSolution->isChecked();
+        Util::config()->compressSolution = chkCompressSolution->isChecked();
+    }
 
     // color
     Util::config()->colorBackground = colorBackground->color();
@@ -369,15 +387,32 @@ QWidget *ConfigDialog::createSolverWidget()
     chkDeleteTriangleMeshFiles = new QCheckBox(tr("Delete files with initial mesh (Triangle)"));
     chkDeleteHermes2DMeshFile = new QCheckBox(tr("Delete files with solution mesh (Hermes2D)"));
     if (Util::config()->showExperimentalFeatures)
+    {
         chkSaveWithSolution = new QCheckBox(tr("Save problem with solution"));
+        chkCompressSolution = new QCheckBox(tr("Compress saved solution"));
+    }
     chkShowConvergenceChart = new QCheckBox(tr("Show convergence chart after solving"));
+    chkSaveMatrixRHS = new QCheckBox(tr("Save matrix and RHS (binary file, diagnostics)"));
 
     QVBoxLayout *layoutSolver = new QVBoxLayout();
     layoutSolver->addWidget(chkDeleteTriangleMeshFiles);
     layoutSolver->addWidget(chkDeleteHermes2DMeshFile);
     if (Util::config()->showExperimentalFeatures)
+    {
         layoutSolver->addWidget(chkSaveWithSolution);
+        layoutSolver->addWidget(chkCompressSolution);
+    }
     layoutSolver->addWidget(chkShowConvergenceChart);
+    layoutSolver->addWidget(chkSaveMatrixRHS);
+
+    txtNumberOfThreads = new QSpinBox(this);
+    txtNumberOfThreads->setMinimum(1);
+    txtNumberOfThreads->setMaximum(64);
+
+    QGridLayout *layoutThreads = new QGridLayout();
+    layoutThreads->addWidget(new QLabel(tr("Number of assembling threads:")), 0, 0);
+    layoutThreads->addWidget(txtNumberOfThreads, 0, 1);
+    layoutSolver->addLayout(layoutThreads);
 
     QGroupBox *grpSolver = new QGroupBox(tr("Solver"));
     grpSolver->setLayout(layoutSolver);
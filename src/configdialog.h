@@ -63,6 +63,12 @@ private:
     QCheckBox *chkDeleteTriangleMeshFiles;
     QCheckBox *chkDeleteHermes2DMeshFile;
 
+    // assembling
+    QSpinBox *txtNumberOfThreads;
+
+    // save matrix and rhs (diagnostics)
+    QCheckBox *chkSaveMatrixRHS;
+
     // clear application log
     QPushButton *cmdClearApplicationLog;
 
@@ -74,6 +80,7 @@ private:
 
     // save with solution
     QCheckBox *chkSaveWithSolution;
+    QCheckBox *chkCompressSolution;
 
     // check version
     QCheckBox *chkCheckVersion;
@@ -165,11 +165,11 @@ public:
             if (boundary && Util::scene()->edges[i]->boundary != Util::scene()->boundaries[0])
             {
                 if (boundary->type == PhysicFieldBC_Acoustic_NormalAcceleration)
-                    if (fabs(boundary->value_real.number) > EPS_ZERO)
-                        add_vector_form_surf(new WeakFormsH1::SurfaceVectorForms::DefaultVectorFormSurf(0,
-                                                                                                        QString::number(i + 1).toStdString(),
-                                                                                                        boundary->value_real.number,
-                                                                                                        convertProblemType(Util::scene()->problemInfo()->problemType)));
+                    if ((fabs(boundary->value_real.number) > EPS_ZERO) || boundary->value_real.isTimeDep())
+                        add_vector_form_surf(new CustomVectorFormSurfValue(0,
+                                                                           QString::number(i + 1).toStdString(),
+                                                                           &boundary->value_real,
+                                                                           convertProblemType(Util::scene()->problemInfo()->problemType)));
 
                 if (boundary->type == PhysicFieldBC_Acoustic_Impedance)
                 {
@@ -436,6 +436,21 @@ LocalPointValue *HermesAcoustic::localPointValue(const Point &point)
     return new LocalPointValueAcoustic(point);
 }
 
+LocalPointValue *HermesAcoustic::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueAcoustic(point, solutionValues);
+}
+
+QList<Solution *> HermesAcoustic::localPointValueSolutions(int timeStep)
+{
+    QList<Solution *> solutions = HermesField::localPointValueSolutions(timeStep);
+
+    if (Util::scene()->problemInfo()->analysisType == AnalysisType_Harmonic)
+        solutions.append(Util::scene()->sceneSolution()->sln(1, timeStep));
+
+    return solutions;
+}
+
 QStringList HermesAcoustic::localPointValueHeader()
 {
     QStringList headers;
@@ -811,6 +826,16 @@ void HermesAcoustic::updateTimeFunctions(double time)
 // ****************************************************************************************************************
 
 LocalPointValueAcoustic::LocalPointValueAcoustic(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueAcoustic::LocalPointValueAcoustic(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueAcoustic::calculate()
 {
     density = 0;
     speed = 0;
@@ -836,10 +861,8 @@ LocalPointValueAcoustic::LocalPointValueAcoustic(const Point &point) : LocalPoin
 
             if (Util::scene()->problemInfo()->analysisType == AnalysisType_Harmonic)
             {
-                Solution *sln2 = Util::scene()->sceneSolution()->sln(1);
-
                 // value imag
-                PointValue valueImag = pointValue(sln2, point);
+                PointValue valueImag = solutionValue(1);
                 double frequency = Util::scene()->problemInfo()->frequency;
 
                 Point derReal = valueReal.derivative;
@@ -42,7 +42,9 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
+    QList<Solution *> localPointValueSolutions(int timeStep = -1);
 
     SurfaceIntegralValue *surfaceIntegralValue();
     QStringList surfaceIntegralValueHeader();
@@ -93,6 +95,9 @@ public:
 
 class LocalPointValueAcoustic : public LocalPointValue
 {
+protected:
+    void calculate();
+
 public:
     double density;
     double speed;
@@ -105,6 +110,7 @@ public:
     Point localAccelaration;
 
     LocalPointValueAcoustic(const Point &point);
+    LocalPointValueAcoustic(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
@@ -108,6 +108,11 @@ LocalPointValue *HermesCurrent::localPointValue(const Point &point)
     return new LocalPointValueCurrent(point);
 }
 
+LocalPointValue *HermesCurrent::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueCurrent(point, solutionValues);
+}
+
 QStringList HermesCurrent::localPointValueHeader()
 {
     QStringList headers;
@@ -303,11 +308,11 @@ ViewScalarFilter *HermesCurrent::viewScalarFilter(PhysicFieldVariable physicFiel
                                        physicFieldVariableComp);
 }
 
-Point3 HermesCurrent::particleForce(Point3 point, Point3 velocity)
+Point3 HermesCurrent::particleForce(Point3 point, Point3 velocity, const QList<PointValue> &solutionValues)
 {
-    LocalPointValueCurrent *pointValue = dynamic_cast<LocalPointValueCurrent *>(localPointValue(Point(point.x, point.y)));
+    LocalPointValueCurrent pointValue(Point(point.x, point.y), solutionValues);
 
-    return Point3(pointValue->E.x, pointValue->E.y, 0);
+    return Point3(pointValue.E.x, pointValue.E.y, 0);
 }
 
 double HermesCurrent::particleMaterial(Point point)
@@ -360,6 +365,21 @@ QList<SolutionArray *> HermesCurrent::solve(ProgressItemSolve *progressItemSolve
 // ****************************************************************************************************************
 
 LocalPointValueCurrent::LocalPointValueCurrent(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueCurrent::LocalPointValueCurrent(const Point &point, const PointValue &pointValue) : LocalPointValue(point, pointValue)
+{
+    calculate();
+}
+
+LocalPointValueCurrent::LocalPointValueCurrent(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueCurrent::calculate()
 {
     conductivity = 0;
 
@@ -42,6 +42,7 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
 
     SurfaceIntegralValue *surfaceIntegralValue();
@@ -93,12 +94,15 @@ public:
 
     ViewScalarFilter *viewScalarFilter(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
 
-    Point3 particleForce(Point3 point, Point3 velocity = Point3());
+    Point3 particleForce(Point3 point, Point3 velocity, const QList<PointValue> &solutionValues);
     double particleMaterial(Point point);
 };
 
 class LocalPointValueCurrent : public LocalPointValue
 {
+protected:
+    void calculate();
+
 public:
     double conductivity;
     double losses;
@@ -107,6 +111,8 @@ public:
     Point E;
 
     LocalPointValueCurrent(const Point &point);
+    LocalPointValueCurrent(const Point &point, const PointValue &pointValue);
+    LocalPointValueCurrent(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
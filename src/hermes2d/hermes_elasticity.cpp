@@ -304,6 +304,21 @@ LocalPointValue *HermesElasticity::localPointValue(const Point &point)
     return new LocalPointValueElasticity(point);
 }
 
+LocalPointValue *HermesElasticity::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueElasticity(point, solutionValues);
+}
+
+QList<Solution *> HermesElasticity::localPointValueSolutions(int timeStep)
+{
+    QList<Solution *> solutions = HermesField::localPointValueSolutions(timeStep);
+
+    // displacement (x is the default solution)
+    solutions.append(Util::scene()->sceneSolution()->sln(1, timeStep));
+
+    return solutions;
+}
+
 QStringList HermesElasticity::localPointValueHeader()
 {
     QStringList headers;
@@ -656,6 +671,16 @@ QList<SolutionArray *> HermesElasticity::solve(ProgressItemSolve *progressItemSo
 // ****************************************************************************************************************
 
 LocalPointValueElasticity::LocalPointValueElasticity(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueElasticity::LocalPointValueElasticity(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueElasticity::calculate()
 {
     young_modulus = 0.0;
     poisson_ratio = 0.0;
@@ -692,11 +717,8 @@ LocalPointValueElasticity::LocalPointValueElasticity(const Point &point) : Local
             temp = marker->temp.number;
             temp_ref = marker->temp_ref.number;
 
-            Solution *sln_x = Util::scene()->sceneSolution()->sln(0);
-            Solution *sln_y = Util::scene()->sceneSolution()->sln(1);
-
-            PointValue value_x = pointValue(sln_x, point);
-            PointValue value_y = pointValue(sln_y, point);
+            PointValue value_x = solutionValue(0);
+            PointValue value_y = solutionValue(1);
 
             d.x = value_x.value;
             d.y = value_y.value;
@@ -42,7 +42,9 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
+    QList<Solution *> localPointValueSolutions(int timeStep = -1);
 
     SurfaceIntegralValue *surfaceIntegralValue();
     QStringList surfaceIntegralValueHeader();
@@ -96,6 +98,9 @@ public:
 
 class LocalPointValueElasticity : public LocalPointValue
 {
+protected:
+    void calculate();
+
 public:
     double young_modulus;
     double poisson_ratio;
@@ -117,6 +122,7 @@ public:
     double stress_xy;
 
     LocalPointValueElasticity(const Point &point);
+    LocalPointValueElasticity(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
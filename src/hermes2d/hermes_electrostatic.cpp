@@ -115,6 +115,11 @@ LocalPointValue *HermesElectrostatic::localPointValue(const Point &point)
     return new LocalPointValueElectrostatic(point);
 }
 
+LocalPointValue *HermesElectrostatic::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueElectrostatic(point, solutionValues);
+}
+
 QStringList HermesElectrostatic::localPointValueHeader()
 {
     QStringList headers;
@@ -318,11 +323,11 @@ ViewScalarFilter *HermesElectrostatic::viewScalarFilter(PhysicFieldVariable phys
                                              physicFieldVariableComp);
 }
 
-Point3 HermesElectrostatic::particleForce(Point3 point, Point3 velocity)
+Point3 HermesElectrostatic::particleForce(Point3 point, Point3 velocity, const QList<PointValue> &solutionValues)
 {
-    LocalPointValueElectrostatic *pointValue = dynamic_cast<LocalPointValueElectrostatic *>(localPointValue(Point(point.x, point.y)));
+    LocalPointValueElectrostatic pointValue(Point(point.x, point.y), solutionValues);
 
-    return Point3(pointValue->E.x, pointValue->E.y, 0);
+    return Point3(pointValue.E.x, pointValue.E.y, 0);
 }
 
 // *******************************************************************************************************************************
@@ -374,6 +379,21 @@ QList<SolutionArray *> HermesElectrostatic::solve(ProgressItemSolve *progressIte
 // ****************************************************************************************************************
 
 LocalPointValueElectrostatic::LocalPointValueElectrostatic(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueElectrostatic::LocalPointValueElectrostatic(const Point &point, const PointValue &pointValue) : LocalPointValue(point, pointValue)
+{
+    calculate();
+}
+
+LocalPointValueElectrostatic::LocalPointValueElectrostatic(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueElectrostatic::calculate()
 {
     charge_density = 0;
     permittivity = 0;
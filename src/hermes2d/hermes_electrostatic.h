@@ -42,6 +42,7 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
 
     SurfaceIntegralValue *surfaceIntegralValue();
@@ -93,11 +94,14 @@ public:
 
     ViewScalarFilter *viewScalarFilter(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
 
-    Point3 particleForce(Point3 point, Point3 velocity = Point3());
+    Point3 particleForce(Point3 point, Point3 velocity, const QList<PointValue> &solutionValues);
 };
 
 class LocalPointValueElectrostatic : public LocalPointValue
 {
+protected:
+    void calculate();
+
 public:
     double charge_density;
     double permittivity;
@@ -107,6 +111,8 @@ public:
     double we;
 
     LocalPointValueElectrostatic(const Point &point);
+    LocalPointValueElectrostatic(const Point &point, const PointValue &pointValue);
+    LocalPointValueElectrostatic(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
@@ -63,6 +63,43 @@ HermesField *hermesFieldFactory(PhysicField physicField)
     }
 }
 
+QList<Solution *> HermesField::localPointValueSolutions(int timeStep)
+{
+    logTrace("HermesField::localPointValueSolutions()");
+
+    QList<Solution *> solutions;
+    solutions.append(Util::scene()->sceneSolution()->sln(-1, timeStep));
+
+    return solutions;
+}
+
+QList<LocalPointValue *> HermesField::localPointValues(const QList<Point> &points, int timeStep)
+{
+    logTrace("HermesField::localPointValues()");
+
+    if (Util::scene()->sceneSolution()->isSolved() &&
+            Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
+        updateTimeFunctions(Util::scene()->sceneSolution()->time(timeStep));
+
+    // evaluate all solutions needed by the local point value
+    QList<Solution *> solutions = localPointValueSolutions(timeStep);
+    QList<QList<PointValue> > values;
+    for (int j = 0; j < solutions.count(); j++)
+        values.append(LocalPointValue::pointValues(solutions.at(j), points));
+
+    QList<LocalPointValue *> localPointValues;
+    for (int i = 0; i < points.count(); i++)
+    {
+        QList<PointValue> solutionValues;
+        for (int j = 0; j < solutions.count(); j++)
+            solutionValues.append(values.at(j).at(i));
+
+        localPointValues.append(localPointValue(points.at(i), solutionValues));
+    }
+
+    return localPointValues;
+}
+
 void readMeshDirtyFix()
 {
     // fix precalulating matrices for mapping of curved elements
@@ -131,6 +168,37 @@ void writeMeshFromFile(const QString &fileName, Mesh *mesh)
     setlocale(LC_NUMERIC, plocale);
 }
 
+Mesh *readMeshFromByteArray(const QByteArray &content)
+{
+    // save locale
+    char *plocale = setlocale (LC_NUMERIC, "");
+    setlocale (LC_NUMERIC, "C");
+
+    Mesh *mesh = new Mesh();
+    H2DReader meshloader;
+    meshloader.load_str(content.constData(), mesh);
+
+    // set system locale
+    setlocale(LC_NUMERIC, plocale);
+
+    return mesh;
+}
+
+bool writeMeshToStream(FILE *f, Mesh *mesh)
+{
+    // save locale
+    char *plocale = setlocale (LC_NUMERIC, "");
+    setlocale (LC_NUMERIC, "C");
+
+    H2DReader meshloader;
+    bool ok = meshloader.save(f, mesh);
+
+    // set system locale
+    setlocale(LC_NUMERIC, plocale);
+
+    return ok;
+}
+
 void refineMesh(Mesh *mesh, bool refineGlobal, bool refineTowardsEdge)
 {
     // refine mesh - global
@@ -187,6 +255,19 @@ SolutionAgros::SolutionAgros(ProgressItemSolve *progressItemSolve, WeakFormAgros
     m_wf = wf;
 }
 
+// eliminating the bubble DOFs pays off for higher polynomial orders only
+static bool useStaticCondensation(Hermes::vector<Space *> space)
+{
+    for (int i = 0; i < space.size(); i++)
+    {
+        Element *e;
+        for_all_active_elements(e, space.at(i)->get_mesh())
+            if (H2D_GET_H_ORDER(space.at(i)->get_element_order(e->id)) >= 4)
+                return true;
+    }
+    return false;
+}
+
 QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<EssentialBCs> bcs)
 {
     QTime time;
@@ -194,9 +275,9 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
     // solution agros array
     QList<SolutionArray *> solutionArrayList;
 
-    // load the mesh file
-    mesh = readMeshFromFile(tempProblemFileName() + ".mesh");
-    refineMesh(mesh, true, true);
+    // copy of the initial mesh (already refined, see ProgressItemMesh::createMesh())
+    mesh = new Mesh();
+    mesh->copy(Util::scene()->sceneSolution()->meshInitial());
 
     // create an H1 space
     Hermes::vector<Space *> space;
@@ -235,6 +316,9 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
     for (int i = 0; i < numberOfSolution; i++)
     {
         space.push_back(new H1Space(mesh, &bcs[i], polynomialOrder));
+        // banded ordering of DOFs (kept by the reference spaces) reduces the LU fill of SuperLU,
+        // it does not pay off with the fill reducing orderings of UMFPACK and MUMPS
+        space.at(i)->set_rcm_ordering(matrixSolver == SOLVER_SUPERLU);
 
         // set order by element
         for (int j = 0; j < Util::scene()->labels.count(); j++)
@@ -296,6 +380,9 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
 
         double error = 0.0;
 
+        // reference spaces, constructed in the first adaptivity step and then updated
+        Hermes::vector<Space *> spaceReference;
+
         // solution
         int maxAdaptivitySteps = (adaptivityType == AdaptivityType_None) ? 1 : adaptivitySteps;
         int actualAdaptivitySteps = -1;
@@ -313,8 +400,18 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
             }
             else
             {
-                // construct globally refined reference mesh and setup reference space.
-                Hermes::vector<Space *> spaceReference = *Space::construct_refined_spaces(space);
+                // construct globally refined reference mesh and setup reference space,
+                // only the elements refined in the previous step change afterwards.
+                if (spaceReference.empty())
+                {
+                    Hermes::vector<Space *> *spaces = Space::construct_refined_spaces(space);
+                    spaceReference = *spaces;
+                    delete spaces;
+                }
+                else
+                {
+                    Space::update_refined_spaces(space, spaceReference);
+                }
 
                 // assemble reference problem.
                 solve(spaceReference, solutionReference, solver, matrix, rhs);
@@ -326,6 +423,7 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
 
                     // Calculate element errors and total error estimate.
                     Adapt adaptivity(space, projNormType);
+                    adaptivity.set_num_threads(Util::config()->numberOfThreads);
 
                     // Calculate error estimate for each solution component and the total error estimate.
                     error = adaptivity.calc_err_est(solution,
@@ -357,14 +455,6 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
                     isError = true;
                     break;
                 }
-
-                // delete reference space
-                for (int i = 0; i < spaceReference.size(); i++)
-                {
-                    delete spaceReference.at(i)->get_mesh();
-                    delete spaceReference.at(i);
-                }
-                spaceReference.clear();
             }
 
             // clean up.
@@ -373,6 +463,14 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
             delete rhs;
         }
 
+        // delete reference space
+        for (int i = 0; i < spaceReference.size(); i++)
+        {
+            delete spaceReference.at(i)->get_mesh();
+            delete spaceReference.at(i);
+        }
+        spaceReference.clear();
+
         // delete reference solution
         for (int i = 0; i < solutionReference.size(); i++)
             delete solutionReference.at(i);
@@ -391,15 +489,22 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
 
             // allocate dp for transient solution
             DiscreteProblem *dpTran = NULL;
+            // the space does not change in the time steps, they share the mesh and the orders
+            QList<SolutionLayout *> layouts;
             if (analysisType == AnalysisType_Transient)
             {
                 // set up the solver, matrix, and rhs according to the solver selection.
                 matrix = create_matrix(matrixSolver);
                 rhs = create_vector(matrixSolver);
                 solver = create_linear_solver(matrixSolver, matrix, rhs);
-                // solver->set_factorization_scheme(HERMES_REUSE_FACTORIZATION_COMPLETELY);
+
+                // time dependent values enter only the right hand side, the matrix of a linear
+                // problem is assembled and factorized in the first time step only
+                if (linearityType == LinearityType_Linear)
+                    solver->set_factorization_scheme(HERMES_REUSE_FACTORIZATION_COMPLETELY);
 
                 dpTran = new DiscreteProblem(m_wf, space, true);
+                dpTran->set_static_condensation(useStaticCondensation(space));
             }
 
             int timesteps = (analysisType == AnalysisType_Transient) ? floor(timeTotal/timeStep) : 1;
@@ -414,13 +519,17 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
                 Util::scene()->problemInfo()->hermes()->updateTimeFunctions(actualTime);
 
                 m_wf->set_current_time(actualTime);
-                m_wf->delete_all();
-                m_wf->registerForms();
+                // forms of linear problems read the time dependent values during assembling
+                if (linearityType != LinearityType_Linear)
+                {
+                    m_wf->delete_all();
+                    m_wf->registerForms();
+                }
 
                 // transient
                 if ((timesteps > 1) && (linearityType == LinearityType_Linear))
                     isError = !solveLinear(dpTran, space, solution,
-                                           solver, matrix, rhs);
+                                           solver, matrix, rhs, n > 0);
                 if ((timesteps > 1) && (linearityType != LinearityType_Linear))
                     isError = !solve(space, solution,
                                      solver, matrix, rhs);
@@ -428,7 +537,23 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
                 // output
                 for (int i = 0; i < numberOfSolution; i++)
                 {
-                    solutionArrayList.append(solutionArray(solution.at(i), space.at(i), error, actualAdaptivitySteps, (n+1)*timeStep));
+                    if (timesteps > 1)
+                    {
+                        if (n == 0)
+                        {
+                            Solution *sln = new Solution();
+                            sln->copy(solution.at(i));
+                            Orderizer *order = new Orderizer();
+                            order->process_space(space.at(i));
+                            layouts.append(new SolutionLayout(sln, order));
+                        }
+
+                        solutionArrayList.append(solutionArray(solution.at(i), space.at(i), layouts.at(i), error, actualAdaptivitySteps, (n+1)*timeStep));
+                    }
+                    else
+                    {
+                        solutionArrayList.append(solutionArray(solution.at(i), space.at(i), error, actualAdaptivitySteps, (n+1)*timeStep));
+                    }
                 }
 
                 if (analysisType == AnalysisType_Transient)
@@ -443,6 +568,11 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
                 }
             }
 
+            // layouts not used by any time step
+            foreach (SolutionLayout *layout, layouts)
+                if (layout->references == 0)
+                    delete layout;
+
             // clean up
             if (solver) delete solver;
             if (matrix) delete matrix;
@@ -476,19 +606,79 @@ QList<SolutionArray *> SolutionAgros::solveSolutioArray(Hermes::vector<Essential
     return solutionArrayList;
 }
 
+// the system is written from a copy in a background thread, so that the solver
+// does not wait for the disk; the previous write is finished first
+static QFuture<void> saveMatrixRHSFuture;
+
+static void writeMatrixRHS(SparseMatrix *matrix, Vector *rhs, const QString &fileName)
+{
+    FILE *f = fopen(fileName.toStdString().c_str(), "wb");
+    if (f)
+    {
+        matrix->dump(f, "matrix", DF_HERMES_BIN);
+        rhs->dump(f, "rhs", DF_HERMES_BIN);
+        fclose(f);
+    }
+
+    delete matrix;
+    delete rhs;
+}
+
+void SolutionAgros::saveMatrixRHS(SparseMatrix *matrix, Vector *rhs)
+{
+    logMessage("SolutionAgros::saveMatrixRHS()");
+
+    SparseMatrix *matrixCopy = matrix->duplicate();
+    if (!matrixCopy)
+    {
+        m_progressItemSolve->emitMessage(QObject::tr("Matrix and RHS cannot be saved, the matrix of the solver cannot be copied."), false);
+        return;
+    }
+
+    scalar *values = new scalar[rhs->length()];
+    rhs->extract(values);
+    Vector *rhsCopy = create_vector(matrixSolver);
+    rhsCopy->alloc(rhs->length());
+    rhsCopy->add_vector(values);
+    delete [] values;
+
+    saveMatrixRHSFuture.waitForFinished();
+    saveMatrixRHSFuture = QtConcurrent::run(writeMatrixRHS, matrixCopy, rhsCopy,
+                                            tempProblemDir() + "/matrix_rhs.bin");
+}
+
 bool SolutionAgros::solveLinear(DiscreteProblem *dp,
                                 Hermes::vector<Space *> space,
                                 Hermes::vector<Solution *> solution,
-                                Solver *solver, SparseMatrix *matrix, Vector *rhs)
+                                Solver *solver, SparseMatrix *matrix, Vector *rhs,
+                                bool rhsOnly)
 {
+    dp->set_num_threads(Util::config()->numberOfThreads);
+
     // QTime time;
     // time.start();
-    dp->assemble(matrix, rhs);
+    // reuse the matrix (and its factorization) assembled before
+    dp->assemble(rhsOnly ? NULL : matrix, rhs);
     // qDebug() << "assemble: " << time.elapsed();
 
+    // save matrix and rhs (diagnostics)
+    if (Util::config()->saveMatrixRHS)
+        saveMatrixRHS(matrix, rhs);
+
     if(solver->solve())
     {
-        Solution::vector_to_solutions(solver->get_solution(), space, solution);
+        if (dp->get_static_condensation())
+        {
+            // bubble DOFs eliminated from the system
+            scalar *coeff = new scalar[dp->get_num_dofs()];
+            dp->expand_condensed_solution(solver->get_solution(), coeff);
+            Solution::vector_to_solutions(coeff, space, solution);
+            delete [] coeff;
+        }
+        else
+        {
+            Solution::vector_to_solutions(solver->get_solution(), space, solution);
+        }
         return true;
     }
     else
@@ -506,15 +696,11 @@ bool SolutionAgros::solve(Hermes::vector<Space *> space,
     if (linearityType == LinearityType_Linear)
     {
         DiscreteProblem dpLin(m_wf, space, true);
+        dpLin.set_static_condensation(useStaticCondensation(space));
 
         isError = !solveLinear(&dpLin, space, solution,
                                solver, matrix, rhs);
 
-        // dump matrix
-        FILE *f = fopen(QString(tempProblemDir() + "/matrix.m").toStdString().c_str(), "w");
-        matrix->dump(f, QString("mat").toStdString().c_str(), DF_MATRIX_MARKET);
-        fclose(f);
-
         return !isError;
     }
 
@@ -599,6 +785,7 @@ bool SolutionAgros::solve(Hermes::vector<Space *> space,
                                      Util::scene()->problemInfo()->matrixSolver);
 
         DiscreteProblem dpNonlinNewton(wf, space, false);
+        dpNonlinNewton.set_num_threads(Util::config()->numberOfThreads);
 
         // The Newton's loop.
         double damping_coeff = 1.0;
@@ -660,6 +847,21 @@ SolutionArray *SolutionAgros::solutionArray(Solution *sln, Space *space, double
     return solution;
 }
 
+SolutionArray *SolutionAgros::solutionArray(Solution *sln, Space *space, SolutionLayout *layout, double adaptiveError, double adaptiveSteps, double time)
+{
+    // layout of the solution differs
+    if (sln->get_type() != HERMES_SLN || sln->get_num_coefs() != layout->sln->get_num_coefs())
+        return solutionArray(sln, space, adaptiveError, adaptiveSteps, time);
+
+    SolutionArray *solution = new SolutionArray();
+    solution->setLayout(layout, sln);
+    solution->adaptiveError = adaptiveError;
+    solution->adaptiveSteps = adaptiveSteps;
+    solution->time = time;
+
+    return solution;
+}
+
 // *********************************************************************************************************************************************
 
 ViewScalarFilter::ViewScalarFilter(Hermes::vector<MeshFunction *> sln, PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp)
@@ -669,11 +871,47 @@ ViewScalarFilter::ViewScalarFilter(Hermes::vector<MeshFunction *> sln, PhysicFie
     m_physicFieldVariableComp = physicFieldVariableComp;
 }
 
+ViewScalarFilter::~ViewScalarFilter()
+{
+    for (int i = 0; i < m_privateSolutions.count(); i++)
+        delete m_privateSolutions.at(i);
+}
+
 double ViewScalarFilter::get_pt_value(double x, double y, int item)
 {
     return 0.0;
 }
 
+bool ViewScalarFilter::usePrivateSolutions()
+{
+    logMessage("ViewScalarFilter::usePrivateSolutions()");
+
+    for (int i = 0; i < num; i++)
+        if (!dynamic_cast<Solution *>(sln[i]))
+            return false;
+
+    // the copies share the mesh, the same solution is copied only once
+    QMap<MeshFunction *, Solution *> copies;
+    for (int i = 0; i < num; i++)
+    {
+        if (!copies.contains(sln[i]))
+        {
+            Solution *solution = new Solution();
+            solution->copy(dynamic_cast<Solution *>(sln[i]), false);
+            solution->use_private_refmap_pss();
+
+            copies[sln[i]] = solution;
+            m_privateSolutions.append(solution);
+        }
+        sln[i] = copies[sln[i]];
+    }
+
+    set_quad_2d(&g_quad_2d_std);
+    use_private_refmap_pss();
+
+    return true;
+}
+
 void ViewScalarFilter::precalculate(int order, int mask)
 {
     Quad2D* quad = quads[cur_quad];
@@ -41,6 +41,7 @@ class SceneBoundary;
 class SceneMaterial;
 struct SceneViewSettings;
 struct SolutionArray;
+struct SolutionLayout;
 
 class ProgressItemSolve;
 
@@ -76,7 +77,13 @@ public:
     virtual void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker) = 0;
 
     virtual LocalPointValue *localPointValue(const Point &point) = 0;
+    virtual LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues) { return localPointValue(point); }
     virtual QStringList localPointValueHeader() = 0;
+    // solutions needed by the local point value (evaluated at once by localPointValues(),
+    // the local point value takes their values in this order, see LocalPointValue::solutionValue())
+    virtual QList<Solution *> localPointValueSolutions(int timeStep = -1);
+    // batched evaluation (points are located and evaluated at once), the current time step by default
+    QList<LocalPointValue *> localPointValues(const QList<Point> &points, int timeStep = -1);
 
     virtual SurfaceIntegralValue *surfaceIntegralValue() = 0;
     virtual QStringList surfaceIntegralValueHeader() = 0;
@@ -114,7 +121,8 @@ public:
     virtual inline void deformShape(double3* linVert, int count) {}
     virtual inline void deformShape(double4* linVert, int count) {}
 
-    virtual inline Point3 particleForce(Point3 point, Point3 velocity = Point3()) { return Point3(); }
+    // force acting on the particle, the values of localPointValueSolutions() are evaluated by the caller
+    virtual inline Point3 particleForce(Point3 point, Point3 velocity, const QList<PointValue> &solutionValues) { return Point3(); }
 };
 
 HermesField *hermesFieldFactory(PhysicField physicField);
@@ -123,9 +131,13 @@ class ViewScalarFilter : public Filter
 {
 public:
     ViewScalarFilter(Hermes::vector<MeshFunction *> sln, PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
+    ~ViewScalarFilter();
 
     double get_pt_value(double x, double y, int item = H2D_FN_VAL);
 
+    // evaluate on private copies of the solutions (filter processed in a worker thread)
+    bool usePrivateSolutions();
+
 protected:
     PhysicFieldVariable m_physicFieldVariable;
     PhysicFieldVariableComp m_physicFieldVariableComp;
@@ -138,6 +150,8 @@ protected:
 
     SceneMaterial *material;
 
+    QList<Solution *> m_privateSolutions;
+
     void precalculate(int order, int mask);
     virtual void calculateVariable(int i) = 0;
 };
@@ -148,6 +162,9 @@ void readMeshDirtyFix();
 // read mesh
 Mesh *readMeshFromFile(const QString &fileName);
 void writeMeshFromFile(const QString &fileName, Mesh *mesh);
+// mesh text held in memory or written to an open stream
+Mesh *readMeshFromByteArray(const QByteArray &content);
+bool writeMeshToStream(FILE *f, Mesh *mesh);
 
 void refineMesh(Mesh *mesh, bool refineGlobal, bool refineTowardsEdge);
 
@@ -196,15 +213,21 @@ private:
     ProgressItemSolve *m_progressItemSolve;
 
     SolutionArray *solutionArray(Solution *sln, Space *space = NULL, double adaptiveError = 0.0, double adaptiveSteps = 0.0, double time = 0.0);
+    // compact time step sharing the mesh and the orders of the layout
+    SolutionArray *solutionArray(Solution *sln, Space *space, SolutionLayout *layout, double adaptiveError, double adaptiveSteps, double time);
 
     bool solveLinear(DiscreteProblem *dp,
                      Hermes::vector<Space *> space,
                      Hermes::vector<Solution *> solution,
-                     Solver *solver, SparseMatrix *matrix, Vector *rhs);
+                     Solver *solver, SparseMatrix *matrix, Vector *rhs,
+                     bool rhsOnly = false);
 
     bool solve(Hermes::vector<Space *> space,
                Hermes::vector<Solution *> solution,
                Solver *solver, SparseMatrix *matrix, Vector *rhs);
+
+    // binary dump of the linear system (diagnostics)
+    void saveMatrixRHS(SparseMatrix *matrix, Vector *rhs);
 };
 
 // custom forms **************************************************************************************************************************
@@ -253,4 +276,61 @@ private:
     GeomType gt;
 };
 
+// source terms given by a value read during assembling (time dependent values
+// are updated by updateTimeFunctions() without registering the forms again),
+// shared by the volume and surface form
+template <typename FormType>
+class CustomVectorFormValueType : public FormType
+{
+public:
+    CustomVectorFormValueType(int i, std::string area, Value *value, GeomType gt)
+        : FormType(i, area), m_value(value), gt(gt) { }
+
+    virtual scalar value(int n, double *wt, Func<scalar> *u_ext[], Func<double> *v,
+                         Geom<double> *e, ExtData<scalar> *ext) const {
+        if (gt == HERMES_PLANAR)
+            return m_value->number * int_v<double>(n, wt, v);
+        else if (gt == HERMES_AXISYM_X)
+            return m_value->number * int_y_v<double>(n, wt, v, e);
+        else
+            return m_value->number * int_x_v<double>(n, wt, v, e);
+    }
+
+    virtual Ord ord(int n, double *wt, Func<Ord> *u_ext[], Func<Ord> *v, Geom<Ord> *e,
+                    ExtData<Ord> *ext) const {
+        if (gt == HERMES_PLANAR)
+            return int_v<Ord>(n, wt, v);
+        else if (gt == HERMES_AXISYM_X)
+            return int_y_v<Ord>(n, wt, v, e);
+        else
+            return int_x_v<Ord>(n, wt, v, e);
+    }
+
+private:
+    Value *m_value;
+    GeomType gt;
+};
+
+class CustomVectorFormValue : public CustomVectorFormValueType<WeakForm::VectorFormVol>
+{
+public:
+    CustomVectorFormValue(int i, std::string area, Value *value, GeomType gt = HERMES_PLANAR)
+        : CustomVectorFormValueType<WeakForm::VectorFormVol>(i, area, value, gt) { }
+
+    virtual WeakForm::VectorFormVol* clone() {
+        return new CustomVectorFormValue(*this);
+    }
+};
+
+class CustomVectorFormSurfValue : public CustomVectorFormValueType<WeakForm::VectorFormSurf>
+{
+public:
+    CustomVectorFormSurfValue(int i, std::string area, Value *value, GeomType gt = HERMES_PLANAR)
+        : CustomVectorFormValueType<WeakForm::VectorFormSurf>(i, area, value, gt) { }
+
+    virtual WeakForm::VectorFormSurf* clone() {
+        return new CustomVectorFormSurfValue(*this);
+    }
+};
+
 #endif // HERMES_FIELD_H
@@ -116,6 +116,11 @@ LocalPointValue *HermesGeneral::localPointValue(const Point &point)
     return new LocalPointValueGeneral(point);
 }
 
+LocalPointValue *HermesGeneral::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueGeneral(point, solutionValues);
+}
+
 QStringList HermesGeneral::localPointValueHeader()
 {
     QStringList headers;
@@ -340,6 +345,16 @@ QList<SolutionArray *> HermesGeneral::solve(ProgressItemSolve *progressItemSolve
 // ****************************************************************************************************************
 
 LocalPointValueGeneral::LocalPointValueGeneral(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueGeneral::LocalPointValueGeneral(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueGeneral::calculate()
 {
     variable = 0;
     rightside = 0;
@@ -42,6 +42,7 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
 
     SurfaceIntegralValue *surfaceIntegralValue();
@@ -91,6 +92,7 @@ public:
 class LocalPointValueGeneral : public LocalPointValue
 {
 protected:
+    void calculate();
     void calculateVariables(int i);
 
 public:
@@ -100,6 +102,7 @@ public:
     double constant;
 
     LocalPointValueGeneral(const Point &point);
+    LocalPointValueGeneral(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
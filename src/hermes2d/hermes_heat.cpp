@@ -70,11 +70,11 @@ public:
                                                                                                HERMES_SYM,
                                                                                                convertProblemType(Util::scene()->problemInfo()->problemType)));
 
-                if (fabs(material->volume_heat.number) > EPS_ZERO)
-                    add_vector_form(new WeakFormsH1::VolumetricVectorForms::DefaultVectorFormConst(0,
-                                                                                                   QString::number(i).toStdString(),
-                                                                                                   material->volume_heat.number,
-                                                                                                   convertProblemType(Util::scene()->problemInfo()->problemType)));
+                if ((fabs(material->volume_heat.number) > EPS_ZERO) || material->volume_heat.isTimeDep())
+                    add_vector_form(new CustomVectorFormValue(0,
+                                                              QString::number(i).toStdString(),
+                                                              &material->volume_heat,
+                                                              convertProblemType(Util::scene()->problemInfo()->problemType)));
 
                 // transient analysis
                 if (Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
@@ -171,6 +171,11 @@ LocalPointValue *HermesHeat::localPointValue(const Point &point)
     return new LocalPointValueHeat(point);
 }
 
+LocalPointValue *HermesHeat::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueHeat(point, solutionValues);
+}
+
 QStringList HermesHeat::localPointValueHeader()
 {
     QStringList headers;
@@ -555,6 +560,16 @@ void HermesHeat::updateTimeFunctions(double time)
 // ****************************************************************************************************************
 
 LocalPointValueHeat::LocalPointValueHeat(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueHeat::LocalPointValueHeat(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueHeat::calculate()
 {
     thermal_conductivity = 0;
     volume_heat = 0;
@@ -42,6 +42,7 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
 
     SurfaceIntegralValue *surfaceIntegralValue();
@@ -95,6 +96,9 @@ public:
 
 class LocalPointValueHeat : public LocalPointValue
 {
+protected:
+    void calculate();
+
 public:
     double volume_heat;
     double thermal_conductivity;
@@ -103,6 +107,7 @@ public:
     Point G;
 
     LocalPointValueHeat(const Point &point);
+    LocalPointValueHeat(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
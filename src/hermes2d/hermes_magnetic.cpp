@@ -81,11 +81,11 @@ public:
                                                                                                                      material->velocity_angular.number));
 
                 // external current density
-                if (fabs(material->current_density_real.number) > EPS_ZERO)
-                    add_vector_form(new WeakFormsH1::VolumetricVectorForms::DefaultVectorFormConst(0,
-                                                                                                   QString::number(i).toStdString(),
-                                                                                                   material->current_density_real.number,
-                                                                                                   HERMES_PLANAR));
+                if ((fabs(material->current_density_real.number) > EPS_ZERO) || material->current_density_real.isTimeDep())
+                    add_vector_form(new CustomVectorFormValue(0,
+                                                              QString::number(i).toStdString(),
+                                                              &material->current_density_real,
+                                                              HERMES_PLANAR));
 
                 // remanence
                 if (fabs(material->remanence.number) > EPS_ZERO)
@@ -248,6 +248,33 @@ LocalPointValue *HermesMagnetic::localPointValue(const Point &point)
     return new LocalPointValueMagnetic(point);
 }
 
+LocalPointValue *HermesMagnetic::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueMagnetic(point, solutionValues);
+}
+
+QList<Solution *> HermesMagnetic::localPointValueSolutions(int timeStep)
+{
+    QList<Solution *> solutions = HermesField::localPointValueSolutions(timeStep);
+
+    // previous time step (induced transform current density), the first time step takes its own solution
+    if (Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
+    {
+        if (timeStep == -1)
+            timeStep = Util::scene()->sceneSolution()->timeStep();
+
+        if (timeStep > 0)
+            solutions.append(Util::scene()->sceneSolution()->sln(numberOfSolution() - 1, timeStep - 1));
+        else
+            solutions.append(Util::scene()->sceneSolution()->sln(-1, timeStep));
+    }
+
+    if (Util::scene()->problemInfo()->analysisType == AnalysisType_Harmonic)
+        solutions.append(Util::scene()->sceneSolution()->sln(1, timeStep));
+
+    return solutions;
+}
+
 QStringList HermesMagnetic::localPointValueHeader()
 {
     QStringList headers;
@@ -813,15 +840,15 @@ ViewScalarFilter *HermesMagnetic::viewScalarFilter(PhysicFieldVariable physicFie
     }
 }
 
-Point3 HermesMagnetic::particleForce(Point3 point, Point3 velocity)
+Point3 HermesMagnetic::particleForce(Point3 point, Point3 velocity, const QList<PointValue> &solutionValues)
 {
-    LocalPointValueMagnetic *pointValue = dynamic_cast<LocalPointValueMagnetic *>(localPointValue(Point(point.x, point.y)));
+    LocalPointValueMagnetic pointValue(Point(point.x, point.y), solutionValues);
 
     if (Util::scene()->problemInfo()->problemType == ProblemType_Planar)
     {
-        return Point3(- velocity.z * pointValue->B_real.y, // x
-                      velocity.z * pointValue->B_real.x, // y
-                      velocity.x * pointValue->B_real.y - velocity.y * pointValue->B_real.x); // z
+        return Point3(- velocity.z * pointValue.B_real.y, // x
+                      velocity.z * pointValue.B_real.x, // y
+                      velocity.x * pointValue.B_real.y - velocity.y * pointValue.B_real.x); // z
     }
     else
     {
@@ -829,9 +856,9 @@ Point3 HermesMagnetic::particleForce(Point3 point, Point3 velocity)
         // -partq*partv*Br_emqa
         // partq*(partw*Br_emqa-partu*Bz_emqa)
 
-        return Point3(velocity.z * point.x * pointValue->B_real.y, // r
-                      - velocity.z * point.x * pointValue->B_real.x, // z
-                      velocity.y * pointValue->B_real.x - velocity.x * pointValue->B_real.y); // alpha
+        return Point3(velocity.z * point.x * pointValue.B_real.y, // r
+                      - velocity.z * point.x * pointValue.B_real.x, // z
+                      velocity.y * pointValue.B_real.x - velocity.x * pointValue.B_real.y); // alpha
     }
 }
 
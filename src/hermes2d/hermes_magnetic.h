@@ -42,7 +42,9 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
+    QList<Solution *> localPointValueSolutions(int timeStep = -1);
 
     SurfaceIntegralValue *surfaceIntegralValue();
     QStringList surfaceIntegralValueHeader();
@@ -102,11 +104,14 @@ public:
 
     ViewScalarFilter *viewScalarFilter(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
 
-    Point3 particleForce(Point3 point, Point3 velocity = Point3());
+    Point3 particleForce(Point3 point, Point3 velocity, const QList<PointValue> &solutionValues);
 };
 
 class LocalPointValueMagnetic : public LocalPointValue
 {
+protected:
+    void calculate();
+
 public:
     double permeability;
     double conductivity;
@@ -136,6 +141,8 @@ public:
     double wm;
 
     LocalPointValueMagnetic(const Point &point);
+    LocalPointValueMagnetic(const Point &point, const PointValue &pointValue);
+    LocalPointValueMagnetic(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
@@ -23,6 +23,21 @@
 #include "gui.h"
 
 LocalPointValueMagnetic::LocalPointValueMagnetic(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueMagnetic::LocalPointValueMagnetic(const Point &point, const PointValue &pointValue) : LocalPointValue(point, pointValue)
+{
+    calculate();
+}
+
+LocalPointValueMagnetic::LocalPointValueMagnetic(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueMagnetic::calculate()
 {
     permeability = 0;
     conductivity = 0;
@@ -98,13 +113,8 @@ LocalPointValueMagnetic::LocalPointValueMagnetic(const Point &point) : LocalPoin
                 // induced transform current density
                 if (Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
                 {
-                    Solution *sln2;
-                    if (Util::scene()->sceneSolution()->timeStep() > 0)
-                        sln2 = Util::scene()->sceneSolution()->sln(Util::scene()->sceneSolution()->timeStep() * Util::scene()->problemInfo()->hermes()->numberOfSolution() - 1);
-                    else
-                        sln2 = Util::scene()->sceneSolution()->sln();
-
-                    PointValue valuePrevious = pointValue(sln2, point);
+                    // previous time step (see HermesMagnetic::localPointValueSolutions())
+                    PointValue valuePrevious = solutionValue(1);
                     current_density_induced_transform_real = - marker->conductivity.number * (valueReal.value - valuePrevious.value) / Util::scene()->problemInfo()->timeStep.number;
                 }
 
@@ -133,10 +143,8 @@ LocalPointValueMagnetic::LocalPointValueMagnetic(const Point &point) : LocalPoin
 
             if (Util::scene()->problemInfo()->analysisType == AnalysisType_Harmonic)
             {
-                Solution *sln2 = Util::scene()->sceneSolution()->sln(1);
-
                 // value imag
-                PointValue valueImag = pointValue(sln2, point);
+                PointValue valueImag = solutionValue(1);
                 double frequency = Util::scene()->problemInfo()->frequency;
 
                 Point derReal = valueReal.derivative;
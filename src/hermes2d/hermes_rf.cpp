@@ -509,6 +509,21 @@ LocalPointValue *HermesRF::localPointValue(const Point &point)
     return new LocalPointValueRF(point);
 }
 
+LocalPointValue *HermesRF::localPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    return new LocalPointValueRF(point, solutionValues);
+}
+
+QList<Solution *> HermesRF::localPointValueSolutions(int timeStep)
+{
+    QList<Solution *> solutions = HermesField::localPointValueSolutions(timeStep);
+
+    if (Util::scene()->problemInfo()->analysisType == AnalysisType_Harmonic)
+        solutions.append(Util::scene()->sceneSolution()->sln(1, timeStep));
+
+    return solutions;
+}
+
 QStringList HermesRF::localPointValueHeader()
 {
     QStringList headers;
@@ -890,6 +905,16 @@ QList<SolutionArray *> HermesRF::solve(ProgressItemSolve *progressItemSolve)
 // ****************************************************************************************************************
 
 LocalPointValueRF::LocalPointValueRF(const Point &point) : LocalPointValue(point)
+{
+    calculate();
+}
+
+LocalPointValueRF::LocalPointValueRF(const Point &point, const QList<PointValue> &solutionValues) : LocalPointValue(point, solutionValues)
+{
+    calculate();
+}
+
+void LocalPointValueRF::calculate()
 {
     permittivity = 0;
     permeability = 0;
@@ -916,12 +941,10 @@ LocalPointValueRF::LocalPointValueRF(const Point &point) : LocalPointValue(point
         {
             if (Util::scene()->problemInfo()->analysisType == AnalysisType_Harmonic)
             {
-                Solution *sln2 = Util::scene()->sceneSolution()->sln(1);
-
                 double w = 2 * M_PI * Util::scene()->problemInfo()->frequency;
                 double mu = marker->permeability.number * MU0;
                 // value imag
-                PointValue valueImag = pointValue(sln2, point);
+                PointValue valueImag = solutionValue(1);
                 // derivative
                 Point derReal = valueReal.derivative;
                 Point derImag = valueImag.derivative;
@@ -42,7 +42,9 @@ public:
     void writeMaterialToDomElement(QDomElement *element, SceneMaterial *marker);
 
     LocalPointValue *localPointValue(const Point &point);
+    LocalPointValue *localPointValue(const Point &point, const QList<PointValue> &solutionValues);
     QStringList localPointValueHeader();
+    QList<Solution *> localPointValueSolutions(int timeStep = -1);
 
     SurfaceIntegralValue *surfaceIntegralValue();
     QStringList surfaceIntegralValueHeader();
@@ -105,6 +107,9 @@ public:
 
 class LocalPointValueRF : public LocalPointValue
 {
+protected:
+    void calculate();
+
 public:
     double permittivity;
     double permeability;
@@ -122,6 +127,7 @@ public:
     Point poynting_vector;
 
     LocalPointValueRF(const Point &point);
+    LocalPointValueRF(const Point &point, const QList<PointValue> &solutionValues);
     double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp);
     QStringList variables();
 };
@@ -25,7 +25,7 @@
 
 LocalPointValue::LocalPointValue(const Point &point)
 {
-    logMessage("LocalPointValue::LocalPointValue()");
+    logTrace("LocalPointValue::LocalPointValue()");
 
     this->point = point;
     if (Util::scene()->sceneSolution()->isSolved() &&
@@ -39,36 +39,112 @@ LocalPointValue::LocalPointValue(const Point &point)
     material = val.marker;
 }
 
+LocalPointValue::LocalPointValue(const Point &point, const PointValue &pointValue)
+{
+    logTrace("LocalPointValue::LocalPointValue()");
+
+    this->point = point;
+
+    value = pointValue.value;
+    derivative = pointValue.derivative;
+    material = pointValue.marker;
+}
+
+LocalPointValue::LocalPointValue(const Point &point, const QList<PointValue> &solutionValues)
+{
+    logTrace("LocalPointValue::LocalPointValue()");
+
+    this->point = point;
+    this->solutionValues = solutionValues;
+
+    PointValue val = solutionValues.value(0);
+
+    value = val.value;
+    derivative = val.derivative;
+    material = val.marker;
+}
+
 PointValue LocalPointValue::pointValue(Solution *sln, const Point &point)
 {
-    logMessage("LocalPointValue::pointValue()");
+    logTrace("LocalPointValue::pointValue()");
+
+    QList<Point> points;
+    points.append(point);
+
+    return pointValues(sln, points).first();
+}
+
+PointValue LocalPointValue::solutionValue(int i)
+{
+    logTrace("LocalPointValue::solutionValue()");
 
-    double tmpValue;
-    Point tmpDerivative;
-    SceneMaterial *tmpMaterial = NULL;
+    if (i < solutionValues.count())
+        return solutionValues.at(i);
 
-    if (sln)
+    return pointValue(Util::scene()->problemInfo()->hermes()->localPointValueSolutions().value(i), point);
+}
+
+QList<PointValue> LocalPointValue::pointValues(Solution *sln, const QList<Point> &points)
+{
+    logTrace("LocalPointValue::pointValues()");
+
+    QList<PointValue> values;
+
+    if (!sln)
     {
-        int index = Util::scene()->sceneSolution()->findElementInMesh(Util::scene()->sceneSolution()->meshInitial(), point);
-        if (index != -1)
-        {
-            if ((Util::scene()->problemInfo()->analysisType == AnalysisType_Transient) &&
-                    Util::scene()->sceneSolution()->timeStep() == 0)
-                // const solution at first time step
-                tmpValue = Util::scene()->problemInfo()->initialCondition.number;
-            else                
-                tmpValue = sln->get_pt_value(point.x, point.y, H2D_FN_VAL_0);
+        for (int i = 0; i < points.count(); i++)
+            values.append(PointValue());
+
+        return values;
+    }
+
+    int count = points.count();
+    double *x = new double[count];
+    double *y = new double[count];
+    double *value = new double[count];
+    double *dx = new double[count];
+    double *dy = new double[count];
+    Element **elements = new Element*[count];
+
+    for (int i = 0; i < count; i++)
+    {
+        x[i] = points.at(i).x;
+        y[i] = points.at(i).y;
+    }
+
+    // locate and evaluate all points at once
+    sln->get_pt_values(count, x, y, value, dx, dy, elements);
 
-            tmpDerivative.x = sln->get_pt_value(point.x, point.y, H2D_FN_DX_0);
-            tmpDerivative.y = sln->get_pt_value(point.x, point.y, H2D_FN_DY_0);
+    // const solution at first time step
+    bool initialCondition = ((Util::scene()->problemInfo()->analysisType == AnalysisType_Transient) &&
+                             Util::scene()->sceneSolution()->timeStep() == 0);
+
+    Mesh *mesh = sln->get_mesh();
+    for (int i = 0; i < count; i++)
+    {
+        if (elements[i])
+        {
+            double tmpValue = initialCondition ? Util::scene()->problemInfo()->initialCondition.number : value[i];
 
             // find marker
-            Element *e = Util::scene()->sceneSolution()->meshInitial()->get_element_fast(index);
-            tmpMaterial = Util::scene()->labels[atoi(Util::scene()->sceneSolution()->meshInitial()->get_element_markers_conversion().get_user_marker(e->marker).c_str())]->material;
+            SceneMaterial *tmpMaterial = Util::scene()->labels[atoi(mesh->get_element_markers_conversion().get_user_marker(elements[i]->marker).c_str())]->material;
+
+            values.append(PointValue(tmpValue, Point(dx[i], dy[i]), tmpMaterial));
+        }
+        else
+        {
+            values.append(PointValue());
         }
     }
 
-    return PointValue(tmpValue, tmpDerivative, tmpMaterial);
+    delete [] x;
+    delete [] y;
+    delete [] value;
+    delete [] dx;
+    delete [] dy;
+    delete [] elements;
+
+    return values;
 }
 
 // *************************************************************************************************************************************
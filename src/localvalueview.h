@@ -54,12 +54,23 @@ protected:
     Point derivative;
     SceneMaterial *material;
 
+    // values of HermesField::localPointValueSolutions() evaluated at once (see HermesField::localPointValues())
+    QList<PointValue> solutionValues;
+
+    // evaluated value of sln
     PointValue pointValue(Solution *sln, const Point &point);
+    // value of the i-th solution of HermesField::localPointValueSolutions() (taken from solutionValues if present)
+    PointValue solutionValue(int i);
 
 public:
     Point point;
 
     LocalPointValue(const Point &point);
+    LocalPointValue(const Point &point, const PointValue &pointValue);
+    LocalPointValue(const Point &point, const QList<PointValue> &solutionValues);
+
+    // evaluates value, derivative and material in all points at once
+    static QList<PointValue> pointValues(Solution *sln, const QList<Point> &points);
 
     virtual double variableValue(PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp) = 0;
     virtual QStringList variables() = 0;
@@ -147,6 +147,9 @@ void LogDialog::loadApplicationLog()
 
     lstMessages->clear();
 
+    // queued messages
+    flushLog();
+
     QString location = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
     QFile file(location + "/app.log");
     if (file.exists())
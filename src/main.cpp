@@ -117,5 +117,10 @@ int main(int argc, char *argv[])
     MainWindow w;
     w.show();
 
-    return a.exec();
+    int result = a.exec();
+
+    // log writer uses the application (location of the log)
+    stopLog();
+
+    return result;
 }
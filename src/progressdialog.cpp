@@ -23,6 +23,43 @@
 #include "scene.h"
 #include "sceneview.h"
 
+#ifdef WITH_TRIANGLE
+#include <setjmp.h>
+
+extern "C"
+{
+#define REAL double
+#define VOID void
+#define ANSI_DECLARATORS
+#include <triangle.h>
+}
+
+// Triangle exits the process on fatal errors (e.g. invalid geometry) through triexit(),
+// this definition takes precedence over the one of the shared library and jumps back
+// to ProgressItemMesh::triangulateInProcess()
+static jmp_buf triangleExit;
+static bool isTriangleRunning = false;
+
+extern "C" void triexit(int status)
+{
+    if (isTriangleRunning)
+        longjmp(triangleExit, (status != 0) ? status : 1);
+
+    exit(status);
+}
+#endif
+
+SolutionLayout::SolutionLayout(Solution *sln, Orderizer *order)
+    : sln(sln), order(order), references(0)
+{
+}
+
+SolutionLayout::~SolutionLayout()
+{
+    delete sln;
+    delete order;
+}
+
 SolutionArray::SolutionArray()
 {
     logMessage("SolutionArray::SolutionArray()");
@@ -33,6 +70,10 @@ SolutionArray::SolutionArray()
     time = 0.0;
     adaptiveSteps = 0;
     adaptiveError = 100.0;
+
+    m_layout = NULL;
+    m_storage = NULL;
+    m_offset = 0;
 }
 
 SolutionArray::~SolutionArray()
@@ -45,11 +86,100 @@ SolutionArray::~SolutionArray()
         sln = NULL;
     }
 
-    if (order)
+    if (m_layout)
+    {
+        // order is shared
+        if (--m_layout->references == 0)
+            delete m_layout;
+        m_layout = NULL;
+    }
+    else if (order)
     {
         delete order;
         order = NULL;
     }
+
+    if (m_storage)
+    {
+        if (--m_storage->references == 0)
+            delete m_storage;
+        m_storage = NULL;
+    }
+}
+
+void SolutionArray::setLayout(SolutionLayout *layout, Solution *sln)
+{
+    logMessage("SolutionArray::setLayout()");
+
+    m_layout = layout;
+    m_layout->references++;
+    order = m_layout->order;
+
+    m_coefs.resize(sln->get_num_coefs());
+    memcpy(m_coefs.data(), sln->get_mono_coefs(), sizeof(double) * m_coefs.count());
+}
+
+void SolutionArray::setLayout(SolutionLayout *layout, const QVector<double> &coefs)
+{
+    logMessage("SolutionArray::setLayout()");
+
+    m_layout = layout;
+    m_layout->references++;
+    order = m_layout->order;
+
+    m_coefs = coefs;
+}
+
+void SolutionArray::setStorage(SolutionStorage *storage, qint64 offset)
+{
+    logMessage("SolutionArray::setStorage()");
+
+    m_storage = storage;
+    m_storage->references++;
+    m_offset = offset;
+}
+
+Solution *SolutionArray::solution()
+{
+    if (!sln && m_storage)
+    {
+        SolutionLayout *layout = NULL;
+        if (!m_storage->restore(m_offset, &sln, &order, &layout))
+            return NULL;
+
+        // layout is kept for the next restore
+        if (layout && !m_layout)
+        {
+            m_layout = layout;
+            m_layout->references++;
+        }
+    }
+    else if (!sln && m_layout)
+    {
+        sln = new Solution();
+        sln->copy(m_layout->sln, false);
+        sln->set_mono_coefs(m_coefs.data());
+    }
+
+    return sln;
+}
+
+void SolutionArray::release()
+{
+    logTrace("SolutionArray::release()");
+
+    if (sln && (m_layout || m_storage))
+    {
+        delete sln;
+        sln = NULL;
+
+        // order of the stored solution is read again with the solution
+        if (m_storage && !m_layout)
+        {
+            delete order;
+            order = NULL;
+        }
+    }
 }
 
 void SolutionArray::load(QDomElement *element)
@@ -82,37 +212,6 @@ void SolutionArray::load(QDomElement *element)
     QFile::remove(fileNameOrder);
 }
 
-void SolutionArray::save(QDomDocument *doc, QDomElement *element)
-{
-    logMessage("SolutionArray::save()");
-
-    // solution
-    QString fileNameSolution = tempProblemFileName() + ".sln";
-    sln->save(fileNameSolution.toStdString().c_str(), false);
-    QDomText textSolution = doc->createTextNode(readFileContentByteArray(fileNameSolution).toBase64());
-
-    // order
-    QString fileNameOrder = tempProblemFileName() + ".ord";
-    order->save_data(fileNameOrder.toStdString().c_str());
-    QDomNode textOrder = doc->createTextNode(readFileContentByteArray(fileNameOrder).toBase64());
-
-    QDomNode eleSolution = doc->createElement("sln");
-    QDomNode eleOrder = doc->createElement("order");
-
-    eleSolution.appendChild(textSolution);
-    eleOrder.appendChild(textOrder);
-
-    element->setAttribute("adaptiveerror", adaptiveError);
-    element->setAttribute("adaptivesteps", adaptiveSteps);
-    element->setAttribute("time", time);
-    element->appendChild(eleSolution);
-    element->appendChild(eleOrder);
-
-    // delete
-    QFile::remove(fileNameSolution);
-    QFile::remove(fileNameOrder);
-}
-
 // *********************************************************************************************
 
 ProgressItem::ProgressItem()
@@ -169,6 +268,25 @@ void ProgressItemMesh::mesh()
 
     QFile::remove(tempProblemFileName() + ".mesh");
 
+    if (!prepareTriangleInput())
+    {
+        m_isError = true;
+        return;
+    }
+
+#ifdef WITH_TRIANGLE
+    // Triangle linked as a library
+    if (triangulateInProcess())
+    {
+        emit message(tr("Mesh was created"), false, 2);
+
+        createMesh();
+    }
+    else
+    {
+        m_isError = true;
+    }
+#else
     // create triangle files
     if (writeToTriangle())
     {
@@ -216,6 +334,7 @@ void ProgressItemMesh::mesh()
     {
         m_isError = true;
     }
+#endif
 }
 
 void ProgressItemMesh::meshTriangleCreated(int exitCode)
@@ -226,18 +345,9 @@ void ProgressItemMesh::meshTriangleCreated(int exitCode)
     {
         emit message(tr("Mesh files were created"), false, 2);
 
-        // convert triangle mesh to hermes mesh
-        if (triangleToHermes2D())
+        if (readTriangleOutput())
         {
-            emit message(tr("Mesh was converted to Hermes2D mesh file"), false, 3);
-
-            // copy triangle files
-            if ((!Util::config()->deleteHermes2DMeshFile) && (!Util::scene()->problemInfo()->fileName.isEmpty()))
-            {
-                QFileInfo fileInfoOrig(Util::scene()->problemInfo()->fileName);
-
-                QFile::copy(tempProblemFileName() + ".mesh", fileInfoOrig.absolutePath() + "/" + fileInfoOrig.baseName() + ".mesh");
-            }
+            createMesh();
 
             //  remove triangle temp files
             QFile::remove(tempProblemFileName() + ".poly");
@@ -248,63 +358,88 @@ void ProgressItemMesh::meshTriangleCreated(int exitCode)
             QFile::remove(tempProblemFileName() + ".triangle.out");
             QFile::remove(tempProblemFileName() + ".triangle.err");
             emit message(tr("Mesh files were deleted"), false, 4);
+        }
+        else
+        {
+            m_isError = true;
+        }
+    }
+    else
+    {
+        m_isError = true;
+        QString errorMessage = readFileContent(Util::scene()->problemInfo()->fileName + ".triangle.out");
+        emit message(errorMessage, true, 0);
+    }
+}
 
-            // load mesh
-            Mesh *mesh = readMeshFromFile(tempProblemFileName() + ".mesh");
+void ProgressItemMesh::createMesh()
+{
+    logMessage("ProgressItemMesh::createMesh()");
 
-            // check that all boundary edges have a marker assigned
-            QSet<int> boundaries;
-            for (int i = 0; i < mesh->get_max_node_id(); i++)
-            {
-                Node *node = mesh->get_node(i);
+    // convert triangle mesh to hermes mesh
+    Mesh *mesh = new Mesh();
+    if (!triangleToHermes2D(mesh))
+    {
+        delete mesh;
 
-                if ((node->used == 1 && node->ref < 2 && node->type == 1)) //&&
-                {
-                    int marker = (node->bnd == 1) ?
-                                atoi(mesh->get_boundary_markers_conversion().get_user_marker(node->marker).c_str()) - 1 :
-                                - atoi(mesh->get_boundary_markers_conversion().get_user_marker(node->marker).c_str()) - 1;
+        m_isError = true;
+        QFile::remove(Util::scene()->problemInfo()->fileName + ".mesh");
+        return;
+    }
 
-                    if (Util::scene()->edges[marker]->boundary == Util::scene()->boundaries[0])
-                        boundaries.insert(marker);
-                }
-            }
+    emit message(tr("Mesh was converted to Hermes2D mesh file"), false, 3);
 
-            if (boundaries.count() > 0)
-            {
-                QString markers;
-                foreach (int marker, boundaries)
-                    markers += QString::number(marker) + ", ";
-                markers = markers.left(markers.length() - 2);
+    // mesh file for the export and the scripts, the solver copies the initial mesh
+    writeMeshFromFile(tempProblemFileName() + ".mesh", mesh);
 
-                emit message(tr("Boundary edges '%1' does not have a boundary marker").arg(markers), true, 0);
+    // copy hermes mesh file
+    if ((!Util::config()->deleteHermes2DMeshFile) && (!Util::scene()->problemInfo()->fileName.isEmpty()))
+    {
+        QFileInfo fileInfoOrig(Util::scene()->problemInfo()->fileName);
 
-                delete mesh;
-                m_isError = true;
-                return;
-            }
-            boundaries.clear();
+        QFile::copy(tempProblemFileName() + ".mesh", fileInfoOrig.absolutePath() + "/" + fileInfoOrig.baseName() + ".mesh");
+    }
 
-            refineMesh(mesh, true, true);
+    // check that all boundary edges have a marker assigned
+    QSet<int> boundaries;
+    for (int i = 0; i < mesh->get_max_node_id(); i++)
+    {
+        Node *node = mesh->get_node(i);
 
-            Util::scene()->sceneSolution()->setMeshInitial(mesh);
-        }
-        else
+        if ((node->used == 1 && node->ref < 2 && node->type == 1)) //&&
         {
-            m_isError = true;
-            QFile::remove(Util::scene()->problemInfo()->fileName + ".mesh");
+            int marker = (node->bnd == 1) ?
+                        atoi(mesh->get_boundary_markers_conversion().get_user_marker(node->marker).c_str()) - 1 :
+                        - atoi(mesh->get_boundary_markers_conversion().get_user_marker(node->marker).c_str()) - 1;
+
+            if (Util::scene()->edges[marker]->boundary == Util::scene()->boundaries[0])
+                boundaries.insert(marker);
         }
     }
-    else
+
+    if (boundaries.count() > 0)
     {
+        QString markers;
+        foreach (int marker, boundaries)
+            markers += QString::number(marker) + ", ";
+        markers = markers.left(markers.length() - 2);
+
+        emit message(tr("Boundary edges '%1' does not have a boundary marker").arg(markers), true, 0);
+
+        delete mesh;
         m_isError = true;
-        QString errorMessage = readFileContent(Util::scene()->problemInfo()->fileName + ".triangle.out");
-        emit message(errorMessage, true, 0);
+        return;
     }
+    boundaries.clear();
+
+    refineMesh(mesh, true, true);
+
+    Util::scene()->sceneSolution()->setMeshInitial(mesh);
 }
 
-bool ProgressItemMesh::writeToTriangle()
+bool ProgressItemMesh::prepareTriangleInput()
 {
-    logMessage("ProgressItemMesh::writeToTriangle()");
+    logMessage("ProgressItemMesh::prepareTriangleInput()");
 
     // basic check
     if (Util::scene()->nodes.count() < 3)
@@ -361,49 +496,24 @@ bool ProgressItemMesh::writeToTriangle()
         return false;
     }
 
-    // save current locale
-    char *plocale = setlocale (LC_NUMERIC, "");
-    setlocale (LC_NUMERIC, "C");
-
-    QDir dir;
-    dir.mkdir(QDir::temp().absolutePath() + "/agros2d");
-    QFile file(tempProblemFileName() + ".poly");
-
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        emit message(tr("Could not create Triangle poly mesh file (%1)").arg(file.errorString()), true, 0);
-        return false;
-    }
-    QTextStream out(&file);
-
+    m_polyNodes.clear();
+    m_polyEdges.clear();
+    m_polyHoles.clear();
+    m_polyLabels.clear();
 
     // nodes
-    QString outNodes;
-    int nodesCount = 0;
     for (int i = 0; i<Util::scene()->nodes.count(); i++)
-    {
-        outNodes += QString("%1  %2  %3  %4\n").
-                arg(i).
-                arg(Util::scene()->nodes[i]->point.x, 0, 'f', 10).
-                arg(Util::scene()->nodes[i]->point.y, 0, 'f', 10).
-                arg(0);
-        nodesCount++;
-    }
+        m_polyNodes.append(Util::scene()->nodes[i]->point);
 
     // edges
-    QString outEdges;
-    int edgesCount = 0;
     for (int i = 0; i<Util::scene()->edges.count(); i++)
     {
         if (Util::scene()->edges[i]->angle == 0)
         {
             // line
-            outEdges += QString("%1  %2  %3  %4\n").
-                    arg(edgesCount).
-                    arg(Util::scene()->nodes.indexOf(Util::scene()->edges[i]->nodeStart)).
-                    arg(Util::scene()->nodes.indexOf(Util::scene()->edges[i]->nodeEnd)).
-                    arg(i+1);
-            edgesCount++;
+            m_polyEdges.append(MeshEdge(Util::scene()->nodes.indexOf(Util::scene()->edges[i]->nodeStart),
+                                        Util::scene()->nodes.indexOf(Util::scene()->edges[i]->nodeEnd),
+                                        i+1));
         }
         else
         {
@@ -426,11 +536,11 @@ bool ProgressItemMesh::writeToTriangle()
                 double x = radius * cos(arc);
                 double y = radius * sin(arc);
 
-                nodeEndIndex = nodesCount+1;
+                nodeEndIndex = m_polyNodes.count()+1;
                 if (j == 0)
                 {
                     nodeStartIndex = Util::scene()->nodes.indexOf(Util::scene()->edges[i]->nodeStart);
-                    nodeEndIndex = nodesCount;
+                    nodeEndIndex = m_polyNodes.count();
                 }
                 if (j == segments - 1)
                 {
@@ -438,66 +548,89 @@ bool ProgressItemMesh::writeToTriangle()
                 }
                 if ((j > 0) && (j < segments))
                 {
-                    outNodes += QString("%1  %2  %3  %4\n").
-                            arg(nodesCount).
-                            arg(center.x + x, 0, 'f', 10).
-                            arg(center.y + y, 0, 'f', 10).
-                            arg(0);
-                    nodesCount++;
+                    m_polyNodes.append(Point(center.x + x, center.y + y));
                 }
-                outEdges += QString("%1  %2  %3  %4\n").
-                        arg(edgesCount).
-                        arg(nodeStartIndex).
-                        arg(nodeEndIndex).
-                        arg(i+1);
-                edgesCount++;
+                m_polyEdges.append(MeshEdge(nodeStartIndex, nodeEndIndex, i+1));
                 nodeStartIndex = nodeEndIndex;
             }
         }
     }
 
-    // holes
-    int holesCount = 0;
-    for (int i = 0; i<Util::scene()->labels.count(); i++) if (Util::scene()->materials.indexOf(Util::scene()->labels[i]->material) == 0) holesCount++;
-    QString outHoles = QString("%1\n").arg(holesCount);
+    // holes and labels
     for (int i = 0; i<Util::scene()->labels.count(); i++)
     {
         if (Util::scene()->materials.indexOf(Util::scene()->labels[i]->material) == 0)
-        {
-            outHoles += QString("%1  %2  %3\n").
-                    arg(i).
-                    arg(Util::scene()->labels[i]->point.x, 0, 'f', 10).
-                    arg(Util::scene()->labels[i]->point.y, 0, 'f', 10);
-        }
+            m_polyHoles.append(Util::scene()->labels[i]->point);
+        else
+            // triangle returns zero region number for areas without marker, markers must start from 1
+            m_polyLabels.append(MeshLabel(Util::scene()->labels[i]->point, i + 1, Util::scene()->labels[i]->area));
     }
 
-    // labels
-    QString outLabels;
-    int labelsCount = 0;
-    for(int i = 0; i<Util::scene()->labels.count(); i++)
+    return true;
+}
+
+bool ProgressItemMesh::writeToTriangle()
+{
+    logMessage("ProgressItemMesh::writeToTriangle()");
+
+    // save current locale
+    char *plocale = setlocale (LC_NUMERIC, "");
+    setlocale (LC_NUMERIC, "C");
+
+    QDir dir;
+    dir.mkdir(QDir::temp().absolutePath() + "/agros2d");
+    QFile file(tempProblemFileName() + ".poly");
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
     {
-        if (Util::scene()->materials.indexOf(Util::scene()->labels[i]->material) > 0)
-        {
-            outLabels += QString("%1  %2  %3  %4  %5\n").
-                    arg(labelsCount).
-                    arg(Util::scene()->labels[i]->point.x, 0, 'f', 10).
-                    arg(Util::scene()->labels[i]->point.y, 0, 'f', 10).
-                    arg(i + 1). // triangle returns zero region number for areas without marker, markers must start from 1
-                    arg(Util::scene()->labels[i]->area);
-            labelsCount++;
-        }
+        emit message(tr("Could not create Triangle poly mesh file (%1)").arg(file.errorString()), true, 0);
+        return false;
     }
+    QTextStream out(&file);
 
-    outNodes.insert(0, QString("%1 2 0 1\n").
-                    arg(nodesCount)); // + additional Util::scene()->nodes
-    out << outNodes;
-    outEdges.insert(0, QString("%1 1\n").
-                    arg(edgesCount)); // + additional edges
-    out << outEdges;
-    out << outHoles;
-    outLabels.insert(0, QString("%1 1\n").
-                     arg(labelsCount)); // - holes
-    out << outLabels;
+    // nodes
+    out << QString("%1 2 0 1\n").arg(m_polyNodes.count());
+    for (int i = 0; i<m_polyNodes.count(); i++)
+    {
+        out << QString("%1  %2  %3  %4\n").
+               arg(i).
+               arg(m_polyNodes[i].x, 0, 'f', 10).
+               arg(m_polyNodes[i].y, 0, 'f', 10).
+               arg(0);
+    }
+
+    // edges
+    out << QString("%1 1\n").arg(m_polyEdges.count());
+    for (int i = 0; i<m_polyEdges.count(); i++)
+    {
+        out << QString("%1  %2  %3  %4\n").
+               arg(i).
+               arg(m_polyEdges[i].node[0]).
+               arg(m_polyEdges[i].node[1]).
+               arg(m_polyEdges[i].marker);
+    }
+
+    // holes
+    out << QString("%1\n").arg(m_polyHoles.count());
+    for (int i = 0; i<m_polyHoles.count(); i++)
+    {
+        out << QString("%1  %2  %3\n").
+               arg(i).
+               arg(m_polyHoles[i].x, 0, 'f', 10).
+               arg(m_polyHoles[i].y, 0, 'f', 10);
+    }
+
+    // labels
+    out << QString("%1 1\n").arg(m_polyLabels.count());
+    for (int i = 0; i<m_polyLabels.count(); i++)
+    {
+        out << QString("%1  %2  %3  %4  %5\n").
+               arg(i).
+               arg(m_polyLabels[i].point.x, 0, 'f', 10).
+               arg(m_polyLabels[i].point.y, 0, 'f', 10).
+               arg(m_polyLabels[i].marker).
+               arg(m_polyLabels[i].area);
+    }
 
     file.waitForBytesWritten(0);
     file.close();
@@ -508,24 +641,12 @@ bool ProgressItemMesh::writeToTriangle()
     return true;
 }
 
-bool ProgressItemMesh::triangleToHermes2D()
+bool ProgressItemMesh::readTriangleOutput()
 {
-    logMessage("ProgressItemMesh::triangleToHermes2D()");
+    logMessage("ProgressItemMesh::readTriangleOutput()");
 
     int n, k;
 
-    // save current locale
-    char *plocale = setlocale (LC_NUMERIC, "");
-    setlocale (LC_NUMERIC, "C");
-
-    QFile fileMesh(tempProblemFileName() + ".mesh");
-    if (!fileMesh.open(QIODevice::WriteOnly))
-    {
-        emit message(tr("Could not create Hermes2D mesh file"), true, 0);
-        return false;
-    }
-    QTextStream outMesh(&fileMesh);
-
     QFile fileNode(tempProblemFileName() + ".node");
     if (!fileNode.open(QIODevice::ReadOnly | QIODevice::Text))
     {
@@ -558,46 +679,83 @@ bool ProgressItemMesh::triangleToHermes2D()
     }
     QTextStream inNeigh(&fileNeigh);
 
+    // save current locale
+    char *plocale = setlocale (LC_NUMERIC, "");
+    setlocale (LC_NUMERIC, "C");
+
+    m_triangleNodes.clear();
+    m_triangleEdges.clear();
+    m_triangleElements.clear();
+
     // triangle nodes
     sscanf(inNode.readLine().toStdString().c_str(), "%i", &k);
-    QList<Point> nodeList;
     for (int i = 0; i<k; i++)
     {
         int marker;
         double x, y;
 
         sscanf(inNode.readLine().toStdString().c_str(), "%i   %lf %lf %i", &n, &x, &y, &marker);
-        nodeList.append(Point(x, y));
+        m_triangleNodes.append(Point(x, y));
     }
 
     // triangle edges
     sscanf(inEdge.readLine().toStdString().c_str(), "%i", &k);
-    QList<MeshEdge> edgeList;
-    QSet<int> edgeMarkersCheck;
     for (int i = 0; i<k; i++)
     {
         int node[2];
         int marker;
 
         sscanf(inEdge.readLine().toStdString().c_str(), "%i	%i	%i	%i", &n, &node[0], &node[1], &marker);
-        edgeList.append(MeshEdge(node[0], node[1], marker));
+        m_triangleEdges.append(MeshEdge(node[0], node[1], marker));
     }
-    int edgeCountLinear = edgeList.count();
 
-    // check for multiple edge markers
-    for (int i = 0; i<Util::scene()->edges.count(); i++)
+    // triangle elements
+    sscanf(inEle.readLine().toStdString().c_str(), "%i", &k);
+    for (int i = 0; i < k; i++)
     {
-        if (Util::scene()->boundaries.indexOf(Util::scene()->edges[i]->boundary) > 0)
-        {
-            if (!edgeMarkersCheck.contains(i))
-            {
-                // emit message(tr("Edge marker '%1' is not present in mesh file.").
-                //              arg(i), true, 0);
-                // return false;
-            }
-        }
+        TriangleElement element;
+
+        sscanf(inEle.readLine().toStdString().c_str(), "%i	%i	%i	%i	%i	%i	%i	%i",
+               &n, &element.node[0], &element.node[1], &element.node[2], &element.node[3], &element.node[4], &element.node[5], &element.marker);
+        element.neigh[0] = element.neigh[1] = element.neigh[2] = -1;
+
+        m_triangleElements.append(element);
+    }
+
+    // triangle neigh
+    sscanf(inNeigh.readLine().toStdString().c_str(), "%i", &k);
+    for (int i = 0; i < k && i < m_triangleElements.count(); i++)
+    {
+        int ele_1, ele_2, ele_3;
+
+        sscanf(inNeigh.readLine().toStdString().c_str(), "%i	%i	%i	%i", &n, &ele_1, &ele_2, &ele_3);
+        m_triangleElements[i].neigh[0] = ele_1;
+        m_triangleElements[i].neigh[1] = ele_2;
+        m_triangleElements[i].neigh[2] = ele_3;
     }
-    edgeMarkersCheck.clear();
+
+    fileNode.close();
+    fileEdge.close();
+    fileEle.close();
+    fileNeigh.close();
+
+    // set system locale
+    setlocale(LC_NUMERIC, plocale);
+
+    return true;
+}
+
+bool ProgressItemMesh::triangleToHermes2D(Mesh *mesh)
+{
+    logMessage("ProgressItemMesh::triangleToHermes2D()");
+
+    // triangle nodes
+    QVector<Point> nodeList = m_triangleNodes.toVector();
+
+    // triangle edges
+    QVector<MeshEdge> edgeList = m_triangleEdges.toVector();
+    int edgeCountLinear = edgeList.count();
+
     // no edge marker
     if (edgeCountLinear < 1)
     {
@@ -606,33 +764,38 @@ bool ProgressItemMesh::triangleToHermes2D()
     }
 
     // triangle elements
-    sscanf(inEle.readLine().toStdString().c_str(), "%i", &k);
-    QList<MeshElement> elementList;
+    QVector<MeshElement> elementList;
+    if (Util::scene()->problemInfo()->meshType == MeshType_QuadFineDivision)
+    {
+        nodeList.reserve(nodeList.count() + m_triangleElements.count());
+        edgeList.reserve(2 * edgeList.count());
+        elementList.reserve(3 * m_triangleElements.count());
+    }
+    else
+    {
+        elementList.reserve(m_triangleElements.count());
+    }
     QSet<int> labelMarkersCheck;
-    for (int i = 0; i < k; i++)
+    for (int i = 0; i < m_triangleElements.count(); i++)
     {
-        int node[6];
-        int marker;
-
-        sscanf(inEle.readLine().toStdString().c_str(), "%i	%i	%i	%i	%i	%i	%i	%i",
-               &n, &node[0], &node[1], &node[2], &node[3], &node[4], &node[5], &marker);
+        const TriangleElement &element = m_triangleElements[i];
 
         if (Util::scene()->problemInfo()->meshType == MeshType_Triangle ||
                 Util::scene()->problemInfo()->meshType == MeshType_QuadJoin ||
                 Util::scene()->problemInfo()->meshType == MeshType_QuadRoughDivision)
         {
-            elementList.append(MeshElement(node[0], node[1], node[2], marker));
+            elementList.append(MeshElement(element.node[0], element.node[1], element.node[2], element.marker));
         }
 
         if (Util::scene()->problemInfo()->meshType == MeshType_QuadFineDivision)
         {
             // add additional node
-            nodeList.append(Point((nodeList[node[0]].x + nodeList[node[1]].x + nodeList[node[2]].x) / 3.0,
-                                  (nodeList[node[0]].y + nodeList[node[1]].y + nodeList[node[2]].y) / 3.0));
+            nodeList.append(Point((nodeList[element.node[0]].x + nodeList[element.node[1]].x + nodeList[element.node[2]].x) / 3.0,
+                                  (nodeList[element.node[0]].y + nodeList[element.node[1]].y + nodeList[element.node[2]].y) / 3.0));
             // add three quad elements
-            elementList.append(MeshElement(node[4], node[0], node[5], nodeList.count() - 1, marker));
-            elementList.append(MeshElement(node[5], node[1], node[3], nodeList.count() - 1, marker));
-            elementList.append(MeshElement(node[3], node[2], node[4], nodeList.count() - 1, marker));
+            elementList.append(MeshElement(element.node[4], element.node[0], element.node[5], nodeList.count() - 1, element.marker));
+            elementList.append(MeshElement(element.node[5], element.node[1], element.node[3], nodeList.count() - 1, element.marker));
+            elementList.append(MeshElement(element.node[3], element.node[2], element.node[4], nodeList.count() - 1, element.marker));
         }
 
         if (elementList[i].marker == 0)
@@ -641,7 +804,7 @@ bool ProgressItemMesh::triangleToHermes2D()
             return false;
         }
 
-        labelMarkersCheck.insert(marker);
+        labelMarkersCheck.insert(element.marker);
     }
     int elementCountLinear = elementList.count();
 
@@ -668,40 +831,54 @@ bool ProgressItemMesh::triangleToHermes2D()
     }
 
     // triangle neigh
-    sscanf(inNeigh.readLine().toStdString().c_str(), "%i", &k);
-    for (int i = 0; i < k; i++)
+    for (int i = 0; i < m_triangleElements.count() && i < elementList.count(); i++)
     {
-        int ele_1, ele_2, ele_3;
-
-        sscanf(inNeigh.readLine().toStdString().c_str(), "%i	%i	%i	%i", &n, &ele_1, &ele_2, &ele_3);
-        elementList[i].neigh[0] = ele_1;
-        elementList[i].neigh[1] = ele_2;
-        elementList[i].neigh[2] = ele_3;
+        elementList[i].neigh[0] = m_triangleElements[i].neigh[0];
+        elementList[i].neigh[1] = m_triangleElements[i].neigh[1];
+        elementList[i].neigh[2] = m_triangleElements[i].neigh[2];
     }
 
     // heterogeneous mesh
     // element division
     if (Util::scene()->problemInfo()->meshType == MeshType_QuadFineDivision)
     {
+        // midpoint of the oriented triangle edge (corners of the triangle are node[1] of its three quads)
+        QHash<QPair<int, int>, int> edgeMidpoints;
+        edgeMidpoints.reserve(elementList.count());
+        for (int j = 0; j < elementList.count() / 3; j++)
+            for (int k = 0; k < 3; k++)
+                edgeMidpoints.insert(qMakePair(elementList[3*j + k].node[1], elementList[3*j + (k + 1) % 3].node[1]),
+                                     elementList[3*j + (k + 1) % 3].node[0]);
+
         for (int i = 0; i < edgeCountLinear; i++)
         {
             if (edgeList[i].marker != 0)
             {
-                for (int j = 0; j < elementList.count() / 3; j++)
+                QHash<QPair<int, int>, int>::const_iterator it = edgeMidpoints.constFind(qMakePair(edgeList[i].node[0], edgeList[i].node[1]));
+                if (it != edgeMidpoints.constEnd())
                 {
-                    for (int k = 0; k < 3; k++)
-                    {
-                        if (edgeList[i].node[0] == elementList[3*j + k].node[1] && edgeList[i].node[1] == elementList[3*j + (k + 1) % 3].node[1])
-                        {
-                            edgeList.append(MeshEdge(edgeList[i].node[0], elementList[3*j + (k + 1) % 3].node[0], edgeList[i].marker));
-                            edgeList[i].node[0] = elementList[3*j + (k + 1) % 3].node[0];
-                        }
-                    }
+                    edgeList.append(MeshEdge(edgeList[i].node[0], it.value(), edgeList[i].marker));
+                    edgeList[i].node[0] = it.value();
                 }
             }
         }
     }
 
+    // oriented triangle edges, value is 3 * element + local edge (from node[k] to node[k + 1])
+    // the neighbour across the edge from a to b owns the edge from b to a
+    QHash<QPair<int, int>, int> triangleEdges;
+    if (Util::scene()->problemInfo()->meshType == MeshType_QuadRoughDivision ||
+            Util::scene()->problemInfo()->meshType == MeshType_QuadJoin)
+    {
+        triangleEdges.reserve(3 * elementCountLinear);
+        for (int i = 0; i < elementCountLinear; i++)
+            for (int k = 0; k < 3; k++)
+                triangleEdges.insert(qMakePair(elementList[i].node[k], elementList[i].node[(k + 1) % 3]), 3*i + k);
+
+        elementList.reserve(elementCountLinear + elementCountLinear / 4 * 3);
+        nodeList.reserve(nodeList.count() + elementCountLinear / 4);
+    }
+
     if (Util::scene()->problemInfo()->meshType == MeshType_QuadRoughDivision)
     {
         for (int i = 0; i < elementCountLinear; i++)
@@ -724,14 +901,18 @@ bool ProgressItemMesh::triangleToHermes2D()
 
                 // add three quad elements
                 for (int nd = 0; nd < 3; nd++)
-                    for (int neigh = 0; neigh < 3; neigh++)
-                        for (int neigh_nd = 0; neigh_nd < 3; neigh_nd++)
-                            if ((elementList[i].node[(nd + 0) % 3] == elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 1) % 3]) &&
-                                    (elementList[i].node[(nd + 1) % 3] == elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 0) % 3]))
-                                elementList.append(MeshElement(elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 1) % 3],
-                                                               elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 2) % 3],
-                                                               elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 0) % 3],
-                                                               nodeList.count() - 1, elementList[i].marker));
+                {
+                    int edge = triangleEdges.value(qMakePair(elementList[i].node[(nd + 1) % 3], elementList[i].node[(nd + 0) % 3]), -1);
+                    if (edge == -1)
+                        continue;
+
+                    int neigh = edge / 3;
+                    int neigh_nd = edge % 3;
+                    elementList.append(MeshElement(elementList[neigh].node[(neigh_nd + 1) % 3],
+                                                   elementList[neigh].node[(neigh_nd + 2) % 3],
+                                                   elementList[neigh].node[(neigh_nd + 0) % 3],
+                                                   nodeList.count() - 1, elementList[i].marker));
+                }
 
                 elementList[i].isUsed = false;
                 elementList[i].isActive = false;
@@ -753,70 +934,71 @@ bool ProgressItemMesh::triangleToHermes2D()
             {
                 // add quad elements
                 for (int nd = 0; nd < 3; nd++)
-                    for (int neigh = 0; neigh < 3; neigh++)
-                        for (int neigh_nd = 0; neigh_nd < 3; neigh_nd++)
-                            if (elementList[i].isActive &&
-                                    elementList[i].neigh[neigh] != -1 &&
-                                    elementList[elementList[i].neigh[neigh]].isActive &&
-                                    elementList[i].marker == elementList[elementList[i].neigh[neigh]].marker)
-                                if ((elementList[i].node[(nd + 0) % 3] == elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 1) % 3]) &&
-                                        (elementList[i].node[(nd + 1) % 3] == elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 0) % 3]))
-                                {
-                                    int tmp_node[3];
-                                    for (int k = 0; k < 3; k++)
-                                        tmp_node[k] = elementList[i].node[k];
-
-                                    Point quad_check[4];
-                                    quad_check[0] = nodeList[tmp_node[(nd + 1) % 3]];
-                                    quad_check[1] = nodeList[tmp_node[(nd + 2) % 3]];
-                                    quad_check[2] = nodeList[tmp_node[(nd + 0) % 3]];
-                                    quad_check[3] = nodeList[elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 2) % 3]];
-
-                                    if ((!same_line(quad_check[0].x, quad_check[0].y, quad_check[1].x, quad_check[1].y, quad_check[2].x, quad_check[2].y)) &&
-                                            (!same_line(quad_check[0].x, quad_check[0].y, quad_check[1].x, quad_check[1].y, quad_check[3].x, quad_check[3].y)) &&
-                                            (!same_line(quad_check[0].x, quad_check[0].y, quad_check[2].x, quad_check[2].y, quad_check[3].x, quad_check[3].y)) &&
-                                            (!same_line(quad_check[1].x, quad_check[1].y, quad_check[2].x, quad_check[2].y, quad_check[3].x, quad_check[3].y)) &&
-                                            is_convex(quad_check[1].x - quad_check[0].x, quad_check[1].y - quad_check[0].y, quad_check[2].x - quad_check[0].x, quad_check[2].y - quad_check[0].y) &&
-                                            is_convex(quad_check[2].x - quad_check[0].x, quad_check[2].y - quad_check[0].y, quad_check[3].x - quad_check[0].x, quad_check[3].y - quad_check[0].y) &&
-                                            is_convex(quad_check[2].x - quad_check[1].x, quad_check[2].y - quad_check[1].y, quad_check[3].x - quad_check[1].x, quad_check[3].y - quad_check[1].y) &&
-                                            is_convex(quad_check[3].x - quad_check[1].x, quad_check[3].y - quad_check[1].y, quad_check[0].x - quad_check[1].x, quad_check[0].y - quad_check[1].y))
-                                    {
-                                        // regularity check
-                                        bool regular = true;
-                                        for (int k = 0; k < 4; k++)
-                                        {
-                                            double length_1 = (quad_check[k] - quad_check[(k + 1) % 4]).magnitude();
-                                            double length_2 = (quad_check[(k + 1) % 4] - quad_check[(k + 2) % 4]).magnitude();
-                                            double length_together = (quad_check[k] - quad_check[(k + 2) % 4]).magnitude();
-
-                                            if ((length_1 + length_2) / length_together < 1.03)
-                                                regular = false;
-                                        }
-
-                                        if (!regular)
-                                            break;
-
-                                        elementList[i].node[0] = tmp_node[(nd + 1) % 3];
-                                        elementList[i].node[1] = tmp_node[(nd + 2) % 3];
-                                        elementList[i].node[2] = tmp_node[(nd + 0) % 3];
-                                        elementList[i].node[3] = elementList[elementList[i].neigh[neigh]].node[(neigh_nd + 2) % 3];
-
-                                        elementList[i].isActive = false;
-
-                                        elementList[elementList[i].neigh[neigh]].isUsed = false;
-                                        elementList[elementList[i].neigh[neigh]].isActive = false;
-
-                                        break;
-                                    }
-                                }
+                {
+                    int edge = triangleEdges.value(qMakePair(elementList[i].node[(nd + 1) % 3], elementList[i].node[(nd + 0) % 3]), -1);
+                    if (edge == -1)
+                        continue;
+
+                    int neigh = edge / 3;
+                    int neigh_nd = edge % 3;
+                    if (elementList[neigh].isActive &&
+                            elementList[i].marker == elementList[neigh].marker)
+                    {
+                        int tmp_node[3];
+                        for (int k = 0; k < 3; k++)
+                            tmp_node[k] = elementList[i].node[k];
+
+                        Point quad_check[4];
+                        quad_check[0] = nodeList[tmp_node[(nd + 1) % 3]];
+                        quad_check[1] = nodeList[tmp_node[(nd + 2) % 3]];
+                        quad_check[2] = nodeList[tmp_node[(nd + 0) % 3]];
+                        quad_check[3] = nodeList[elementList[neigh].node[(neigh_nd + 2) % 3]];
+
+                        if ((!same_line(quad_check[0].x, quad_check[0].y, quad_check[1].x, quad_check[1].y, quad_check[2].x, quad_check[2].y)) &&
+                                (!same_line(quad_check[0].x, quad_check[0].y, quad_check[1].x, quad_check[1].y, quad_check[3].x, quad_check[3].y)) &&
+                                (!same_line(quad_check[0].x, quad_check[0].y, quad_check[2].x, quad_check[2].y, quad_check[3].x, quad_check[3].y)) &&
+                                (!same_line(quad_check[1].x, quad_check[1].y, quad_check[2].x, quad_check[2].y, quad_check[3].x, quad_check[3].y)) &&
+                                is_convex(quad_check[1].x - quad_check[0].x, quad_check[1].y - quad_check[0].y, quad_check[2].x - quad_check[0].x, quad_check[2].y - quad_check[0].y) &&
+                                is_convex(quad_check[2].x - quad_check[0].x, quad_check[2].y - quad_check[0].y, quad_check[3].x - quad_check[0].x, quad_check[3].y - quad_check[0].y) &&
+                                is_convex(quad_check[2].x - quad_check[1].x, quad_check[2].y - quad_check[1].y, quad_check[3].x - quad_check[1].x, quad_check[3].y - quad_check[1].y) &&
+                                is_convex(quad_check[3].x - quad_check[1].x, quad_check[3].y - quad_check[1].y, quad_check[0].x - quad_check[1].x, quad_check[0].y - quad_check[1].y))
+                        {
+                            // regularity check
+                            bool regular = true;
+                            for (int k = 0; k < 4; k++)
+                            {
+                                double length_1 = (quad_check[k] - quad_check[(k + 1) % 4]).magnitude();
+                                double length_2 = (quad_check[(k + 1) % 4] - quad_check[(k + 2) % 4]).magnitude();
+                                double length_together = (quad_check[k] - quad_check[(k + 2) % 4]).magnitude();
+
+                                if ((length_1 + length_2) / length_together < 1.03)
+                                    regular = false;
+                            }
+
+                            if (!regular)
+                                continue;
+
+                            elementList[i].node[0] = tmp_node[(nd + 1) % 3];
+                            elementList[i].node[1] = tmp_node[(nd + 2) % 3];
+                            elementList[i].node[2] = tmp_node[(nd + 0) % 3];
+                            elementList[i].node[3] = elementList[neigh].node[(neigh_nd + 2) % 3];
+
+                            elementList[i].isActive = false;
+
+                            elementList[neigh].isUsed = false;
+                            elementList[neigh].isActive = false;
+
+                            break;
+                        }
+                    }
+                }
             }
         }
     }
 
+    MeshData meshData("");
+
     // edges
-    QString outEdges;
-    outEdges += "boundaries = [\n";
-    int countEdges = 0;
     for (int i = 0; i < edgeList.count(); i++)
     {
         if (edgeList[i].isUsed && edgeList[i].marker != 0)
@@ -829,22 +1011,15 @@ bool ProgressItemMesh::triangleToHermes2D()
                 // inner edge marker (minus markers are ignored)
                 marker = - (edgeList[i].marker);
 
-            countEdges++;
-            outEdges += QString("  [ %1, %2, \"%3\" ],\n").
-                    arg(edgeList[i].node[0]).
-                    arg(edgeList[i].node[1]).
-                    arg(marker);
+            meshData.bdy_first.push_back(edgeList[i].node[0]);
+            meshData.bdy_second.push_back(edgeList[i].node[1]);
+            meshData.bdy_type.push_back(QString::number(marker).toStdString());
         }
     }
-    outEdges.truncate(outEdges.length()-2);
-    outEdges += "\n]\n\n";
 
     // curves
-    QString outCurves;
-    int countCurves = 0;
     if (Util::config()->curvilinearElements)
     {
-        outCurves += "curves = [\n";
         for (int i = 0; i<edgeList.count(); i++)
         {
             if (edgeList[i].marker != 0)
@@ -852,7 +1027,6 @@ bool ProgressItemMesh::triangleToHermes2D()
                 // curve
                 if (Util::scene()->edges[edgeList[i].marker-1]->angle > 0.0)
                 {
-                    countCurves++;
                     int segments = Util::scene()->edges[edgeList[i].marker-1]->segments();
 
                     // subdivision angle and chord
@@ -869,15 +1043,15 @@ bool ProgressItemMesh::triangleToHermes2D()
 
                     double angle = direction * theta * chordShort / chord;
 
-                    outCurves += QString("  [ %1, %2, %3 ],\n").
-                            arg(edgeList[i].node[0]).
-                            arg(edgeList[i].node[1]).
-                            arg(rad2deg(angle));
+                    meshData.curv_first.push_back(edgeList[i].node[0]);
+                    meshData.curv_second.push_back(edgeList[i].node[1]);
+                    meshData.curv_third.push_back(rad2deg(angle));
+                    meshData.curv_inner_pts.push_back("none");
+                    meshData.curv_knots.push_back("none");
+                    meshData.curv_nurbs.push_back(false);
                 }
             }
         }
-        outCurves.truncate(outCurves.length()-2);
-        outCurves += "\n]\n\n";
 
         // move nodes (arcs)
         for (int i = 0; i<edgeList.count(); i++)
@@ -906,70 +1080,163 @@ bool ProgressItemMesh::triangleToHermes2D()
     }
 
     // nodes
-    QString outNodes;
-    outNodes += "vertices = [\n";
     for (int i = 0; i<nodeList.count(); i++)
     {
-        outNodes += QString("  [ %1,  %2 ],\n").
-                arg(nodeList[i].x, 0, 'f', 10).
-                arg(nodeList[i].y, 0, 'f', 10);
+        meshData.x_vertex.push_back(nodeList[i].x);
+        meshData.y_vertex.push_back(nodeList[i].y);
     }
-    outNodes.truncate(outNodes.length()-2);
-    outNodes += "\n]\n\n";
 
     // elements
-    QString outElements;
-    outElements += "elements = [\n";
     for (int i = 0; i < elementList.count(); i++)
     {
         if (elementList[i].isUsed)
         {
+            meshData.en1.push_back(elementList[i].node[0]);
+            meshData.en2.push_back(elementList[i].node[1]);
+            meshData.en3.push_back(elementList[i].node[2]);
+            meshData.en4.push_back(elementList[i].isTriangle() ? -1 : elementList[i].node[3]);
             // element returns zero region number for areas without marker, markers must start from 1
-            if (elementList[i].isTriangle())
-            {
-                outElements += QString("  [ %1, %2, %3, \"%4\" ],\n").
-                        arg(elementList[i].node[0]).
-                        arg(elementList[i].node[1]).
-                        arg(elementList[i].node[2]).
-                        arg(abs(elementList[i].marker) - 1);
-            }
-            else
-            {
-                outElements += QString("  [ %1, %2, %3, %4, \"%5\" ],\n").
-                        arg(elementList[i].node[0]).
-                        arg(elementList[i].node[1]).
-                        arg(elementList[i].node[2]).
-                        arg(elementList[i].node[3]).
-                        arg(abs(elementList[i].marker) - 1);
-            }
+            meshData.e_mtl.push_back(QString::number(abs(elementList[i].marker) - 1).toStdString());
         }
     }
-    outElements.truncate(outElements.length()-2);
-    outElements += "\n]\n\n";
 
-    outMesh << outNodes;
-    outMesh << outElements;
-    outMesh << outEdges;
-    if (countCurves > 0)
-        outMesh << outCurves;
+    meshData.n_vert = meshData.x_vertex.size();
+    meshData.n_el = meshData.en1.size();
+    meshData.n_bdy = meshData.bdy_first.size();
+    meshData.n_curv = meshData.curv_first.size();
+    meshData.n_ref = 0;
 
     nodeList.clear();
     edgeList.clear();
     elementList.clear();
 
-    fileNode.close();
-    fileEdge.close();
-    fileEle.close();
-    fileNeigh.close();
+    // build the mesh directly, without the text round trip through the mesh file
+    H2DReader meshloader;
+    if (!meshloader.load(&meshData, mesh))
+    {
+        emit message(tr("Could not create Hermes2D mesh"), true, 0);
+        return false;
+    }
 
-    fileMesh.waitForBytesWritten(0);
-    fileMesh.close();
+    return true;
+}
 
-    // set system locale
-    setlocale(LC_NUMERIC, plocale);
+#ifdef WITH_TRIANGLE
+bool ProgressItemMesh::triangulateInProcess()
+{
+    logMessage("ProgressItemMesh::triangulateInProcess()");
 
-    return true;
+    QVector<REAL> pointList(2 * m_polyNodes.count());
+    for (int i = 0; i < m_polyNodes.count(); i++)
+    {
+        pointList[2*i + 0] = m_polyNodes[i].x;
+        pointList[2*i + 1] = m_polyNodes[i].y;
+    }
+
+    QVector<int> segmentList(2 * m_polyEdges.count());
+    QVector<int> segmentMarkerList(m_polyEdges.count());
+    for (int i = 0; i < m_polyEdges.count(); i++)
+    {
+        segmentList[2*i + 0] = m_polyEdges[i].node[0];
+        segmentList[2*i + 1] = m_polyEdges[i].node[1];
+        segmentMarkerList[i] = m_polyEdges[i].marker;
+    }
+
+    QVector<REAL> holeList(2 * m_polyHoles.count());
+    for (int i = 0; i < m_polyHoles.count(); i++)
+    {
+        holeList[2*i + 0] = m_polyHoles[i].x;
+        holeList[2*i + 1] = m_polyHoles[i].y;
+    }
+
+    QVector<REAL> regionList(4 * m_polyLabels.count());
+    for (int i = 0; i < m_polyLabels.count(); i++)
+    {
+        regionList[4*i + 0] = m_polyLabels[i].point.x;
+        regionList[4*i + 1] = m_polyLabels[i].point.y;
+        regionList[4*i + 2] = m_polyLabels[i].marker;
+        regionList[4*i + 3] = m_polyLabels[i].area;
+    }
+
+    triangulateio in, out;
+    memset(&in, 0, sizeof(triangulateio));
+    memset(&out, 0, sizeof(triangulateio));
+
+    in.numberofpoints = m_polyNodes.count();
+    in.pointlist = pointList.data();
+    in.numberofsegments = m_polyEdges.count();
+    in.segmentlist = segmentList.data();
+    in.segmentmarkerlist = segmentMarkerList.data();
+    in.numberofholes = m_polyHoles.count();
+    in.holelist = holeList.data();
+    in.numberofregions = m_polyLabels.count();
+    in.regionlist = regionList.data();
+
+    QByteArray switches = TRIANGLE_SWITCHES.toAscii();
+
+    // fatal errors of Triangle come back here (see triexit()), the memory allocated by Triangle is lost
+    if (setjmp(triangleExit) != 0)
+    {
+        isTriangleRunning = false;
+
+        emit message(tr("Triangle could not create the mesh, check the geometry"), true, 0);
+        return false;
+    }
+
+    isTriangleRunning = true;
+    triangulate(switches.data(), &in, &out, NULL);
+    isTriangleRunning = false;
+
+    bool isCreated = true;
+    if (out.numberofcorners != 6 || !out.edgelist || !out.neighborlist || !out.triangleattributelist)
+    {
+        emit message(tr("Triangle did not produce second order elements with edges, neighbors and attributes"), true, 0);
+        isCreated = false;
+    }
+    else
+    {
+        m_triangleNodes.clear();
+        m_triangleEdges.clear();
+        m_triangleElements.clear();
+
+        // triangle nodes
+        for (int i = 0; i < out.numberofpoints; i++)
+            m_triangleNodes.append(Point(out.pointlist[2*i + 0], out.pointlist[2*i + 1]));
+
+        // triangle edges
+        for (int i = 0; i < out.numberofedges; i++)
+            m_triangleEdges.append(MeshEdge(out.edgelist[2*i + 0], out.edgelist[2*i + 1],
+                                            out.edgemarkerlist ? out.edgemarkerlist[i] : 0));
+
+        // triangle elements and neigh
+        for (int i = 0; i < out.numberoftriangles; i++)
+        {
+            TriangleElement element;
+            for (int j = 0; j < 6; j++)
+                element.node[j] = out.trianglelist[6*i + j];
+            element.marker = (int) out.triangleattributelist[out.numberoftriangleattributes * i];
+            for (int j = 0; j < 3; j++)
+                element.neigh[j] = out.neighborlist[3*i + j];
+
+            m_triangleElements.append(element);
+        }
+    }
+
+    // holes and regions are shared with the input
+    trifree(out.pointlist);
+    trifree(out.pointattributelist);
+    trifree(out.pointmarkerlist);
+    trifree(out.trianglelist);
+    trifree(out.triangleattributelist);
+    trifree(out.neighborlist);
+    trifree(out.segmentlist);
+    trifree(out.segmentmarkerlist);
+    trifree(out.edgelist);
+    trifree(out.edgemarkerlist);
+
+    return isCreated;
 }
+#endif
 
 // *********************************************************************************************
 
@@ -1047,6 +1314,7 @@ ProgressItemProcessView::ProgressItemProcessView() : ProgressItem()
     logMessage("ProgressItemProcessView::ProgressItemProcessView()");
 
     m_name = tr("View");
+    m_step = 0;
 }
 
 void ProgressItemProcessView::setSteps()
@@ -1066,9 +1334,25 @@ bool ProgressItemProcessView::run(bool quiet)
 {
     logMessage("ProgressItemProcessView::run()");
 
-    if (quiet) blockSignals(true);
+    SceneSolution *sceneSolution = Util::scene()->sceneSolution();
+
+    // the caches are swapped in later by the event loop, the progress is reported
+    // until the view is processed
+    m_step = 0;
+    disconnect(sceneSolution, 0, this, 0);
+    if (!quiet)
+    {
+        connect(sceneSolution, SIGNAL(processedSolutionMesh()), this, SLOT(processedSolutionMesh()));
+        connect(sceneSolution, SIGNAL(processedRangeContour()), this, SLOT(processedRangeContour()));
+        connect(sceneSolution, SIGNAL(processedRangeScalar()), this, SLOT(processedRangeScalar()));
+        connect(sceneSolution, SIGNAL(processedRangeVector()), this, SLOT(processedRangeVector()));
+        connect(sceneSolution, SIGNAL(processedView()), this, SLOT(processedView()));
+    }
+
     process();
-    if (quiet) blockSignals(false);
+
+    if (!sceneSolution->isProcessingView())
+        disconnect(sceneSolution, 0, this, 0);
 
     return !m_isError;
 }
@@ -1077,34 +1361,46 @@ void ProgressItemProcessView::process()
 {
     logMessage("ProgressItemProcessView::process()");
 
-    int step = 0;
+    SceneSolution *sceneSolution = Util::scene()->sceneSolution();
 
-    if (sceneView()->sceneViewSettings().showSolutionMesh)
-    {
-        step++;
-        emit message(tr("Processing solution mesh cache"), false, step);
-        Util::scene()->sceneSolution()->processSolutionMesh();
-    }
-    if (sceneView()->sceneViewSettings().showContours)
-    {
-        step++;
-        emit message(tr("Processing countour view cache"), false, step);
-        Util::scene()->sceneSolution()->processRangeContour();
-    }
-    if (sceneView()->sceneViewSettings().postprocessorShow == SceneViewPostprocessorShow_ScalarView ||
-            sceneView()->sceneViewSettings().postprocessorShow == SceneViewPostprocessorShow_ScalarView3D ||
-            sceneView()->sceneViewSettings().postprocessorShow == SceneViewPostprocessorShow_ScalarView3DSolid)
-    {
-        step++;
-        emit message(tr("Processing scalar view cache"), false, step);
-        Util::scene()->sceneSolution()->processRangeScalar();
-    }
-    if (sceneView()->sceneViewSettings().showVectors)
-    {
-        step++;
-        emit message(tr("Processing vector view cache"), false, step);
-        Util::scene()->sceneSolution()->processRangeVector();
-    }
+    bool solutionMesh = sceneView()->sceneViewSettings().showSolutionMesh;
+    bool contour = sceneView()->sceneViewSettings().showContours;
+    bool scalar = (sceneView()->sceneViewSettings().postprocessorShow == SceneViewPostprocessorShow_ScalarView ||
+                   sceneView()->sceneViewSettings().postprocessorShow == SceneViewPostprocessorShow_ScalarView3D ||
+                   sceneView()->sceneViewSettings().postprocessorShow == SceneViewPostprocessorShow_ScalarView3DSolid);
+    bool vector = sceneView()->sceneViewSettings().showVectors;
+
+    // caches are processed in worker threads, a running pass is cancelled
+    sceneSolution->startProcessView(solutionMesh, contour, scalar, vector);
+}
+
+void ProgressItemProcessView::processedSolutionMesh()
+{
+    m_step++;
+    emit message(tr("Solution mesh cache processed"), false, m_step);
+}
+
+void ProgressItemProcessView::processedRangeContour()
+{
+    m_step++;
+    emit message(tr("Contour view cache processed"), false, m_step);
+}
+
+void ProgressItemProcessView::processedRangeScalar()
+{
+    m_step++;
+    emit message(tr("Scalar view cache processed"), false, m_step);
+}
+
+void ProgressItemProcessView::processedRangeVector()
+{
+    m_step++;
+    emit message(tr("Vector view cache processed"), false, m_step);
+}
+
+void ProgressItemProcessView::processedView()
+{
+    disconnect(Util::scene()->sceneSolution(), 0, this, 0);
 }
 
 // ***********************************************************************************************
@@ -1447,6 +1743,22 @@ void ProgressDialog::start()
         }
     }
 
+    // view caches are swapped in by the event loop of the dialog
+    if (Util::scene()->sceneSolution()->isProcessingView())
+    {
+        connect(Util::scene()->sceneSolution(), SIGNAL(processedView()), this, SLOT(succeeded()));
+        return;
+    }
+
+    succeeded();
+}
+
+void ProgressDialog::succeeded()
+{
+    logMessage("ProgressDialog::succeeded()");
+
+    disconnect(Util::scene()->sceneSolution(), SIGNAL(processedView()), this, SLOT(succeeded()));
+
     // successfull run
     if (!Util::config()->showConvergenceChart ||
             Util::scene()->problemInfo()->adaptivityType == AdaptivityType_None ||
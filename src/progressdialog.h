@@ -29,8 +29,20 @@ class Orderizer;
 class Mesh;
 
 class Chart;
+class SolutionStorage;
 class QwtPlotCurve;
 
+// mesh, element orders and polynomial orders shared by the time steps solved in the same space
+struct SolutionLayout
+{
+    Solution *sln; // solution of the first time step, owns the mesh
+    Orderizer *order;
+    int references;
+
+    SolutionLayout(Solution *sln, Orderizer *order);
+    ~SolutionLayout();
+};
+
 struct SolutionArray
 {
     double time;
@@ -43,8 +55,31 @@ struct SolutionArray
     SolutionArray();
     ~SolutionArray();
 
+    // compact array keeps only the coefficients of the solution, the solution is
+    // restored on demand in solution() and can be dropped again by release()
+    void setLayout(SolutionLayout *layout, Solution *sln);
+    void setLayout(SolutionLayout *layout, const QVector<double> &coefs);
+    inline bool isCompact() const { return m_layout && !m_storage; }
+    // stored array is read from the solution file on demand in solution()
+    void setStorage(SolutionStorage *storage, qint64 offset);
+    inline bool isStored() const { return m_storage; }
+    inline SolutionStorage *storage() const { return m_storage; }
+    inline bool isRestorable() const { return m_layout || m_storage; }
+    inline bool hasSolution() const { return sln || m_layout || m_storage; }
+    inline SolutionLayout *layout() const { return m_layout; }
+    inline const QVector<double> &coefs() const { return m_coefs; }
+    Solution *solution();
+    void release();
+
+    // solution saved in base64 encoded xml (older documents)
     void load(QDomElement *element);
-    void save(QDomDocument *doc, QDomElement *element);
+
+private:
+    SolutionLayout *m_layout;
+    QVector<double> m_coefs;
+
+    SolutionStorage *m_storage;
+    qint64 m_offset;
 };
 
 class ProgressItem : public QObject
@@ -85,7 +120,7 @@ class ProgressItemMesh : public ProgressItem
 private slots:
     void meshTriangleCreated(int exitCode);
     bool writeToTriangle();
-    bool triangleToHermes2D();
+    bool triangleToHermes2D(Mesh *mesh);
 
 public:
     ProgressItemMesh();
@@ -169,6 +204,45 @@ private:
         int neigh[3];
     };
 
+    struct MeshLabel
+    {
+        MeshLabel(const Point &point, int marker, double area)
+        {
+            this->point = point;
+            this->marker = marker;
+            this->area = area;
+        }
+
+        Point point;
+        int marker;
+        double area;
+    };
+
+    // element of the Triangle output (second order, corners and midpoints)
+    struct TriangleElement
+    {
+        int node[6], marker;
+        int neigh[3];
+    };
+
+    // Triangle input (planar straight line graph)
+    QList<Point> m_polyNodes;
+    QList<MeshEdge> m_polyEdges;
+    QList<Point> m_polyHoles;
+    QList<MeshLabel> m_polyLabels;
+
+    // Triangle output
+    QList<Point> m_triangleNodes;
+    QList<MeshEdge> m_triangleEdges;
+    QList<TriangleElement> m_triangleElements;
+
+    bool prepareTriangleInput();
+    bool readTriangleOutput();
+#ifdef WITH_TRIANGLE
+    bool triangulateInProcess();
+#endif
+    void createMesh();
+
     /*
     struct MeshNode
     {
@@ -215,10 +289,17 @@ class ProgressItemProcessView : public ProgressItem
 {
     Q_OBJECT
 private:
+    int m_step;
 
 private slots:
     void process();
 
+    void processedSolutionMesh();
+    void processedRangeContour();
+    void processedRangeScalar();
+    void processedRangeVector();
+    void processedView();
+
 public:
     ProgressItemProcessView();
 
@@ -290,6 +371,7 @@ public slots:
 private slots:
     void finished();
     void start();
+    void succeeded();
     void cancel();
     void resetControls(int currentTab);
     void saveImage();
@@ -1,6 +1,7 @@
 # from hermes2d import *
 
 from libcpp.vector cimport vector
+from libcpp cimport bool as cbool
 cdef vector[double] vectd
 
 cdef extern from "math.h":
@@ -104,6 +105,7 @@ cdef extern from "../pythonlabagros.h":
 
     void pythonMesh()
     void pythonSolve()
+    void pythonSaveMatrixRHS(cbool save)
 
     void pythonZoomBestFit()
     void pythonZoomIn()
@@ -382,6 +384,9 @@ def mesh():
 def solve():
     pythonSolve()
 
+def savematrixrhs(int save):
+    pythonSaveMatrixRHS(save)
+
 # postprocessor
     
 def zoombestfit():
@@ -270,7 +270,15 @@ void PyParticleTracing::solve()
     m_positions.clear();
     m_velocities.clear();
 
-    Util::scene()->computeParticleTracingPath(&m_positions, &m_velocities, false);
+    // the path is kept for the view
+    QList<QList<Point3> > positionsList;
+    QList<QList<Point3> > velocitiesList;
+    Util::scene()->sceneSolution()->particleTracingPaths(&positionsList, &velocitiesList);
+    if (!positionsList.isEmpty())
+    {
+        m_positions = positionsList.first();
+        m_velocities = velocitiesList.first();
+    }
     sceneView()->doInvalidated();
 
     // restore values
@@ -1018,6 +1026,14 @@ void pythonSolve()
     }
 }
 
+// savematrixrhs(save = {True, False})
+void pythonSaveMatrixRHS(bool save)
+{
+    logMessage("pythonSaveMatrixRHS()");
+
+    Util::config()->saveMatrixRHS = save;
+}
+
 // zoombestfit()
 void pythonZoomBestFit()
 {
@@ -1094,7 +1110,48 @@ void pythonPostprocessorMode(char *str)
     sceneView()->doInvalidated();
 }
 
+static PyObject *pythonLocalPointValueDict(LocalPointValue *localPointValue, const QStringList &headers)
+{
+    QStringList variables = localPointValue->variables();
+
+    PyObject *dict = PyDict_New();
+    for (int i = 0; i < variables.length(); i++)
+        PyDict_SetItemString(dict, headers[i].toStdString().c_str(), Py_BuildValue("d", QString(variables[i]).toDouble()));
+
+    return dict;
+}
+
+// points from a sequence [[x1, y1], [x2, y2], ...] (list, tuple or numpy array)
+static bool pythonParsePoints(PyObject *list, QList<Point> &points)
+{
+    for (Py_ssize_t i = 0; i < PySequence_Size(list); i++)
+    {
+        PyObject *item = PySequence_GetItem(list, i);
+        if (!item || !PySequence_Check(item) || PySequence_Size(item) != 2)
+        {
+            Py_XDECREF(item);
+            PyErr_SetString(PyExc_TypeError, QObject::tr("Point must be a sequence [x, y].").toStdString().c_str());
+            return false;
+        }
+
+        PyObject *itemX = PySequence_GetItem(item, 0);
+        PyObject *itemY = PySequence_GetItem(item, 1);
+        Point point(PyFloat_AsDouble(itemX), PyFloat_AsDouble(itemY));
+        Py_XDECREF(itemX);
+        Py_XDECREF(itemY);
+        Py_DECREF(item);
+
+        if (PyErr_Occurred())
+            return false;
+
+        points.append(point);
+    }
+
+    return true;
+}
+
 // result = pointresult(x, y)
+// results = pointresult([[x1, y1], [x2, y2], ...])
 static PyObject *pythonPointResult(PyObject *self, PyObject *args)
 {
     logMessage("pythonPointResult()");
@@ -1103,23 +1160,43 @@ static PyObject *pythonPointResult(PyObject *self, PyObject *args)
     {
         sceneView()->actSceneModePostprocessor->trigger();
 
+        QStringList headers = Util::scene()->problemInfo()->hermes()->localPointValueHeader();
+
         double x, y;
         if (PyArg_ParseTuple(args, "dd", &x, &y))
         {
             Point point(x, y);
             LocalPointValue *localPointValue = Util::scene()->problemInfo()->hermes()->localPointValue(point);
 
-            QStringList headers = Util::scene()->problemInfo()->hermes()->localPointValueHeader();
-            QStringList variables = localPointValue->variables();
-
-            PyObject *dict = PyDict_New();
-            for (int i = 0; i < variables.length(); i++)
-                PyDict_SetItemString(dict, headers[i].toStdString().c_str(), Py_BuildValue("d", QString(variables[i]).toDouble()));
+            PyObject *dict = pythonLocalPointValueDict(localPointValue, headers);
 
             delete localPointValue;
 
             return dict;
         }
+
+        // sequence of points (list, tuple or numpy array)
+        PyErr_Clear();
+        PyObject *list;
+        if (PyArg_ParseTuple(args, "O", &list) && PySequence_Check(list))
+        {
+            QList<Point> points;
+            if (!pythonParsePoints(list, points))
+                return NULL;
+
+            QList<LocalPointValue *> localPointValues = Util::scene()->problemInfo()->hermes()->localPointValues(points);
+
+            PyObject *result = PyList_New(localPointValues.count());
+            for (int i = 0; i < localPointValues.count(); i++)
+            {
+                PyList_SetItem(result, i, pythonLocalPointValueDict(localPointValues.at(i), headers));
+                delete localPointValues.at(i);
+            }
+
+            return result;
+        }
+
+        PyErr_SetString(PyExc_TypeError, QObject::tr("Expected pointresult(x, y) or pointresult([[x1, y1], [x2, y2], ...]).").toStdString().c_str());
     }
     else
     {
@@ -1128,6 +1205,68 @@ static PyObject *pythonPointResult(PyObject *self, PyObject *args)
     return NULL;
 }
 
+// times, results = timeseries(x, y)
+// times, results = timeseries([[x1, y1], [x2, y2], ...])
+static PyObject *pythonTimeSeries(PyObject *self, PyObject *args)
+{
+    logMessage("pythonTimeSeries()");
+
+    if (!Util::scene()->sceneSolution()->isSolved())
+    {
+        PyErr_SetString(PyExc_RuntimeError, QObject::tr("Problem is not solved.").toStdString().c_str());
+        return NULL;
+    }
+
+    QList<Point> points;
+    bool single = false;
+
+    double x, y;
+    if (PyArg_ParseTuple(args, "dd", &x, &y))
+    {
+        points.append(Point(x, y));
+        single = true;
+    }
+    else
+    {
+        PyErr_Clear();
+        PyObject *list;
+        if (!PyArg_ParseTuple(args, "O", &list) || !PySequence_Check(list))
+        {
+            PyErr_SetString(PyExc_TypeError, QObject::tr("Expected timeseries(x, y) or timeseries([[x1, y1], [x2, y2], ...]).").toStdString().c_str());
+            return NULL;
+        }
+
+        if (!pythonParsePoints(list, points))
+            return NULL;
+    }
+
+    QStringList headers = Util::scene()->problemInfo()->hermes()->localPointValueHeader();
+    QList<QList<LocalPointValue *> > localPointValues = Util::scene()->sceneSolution()->localPointValuesTimeSeries(points);
+
+    PyObject *times = PyList_New(localPointValues.count());
+    PyObject *results = PyList_New(localPointValues.count());
+    for (int i = 0; i < localPointValues.count(); i++)
+    {
+        PyList_SetItem(times, i, Py_BuildValue("d", Util::scene()->sceneSolution()->time(i)));
+
+        if (single)
+        {
+            PyList_SetItem(results, i, pythonLocalPointValueDict(localPointValues.at(i).first(), headers));
+        }
+        else
+        {
+            PyObject *step = PyList_New(localPointValues.at(i).count());
+            for (int j = 0; j < localPointValues.at(i).count(); j++)
+                PyList_SetItem(step, j, pythonLocalPointValueDict(localPointValues.at(i).at(j), headers));
+            PyList_SetItem(results, i, step);
+        }
+
+        qDeleteAll(localPointValues.at(i));
+    }
+
+    return Py_BuildValue("NN", times, results);
+}
+
 // result = surfaceintegral(index, ...)
 static PyObject *pythonSurfaceIntegral(PyObject *self, PyObject *args)
 {
@@ -1385,7 +1524,8 @@ static PyMethodDef pythonMethodsAgros[] =
     {"selectnode", pythonSelectNode, METH_VARARGS, "selectnode(index, ...)"},
     {"selectedge", pythonSelectEdge, METH_VARARGS, "selectedge(index, ...)"},
     {"selectlabel", pythonSelectLabel, METH_VARARGS, "selectlabel(index, ...)"},
-    {"pointresult", pythonPointResult, METH_VARARGS, "pointresult(x, y)"},
+    {"pointresult", pythonPointResult, METH_VARARGS, "pointresult(x, y) or pointresult([[x1, y1], [x2, y2], ...])"},
+    {"timeseries", pythonTimeSeries, METH_VARARGS, "timeseries(x, y) or timeseries([[x1, y1], [x2, y2], ...])"},
     {"volumeintegral", pythonVolumeIntegral, METH_VARARGS, "volumeintegral(index, ...)"},
     {"surfaceintegral", pythonSurfaceIntegral, METH_VARARGS, "surfaceintegral(index, ...)"},
     {NULL, NULL, 0, NULL}
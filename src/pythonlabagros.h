@@ -184,6 +184,7 @@ void pythonDeleteSelection();
 
 void pythonMesh();
 void pythonSolve();
+void pythonSaveMatrixRHS(bool save);
 
 void pythonZoomBestFit();
 void pythonZoomIn();
@@ -1643,19 +1643,32 @@ ErrorResult Scene::readFromFile(const QString &fileName)
     emit invalidated();
     emit defaultValues();
 
-    // mesh
-    if (eleDoc.elementsByTagName("mesh").count() > 0)
-    {
-        QDomNode eleMesh = eleDoc.elementsByTagName("mesh").at(0);
-        sceneSolution()->loadMeshInitial(&eleMesh.toElement());
+    if (eleDoc.elementsByTagName("solutions").count() > 0 &&
+            eleDoc.elementsByTagName("solutions").at(0).toElement().hasAttribute("file"))
+    {
+        // mesh and solutions (binary file next to the document)
+        QString fileNameSolution = eleDoc.elementsByTagName("solutions").at(0).toElement().attribute("file");
+        ErrorResult result = sceneSolution()->loadSolutionFile(QFileInfo(fileName).absoluteDir().absoluteFilePath(fileNameSolution));
+        if (result.isError())
+            result.showDialog();
+        emit invalidated();
     }
-
-    // solutions
-    if (eleDoc.elementsByTagName("solutions").count() > 0)
+    else
     {
-        QDomNode eleSolutions = eleDoc.elementsByTagName("solutions").at(0);
-        sceneSolution()->loadSolution(&eleSolutions.toElement());
-        emit invalidated();
+        // mesh
+        if (eleDoc.elementsByTagName("mesh").count() > 0)
+        {
+            QDomNode eleMesh = eleDoc.elementsByTagName("mesh").at(0);
+            sceneSolution()->loadMeshInitial(&eleMesh.toElement());
+        }
+
+        // solutions
+        if (eleDoc.elementsByTagName("solutions").count() > 0)
+        {
+            QDomNode eleSolutions = eleDoc.elementsByTagName("solutions").at(0);
+            sceneSolution()->loadSolution(&eleSolutions.toElement());
+            emit invalidated();
+        }
     }
 
     // run script
@@ -1664,6 +1677,21 @@ ErrorResult Scene::readFromFile(const QString &fileName)
     return ErrorResult();
 }
 
+// solution file referred by the document (saved before)
+static bool isSolutionFileOfDocument(const QString &fileName, const QString &fileNameSolution)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDomDocument doc;
+    if (!doc.setContent(&file))
+        return false;
+
+    QDomNodeList solutions = doc.elementsByTagName("solutions");
+    return (solutions.count() > 0) && (solutions.at(0).toElement().attribute("file") == fileNameSolution);
+}
+
 ErrorResult Scene::writeToFile(const QString &fileName)
 {
     logMessage("Scene::writeToFile()");
@@ -1837,18 +1865,25 @@ ErrorResult Scene::writeToFile(const QString &fileName)
         eleMaterials.appendChild(eleMaterial);
     }
 
-    if (settings.value("Solver/SaveProblemWithSolution", false).value<bool>())
+    // mesh and solutions (binary file next to the document)
+    QString fileNameSolution = QFileInfo(fileName).completeBaseName() + ".a2r";
+    QString filePathSolution = QFileInfo(fileName).absoluteDir().absoluteFilePath(fileNameSolution);
+    if (settings.value("Solver/SaveProblemWithSolution", false).value<bool>() && sceneSolution()->isMeshed())
     {
-        // mesh
-        QDomNode eleMesh = doc.createElement("mesh");
-        sceneSolution()->saveMeshInitial(&doc, &eleMesh.toElement());
-        eleDoc.appendChild(eleMesh);
+        ErrorResult result = sceneSolution()->saveSolutionFile(filePathSolution, Util::config()->compressSolution);
+        if (result.isError())
+            return result;
 
-        // solution
-        QDomNode eleSolutions = doc.createElement("solutions");
-        sceneSolution()->saveSolution(&doc, &eleSolutions.toElement());
+        QDomElement eleSolutions = doc.createElement("solutions");
+        eleSolutions.setAttribute("file", fileNameSolution);
         eleDoc.appendChild(eleSolutions);
     }
+    else if (QFile::exists(filePathSolution) && isSolutionFileOfDocument(fileName, fileNameSolution))
+    {
+        // remove solutions of the previous save (the document will no longer refer to them)
+        if (QFile::remove(filePathSolution))
+            qWarning() << tr("Solution file '%1' of the previous save has been removed.").arg(filePathSolution);
+    }
 
     // save to file
     QFile file(fileName);
@@ -2052,10 +2087,16 @@ ErrorResult Scene::checkGeometryResult()
     return ErrorResult();
 }
 
-void Scene::newtonEquations(double step, Point3 position, Point3 velocity, Point3 *newposition, Point3 *newvelocity)
+void Scene::newtonEquations(const QList<Solution *> &solutions, double step, Point3 position, Point3 velocity, Point3 *newposition, Point3 *newvelocity)
 {
+    QList<Point> points;
+    points.append(Point(position.x, position.y));
+    QList<PointValue> solutionValues;
+    for (int i = 0; i < solutions.count(); i++)
+        solutionValues.append(LocalPointValue::pointValues(solutions.at(i), points).first());
+
     // Lorentz force
-    Point3 forceLorentz = problemInfo()->hermes()->particleForce(position, velocity)  * Util::config()->particleConstant;
+    Point3 forceLorentz = problemInfo()->hermes()->particleForce(position, velocity, solutionValues) * Util::config()->particleConstant;
 
     // Gravitational force
     Point3 forceGravitational;
@@ -2096,13 +2137,8 @@ void Scene::newtonEquations(double step, Point3 position, Point3 velocity, Point
     }
 }
 
-void Scene::computeParticleTracingPath(QList<Point3> *positions,
-                                       QList<Point3> *velocities,
-                                       bool randomPoint)
+Point3 Scene::particleStartingPoint(bool randomPoint)
 {
-    QTime timePart;
-    timePart.start();
-
     // initial position
     Point3 p;
     p.x = Util::config()->particleStart.x;
@@ -2131,6 +2167,20 @@ void Scene::computeParticleTracingPath(QList<Point3> *positions,
         }
     }
 
+    return p;
+}
+
+void Scene::computeParticleTracingPath(QList<Point3> *positions,
+                                       QList<Point3> *velocities,
+                                       const Point3 &start,
+                                       const QList<Solution *> &solutions)
+{
+    QTime timePart;
+    timePart.start();
+
+    // initial position
+    Point3 p = start;
+
     // initial velocity
     Point3 v;
     v.x = Util::config()->particleStartVelocity.x;
@@ -2169,42 +2219,42 @@ void Scene::computeParticleTracingPath(QList<Point3> *positions,
             // Runge-Kutta-Fehlberg adaptive method
             Point3 k1np;
             Point3 k1nv;
-            newtonEquations(dt,
+            newtonEquations(solutions, dt,
                             p,
                             v,
                             &k1np, &k1nv);
 
             Point3 k2np;
             Point3 k2nv;
-            newtonEquations(dt,
+            newtonEquations(solutions, dt,
                             p + k1np * 1/4,
                             v + k1nv * 1/4,
                             &k2np, &k2nv);
 
             Point3 k3np;
             Point3 k3nv;
-            newtonEquations(dt,
+            newtonEquations(solutions, dt,
                             p + k1np * 3/32 + k2np * 9/32,
                             v + k1nv * 3/32 + k2nv * 9/32,
                             &k3np, &k3nv);
 
             Point3 k4np;
             Point3 k4nv;
-            newtonEquations(dt,
+            newtonEquations(solutions, dt,
                             p + k1np * 1932/2197 - k2np * 7200/2197 + k3np * 7296/2197,
                             v + k1nv * 1932/2197 - k2nv * 7200/2197 + k3nv * 7296/2197,
                             &k4np, &k4nv);
 
             Point3 k5np;
             Point3 k5nv;
-            newtonEquations(dt,
+            newtonEquations(solutions, dt,
                             p + k1np * 439/216 - k2np * 8 + k3np * 3680/513 - k4np * 845/4104,
                             v + k1nv * 439/216 - k2nv * 8 + k3nv * 3680/513 - k4nv * 845/4104,
                             &k5np, &k5nv);
 
             Point3 k6np;
             Point3 k6nv;
-            newtonEquations(dt,
+            newtonEquations(solutions, dt,
                             p - k1np * 8/27 + k2np * 2 - k3np * 3544/2565 + k4np * 1859/4104 - k5np * 11/40,
                             v - k1nv * 8/27 + k2nv * 2 - k3nv * 3544/2565 + k4nv * 1859/4104 - k5nv * 11/40,
                             &k6np, &k6nv);
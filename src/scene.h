@@ -219,11 +219,13 @@ public:
     void checkGeometry();
     ErrorResult checkGeometryResult();
 
-    // compute particle path
-    void newtonEquations(double step, Point3 position, Point3 velocity, Point3 *newposition, Point3 *newvelocity);
+    // compute particle path, the solutions (copies of localPointValueSolutions()) are evaluated by the calling thread only
+    void newtonEquations(const QList<Solution *> &solutions, double step, Point3 position, Point3 velocity, Point3 *newposition, Point3 *newvelocity);
+    Point3 particleStartingPoint(bool randomPoint);
     void computeParticleTracingPath(QList<Point3> *positions,
                                     QList<Point3> *velocities,
-                                    bool randomPoint);
+                                    const Point3 &start,
+                                    const QList<Solution *> &solutions);
 
     inline QUndoStack *undoStack() const { return m_undoStack; }
 
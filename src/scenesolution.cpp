@@ -24,6 +24,54 @@
 #include "sceneview.h"
 #include "progressdialog.h"
 
+// view caches (worker thread), the i-th function is evaluated by the i-th thread of the linearizer
+static void linearizeView(Linearizer *linearizer, Hermes::vector<MeshFunction *> slns, double eps)
+{
+    linearizer->process_solution(slns, H2D_FN_VAL_0, eps);
+}
+
+static void vectorizeView(Vectorizer *vectorizer, Hermes::vector<MeshFunction *> slnsX, Hermes::vector<MeshFunction *> slnsY)
+{
+    vectorizer->process_solution(slnsX, H2D_FN_VAL_0, slnsY, H2D_FN_VAL_0, HERMES_EPS_LOW);
+}
+
+static void traceParticles(QAtomicInt *next, const QList<Point3> *starts,
+                           QList<Point3> *positionsList, QList<Point3> *velocitiesList, QList<Solution *> solutions)
+{
+    // particles are taken one by one, the paths differ in the number of steps
+    int k;
+    while ((k = next->fetchAndAddOrdered(1)) < starts->count())
+        Util::scene()->computeParticleTracingPath(&positionsList[k], &velocitiesList[k], starts->at(k), solutions);
+}
+
+// number of linearizations kept for the contour and scalar view
+const int VIEW_LINEARIZATIONS_CACHED = 4;
+// number of time steps kept restored from the compact solution arrays
+const int SOLUTION_ARRAYS_RESTORED = 4;
+
+ViewLinearization::ViewLinearization(int timeStep, PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp,
+                                     double quality, bool deform)
+    : timeStep(timeStep), physicFieldVariable(physicFieldVariable), physicFieldVariableComp(physicFieldVariableComp),
+      quality(quality), deform(deform), filter(NULL)
+{
+}
+
+ViewLinearization::~ViewLinearization()
+{
+    if (filter)
+        delete filter;
+}
+
+bool ViewLinearization::isEqual(int timeStep, PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp,
+                                double quality, bool deform) const
+{
+    return ((this->timeStep == timeStep) &&
+            (this->physicFieldVariable == physicFieldVariable) &&
+            (this->physicFieldVariableComp == physicFieldVariableComp) &&
+            (this->quality == quality) &&
+            (this->deform == deform));
+}
+
 SceneSolution::SceneSolution()
 {
     logMessage("SceneSolution::SceneSolution()");
@@ -37,14 +85,26 @@ SceneSolution::SceneSolution()
     m_isSolving = false;
 
     m_meshInitial = NULL;
-    m_slnContourView = NULL;
-    m_slnScalarView = NULL;
+    m_contourView = &m_viewLinearizationEmpty;
+    m_scalarView = &m_viewLinearizationEmpty;
     m_slnVectorXView = NULL;
     m_slnVectorYView = NULL;   
+
+    m_linSolutionMeshView = new Linearizer();
+    m_vecVectorView = new Vectorizer();
+    m_processViewConcurrent = false;
 }
 
 SceneSolution::~SceneSolution()
 {
+    cancelProcessView();
+    waitProcessView();
+
+    clearViewLinearizations();
+
+    delete m_linSolutionMeshView;
+    delete m_vecVectorView;
+
     delete m_progressDialog;
     delete m_progressItemMesh;
     delete m_progressItemSolve;
@@ -55,13 +115,14 @@ void SceneSolution::clear()
 {
     logMessage("SceneSolution::clear()");
 
+    cancelProcessView();
+    waitProcessView();
+
     m_timeStep = -1;
 
     m_linInitialMeshView.free();
-    m_linSolutionMeshView.free();
-    m_linContourView.free();
-    m_linScalarView.free();
-    // m_vecVectorView.free();
+    m_linSolutionMeshView->free();
+    // m_vecVectorView->free();
 
     // solution array
     if (!m_solutionArrayList.isEmpty())
@@ -70,6 +131,8 @@ void SceneSolution::clear()
             delete m_solutionArrayList.at(i);
         m_solutionArrayList.clear();
     }
+    m_solutionArrayRestored.clear();
+    clearParticleTracingPaths();
 
     // mesh
     if (m_meshInitial)
@@ -78,20 +141,9 @@ void SceneSolution::clear()
         m_meshInitial = NULL;
     }
 
-    // countour
-    if (m_slnContourView)
-    {
-        delete m_slnContourView;
-        m_slnContourView = NULL;
-    }
-    
-    // scalar
-    if (m_slnScalarView)
-    {
-        delete m_slnScalarView;
-        m_slnScalarView = NULL;
-    }
-    
+    // countour and scalar
+    clearViewLinearizations();
+
     // vector
     if (m_slnVectorXView)
     {
@@ -188,105 +240,957 @@ void SceneSolution::loadMeshInitial(QDomElement *element)
     setMeshInitial(mesh);
 }
 
-void SceneSolution::saveMeshInitial(QDomDocument *doc, QDomElement *element)
+void SceneSolution::loadSolution(QDomElement *element)
 {
-    logMessage("SceneSolution::saveMeshInitial()");
+    logMessage("SceneSolution::loadSolution()");
 
-    if (isMeshed())
+    QList<SolutionArray *> solutionArrayList;
+
+    // constant solution cannot be saved
+    if (Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
+        solutionArrayList.append(initialSolutionArray());
+
+    QDomNode n = element->firstChild();
+    while(!n.isNull())
     {
-        QString fileName = tempProblemFileName() + ".mesh";
+        SolutionArray *solutionArray = new SolutionArray();
+        solutionArray->load(&n.toElement());
 
-        writeMeshFromFile(fileName, m_meshInitial);
+        // add to the array
+        solutionArrayList.append(solutionArray);
 
-        // read content
-        QDomText text = doc->createTextNode(readFileContentByteArray(fileName).toBase64());
-        element->appendChild(text);
+        n = n.nextSibling();
     }
+
+    if (!solutionArrayList.isEmpty())
+        setSolutionArrayList(solutionArrayList);
 }
 
-void SceneSolution::loadSolution(QDomElement *element)
+// binary file with the initial mesh and the solutions
+static const char SOLUTION_FILE_MAGIC[] = "A2DR\002\000\000\000";
+
+enum SolutionRecord
 {
-    logMessage("SceneSolution::loadSolution()");
+    SolutionRecord_Full, // solution and orders
+    SolutionRecord_Layout, // layout of the compact time steps and coefficients
+    SolutionRecord_Compact // coefficients
+};
 
-    QList<SolutionArray *> solutionArrayList;
+// 64-bit file positions (long is 32-bit on Windows)
+static qint64 filePosition(FILE *f)
+{
+#ifdef Q_OS_WIN
+    return _ftelli64(f);
+#else
+    return ftello(f);
+#endif
+}
+
+static bool fileSeek(FILE *f, qint64 offset)
+{
+#ifdef Q_OS_WIN
+    return _fseeki64(f, offset, SEEK_SET) == 0;
+#else
+    return fseeko(f, offset, SEEK_SET) == 0;
+#endif
+}
+
+// compressed blocks are written through a temporary stream
+static FILE *beginBlock(FILE *f, bool compress)
+{
+    return compress ? tmpfile() : f;
+}
+
+static bool endBlock(FILE *f, FILE *block, bool compress)
+{
+    if (!compress) return true;
+
+    qint64 size = filePosition(block);
+    if (size < 0 || size > std::numeric_limits<int>::max())
+    {
+        fclose(block);
+        return false;
+    }
+
+    QByteArray content(size, 0);
+    rewind(block);
+    bool ok = (fread(content.data(), 1, content.size(), block) == (size_t) content.size());
+    fclose(block);
+
+    QByteArray compressed = qCompress(content);
+    int sizeCompressed = compressed.size();
+    return ok &&
+            fwrite(&sizeCompressed, sizeof(int), 1, f) == 1 &&
+            fwrite(compressed.constData(), 1, sizeCompressed, f) == (size_t) sizeCompressed;
+}
+
+static FILE *readBlock(FILE *f, bool compress)
+{
+    if (!compress) return f;
+
+    int size;
+    if (fread(&size, sizeof(int), 1, f) != 1 || size < 0) return NULL;
+    QByteArray compressed(size, 0);
+    if (fread(compressed.data(), 1, size, f) != (size_t) size) return NULL;
+    QByteArray content = qUncompress(compressed);
+
+    FILE *block = tmpfile();
+    if (block)
+    {
+        fwrite(content.constData(), 1, content.size(), block);
+        rewind(block);
+    }
+    return block;
+}
+
+static void closeBlock(FILE *f, FILE *block)
+{
+    if (block != f)
+        fclose(block);
+}
+
+static bool writeCoefs(FILE *f, const QVector<double> &coefs)
+{
+    int count = coefs.count();
+    return fwrite(&count, sizeof(int), 1, f) == 1 &&
+            fwrite(coefs.constData(), sizeof(double), count, f) == (size_t) count;
+}
+
+static bool readCoefs(FILE *f, QVector<double> &coefs)
+{
+    int count;
+    if (fread(&count, sizeof(int), 1, f) != 1 || count < 0) return false;
+    coefs.resize(count);
+    return fread(coefs.data(), sizeof(double), count, f) == (size_t) count;
+}
+
+// hermes loaders abort on corrupt data, the sizes and indices of a block are checked
+// before the block is loaded (pos is the position in the block)
+static bool checkBytes(qint64 size, qint64 *pos, qint64 count)
+{
+    if (count < 0 || *pos + count > size) return false;
+    *pos += count;
+    return true;
+}
+
+static bool checkInt(const uchar *data, qint64 size, qint64 *pos, int *value)
+{
+    if (*pos + (qint64) sizeof(int) > size) return false;
+    memcpy(value, data + *pos, sizeof(int));
+    *pos += sizeof(int);
+    return true;
+}
+
+static bool checkHeader(const uchar *data, qint64 size, qint64 *pos, const char *magic)
+{
+    int version;
+    if (*pos + 4 > size || memcmp(data + *pos, magic, 4) != 0) return false;
+    *pos += 4;
+    return checkInt(data, size, pos, &version) && (version <= 1);
+}
+
+static bool checkMesh(const uchar *data, qint64 size, qint64 *pos)
+{
+    // Mesh::save_raw()
+    int nbase, ntopvert, nactive, nv, mv, ne, me, id;
+    int elementMax = -1; // elements of the edge nodes
+    unsigned int bits;
+    if (!checkHeader(data, size, pos, "H2DM") ||
+            !checkInt(data, size, pos, &nbase) || !checkInt(data, size, pos, &ntopvert) || !checkInt(data, size, pos, &nactive) ||
+            !checkInt(data, size, pos, &nv) || !checkInt(data, size, pos, &mv) || nv < 0 || nv > mv)
+        return false;
+
+    for (int i = 0; i < nv; i++)
+    {
+        if (!checkInt(data, size, pos, &id) || id < 0 || id >= mv ||
+                !checkInt(data, size, pos, (int *) &bits))
+            return false;
+
+        // vertex: x, y, parents; edge: marker, elements, parents
+        bool vertex = ((bits >> 29) & 0x1) == 0;
+        if (vertex)
+        {
+            if (!checkBytes(size, pos, 2 * sizeof(double) + 2 * sizeof(int)))
+                return false;
+        }
+        else
+        {
+            int marker, element[2];
+            if (!checkInt(data, size, pos, &marker) ||
+                    !checkInt(data, size, pos, &element[0]) || !checkInt(data, size, pos, &element[1]) ||
+                    element[0] < -1 || element[1] < -1 || !checkBytes(size, pos, 2 * sizeof(int)))
+                return false;
+            elementMax = qMax(elementMax, qMax(element[0], element[1]));
+        }
+    }
+
+    if (!checkInt(data, size, pos, &ne) || !checkInt(data, size, pos, &me) || ne < 0 || ne > me || elementMax >= me)
+        return false;
+
+    for (int i = 0; i < ne; i++)
+    {
+        if (!checkInt(data, size, pos, &id) || id < 0 || id >= me ||
+                !checkInt(data, size, pos, (int *) &bits))
+            return false;
+
+        unsigned int nvert = bits & 0x3fffffff;
+        bool active = (bits >> 30) & 0x1;
+        bool used = (bits >> 31) & 0x1;
+        if (!used)
+            continue;
+
+        // marker, user data, cache of the integration order, vertex nodes
+        if ((nvert != 3 && nvert != 4) || !checkBytes(size, pos, 3 * sizeof(int)))
+            return false;
+        for (unsigned int j = 0; j < nvert; j++)
+            if (!checkInt(data, size, pos, &id) || id < 0 || id >= mv)
+                return false;
+
+        // edge nodes or sons
+        for (unsigned int j = 0; j < (active ? nvert : 4); j++)
+            if (!checkInt(data, size, pos, &id) || id >= (active ? mv : me) || (active && id < 0))
+                return false;
+    }
+
+    return true;
+}
+
+static bool checkSolution(const uchar *data, qint64 size, qint64 *pos)
+{
+    // Solution::save()
+    int ss, nc, ne, nf;
+    return checkHeader(data, size, pos, "H2DS") &&
+            checkInt(data, size, pos, &ss) && (ss == sizeof(double) || ss == 2 * sizeof(double)) &&
+            checkInt(data, size, pos, &nc) && (nc == 1 || nc == 2) &&
+            checkInt(data, size, pos, &ne) && checkInt(data, size, pos, &nf) &&
+            checkBytes(size, pos, (qint64) nf * ss) &&
+            checkBytes(size, pos, ne) &&
+            checkBytes(size, pos, (qint64) nc * ne * sizeof(int)) &&
+            checkMesh(data, size, pos);
+}
+
+static bool checkOrderizer(const uchar *data, qint64 size, qint64 *pos)
+{
+    // Orderizer::save_data()
+    int nv, nt, ne, nl;
+    if (!checkHeader(data, size, pos, "H2DO") ||
+            !checkInt(data, size, pos, &nv) || !checkBytes(size, pos, (qint64) nv * 3 * sizeof(double)) ||
+            !checkInt(data, size, pos, &nt) || !checkBytes(size, pos, (qint64) nt * 3 * sizeof(int)) ||
+            !checkInt(data, size, pos, &ne) || !checkBytes(size, pos, (qint64) ne * 3 * sizeof(int)) ||
+            !checkInt(data, size, pos, &nl) || !checkBytes(size, pos, (qint64) nl * (sizeof(int) + 2 * sizeof(double))))
+        return false;
+
+    // labels of the orders 0 - 10
+    for (int i = 0; i < nl; i++)
+    {
+        int order;
+        if (!checkInt(data, size, pos, &order) || order < 0 ||
+                H2D_GET_H_ORDER(order) > 10 || H2D_GET_V_ORDER(order) > 10)
+            return false;
+    }
+
+    return true;
+}
+
+static bool checkCoefs(const uchar *data, qint64 size, qint64 *pos, int *count)
+{
+    return checkInt(data, size, pos, count) && (*count >= 0) && checkBytes(size, pos, (qint64) *count * sizeof(double));
+}
+
+// layout is the index of the layout of a compact record, coefs is the number of the coefficients
+static bool checkRecord(int record, const uchar *data, qint64 size, int *layout, int *coefs)
+{
+    qint64 pos = 0;
+    switch (record)
+    {
+    case SolutionRecord_Full:
+        return checkSolution(data, size, &pos) && checkOrderizer(data, size, &pos) && (pos == size);
+    case SolutionRecord_Layout:
+        return checkSolution(data, size, &pos) && checkOrderizer(data, size, &pos) && checkCoefs(data, size, &pos, coefs) && (pos == size);
+    case SolutionRecord_Compact:
+        return checkInt(data, size, &pos, layout) && checkCoefs(data, size, &pos, coefs) && (pos == size);
+    default:
+        return false;
+    }
+}
+
+// initial mesh (text written by H2DReader::save(), the parser aborts on syntax errors)
+static bool checkMeshText(const QByteArray &content)
+{
+    int depth = 0;
+    for (int i = 0; i < content.size(); i++)
+    {
+        char c = content.at(i);
+        if (c == '{' || c == '[') depth++;
+        else if (c == '}' || c == ']') depth--;
+        else if ((c < 32 || c > 126) && c != '\n' && c != '\r' && c != '\t') return false;
+
+        if (depth < 0) return false;
+    }
+
+    return (depth == 0) && content.contains("vertices") && content.contains("elements");
+}
+
+ErrorResult SceneSolution::saveSolutionFile(const QString &fileName, bool compress)
+{
+    logMessage("SceneSolution::saveSolutionFile()");
+
+    if (!isMeshed())
+        return ErrorResult(ErrorResultType_Critical, tr("Problem is not meshed."));
 
     // constant solution cannot be saved
-    if (Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
+    int start = (Util::scene()->problemInfo()->analysisType != AnalysisType_Transient) ? 0 : 1;
+    int count = isSolved() ? qMax(m_solutionArrayList.count() - start, 0) : 0;
+    int flags = compress ? 1 : 0;
+
+    // time steps are still stored in the file they were loaded from
+    SolutionStorage *storage = (count > 0) ? m_solutionArrayList.last()->storage() : NULL;
+    for (int i = start; storage && i < m_solutionArrayList.count(); i++)
+        if (m_solutionArrayList.at(i)->storage() != storage)
+            storage = NULL;
+
+    if (storage)
     {
-        Util::scene()->problemInfo()->initialCondition.evaluate(true);
+        if (QFileInfo(storage->fileName()) == QFileInfo(fileName) && QFile::exists(fileName))
+            return ErrorResult();
 
-        SolutionArray *solutionArray = new SolutionArray();
-        solutionArray->order = new Orderizer();
-        solutionArray->sln = new Solution();
-        solutionArray->sln->set_const(Util::scene()->sceneSolution()->meshInitial(), Util::scene()->problemInfo()->initialCondition.number);
-        solutionArray->adaptiveError = 0.0;
-        solutionArray->adaptiveSteps = 0.0;
-        solutionArray->time = 0.0;
+        QFile::remove(fileName);
+        if (!QFile::copy(storage->fileName(), fileName))
+            return ErrorResult(ErrorResultType_Critical, tr("File '%1' cannot be saved.").arg(fileName));
 
-        solutionArrayList.append(solutionArray);
+        return ErrorResult();
     }
 
-    QDomNode n = element->firstChild();
-    while(!n.isNull())
+    FILE *f = fopen(fileName.toStdString().c_str(), "wb");
+    if (!f)
+        return ErrorResult(ErrorResultType_Critical, tr("File '%1' cannot be saved.").arg(fileName));
+
+    bool ok = (fwrite(SOLUTION_FILE_MAGIC, 1, 8, f) == 8) &&
+            (fwrite(&flags, sizeof(int), 1, f) == 1) &&
+            (fwrite(&count, sizeof(int), 1, f) == 1);
+
+    // mesh text written straight into the block, the size is written in front of it
+    FILE *block = beginBlock(f, compress);
+    int size = 0;
+    qint64 positionSize = block ? filePosition(block) : -1;
+    ok = ok && block && (positionSize >= 0) &&
+            (fwrite(&size, sizeof(int), 1, block) == 1) &&
+            writeMeshToStream(block, m_meshInitial);
+    if (ok)
+    {
+        qint64 positionEnd = filePosition(block);
+        qint64 sizeMesh = positionEnd - positionSize - (qint64) sizeof(int);
+        size = sizeMesh;
+        ok = (positionEnd >= 0) && (sizeMesh <= std::numeric_limits<int>::max()) &&
+                fileSeek(block, positionSize) &&
+                (fwrite(&size, sizeof(int), 1, block) == 1) &&
+                fileSeek(block, positionEnd);
+    }
+    ok = block && endBlock(f, block, compress) && ok;
+
+    // solutions, one time step after another
+    QList<SolutionLayout *> layouts;
+    QList<qint64> offsets;
+    for (int i = start; ok && i < m_solutionArrayList.count(); i++)
+    {
+        SolutionArray *solutionArray = m_solutionArrayList.at(i);
+        offsets.append(filePosition(f));
+
+        // layout index and number of the coefficients are kept in the header (see SolutionStorage::open())
+        int record = SolutionRecord_Full;
+        int layout = -1;
+        int coefs = -1;
+        if (solutionArray->isCompact())
+        {
+            layout = layouts.indexOf(solutionArray->layout());
+            record = (layout != -1) ? SolutionRecord_Compact : SolutionRecord_Layout;
+            if (record == SolutionRecord_Layout)
+                layout = layouts.count();
+            coefs = solutionArray->coefs().count();
+        }
+
+        ok = (fwrite(&solutionArray->time, sizeof(double), 1, f) == 1) &&
+                (fwrite(&solutionArray->adaptiveError, sizeof(double), 1, f) == 1) &&
+                (fwrite(&solutionArray->adaptiveSteps, sizeof(int), 1, f) == 1) &&
+                (fwrite(&record, sizeof(int), 1, f) == 1) &&
+                (fwrite(&layout, sizeof(int), 1, f) == 1) &&
+                (fwrite(&coefs, sizeof(int), 1, f) == 1);
+
+        block = beginBlock(f, compress);
+        ok = ok && block;
+        if (ok)
+        {
+            switch (record)
+            {
+            case SolutionRecord_Full:
+            {
+                // stored solution is read only for saving
+                bool restored = solutionArray->sln;
+                ok = solutionArray->solution();
+                if (ok)
+                {
+                    solutionArray->sln->save(block);
+                    solutionArray->order->save_data(block);
+                }
+                if (!restored)
+                    solutionArray->release();
+            }
+                break;
+            case SolutionRecord_Layout:
+                layouts.append(solutionArray->layout());
+                solutionArray->layout()->sln->save(block);
+                solutionArray->layout()->order->save_data(block);
+                ok = writeCoefs(block, solutionArray->coefs());
+                break;
+            case SolutionRecord_Compact:
+                ok = (fwrite(&layout, sizeof(int), 1, block) == 1) &&
+                        writeCoefs(block, solutionArray->coefs());
+                break;
+            }
+            ok = endBlock(f, block, compress) && ok;
+        }
+    }
+
+    // index of the time steps (file offsets) at the end of the file
+    qint64 offsetIndex = filePosition(f);
+    foreach (qint64 offset, offsets)
+        ok = ok && (offset >= 0) && (fwrite(&offset, sizeof(qint64), 1, f) == 1);
+    ok = ok && (offsetIndex >= 0) && (fwrite(&offsetIndex, sizeof(qint64), 1, f) == 1);
+
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok)
+        return ErrorResult(ErrorResultType_Critical, tr("File '%1' cannot be saved.").arg(fileName));
+
+    return ErrorResult();
+}
+
+ErrorResult SceneSolution::loadSolutionFile(const QString &fileName)
+{
+    logMessage("SceneSolution::loadSolutionFile()");
+
+    FILE *f = fopen(fileName.toStdString().c_str(), "rb");
+    if (!f)
+        return ErrorResult(ErrorResultType_Critical, tr("File '%1' cannot be opened.").arg(fileName));
+
+    char magic[8];
+    int flags, count;
+    if (fread(magic, 1, 8, f) != 8 || memcmp(magic, SOLUTION_FILE_MAGIC, 8) != 0 ||
+            fread(&flags, sizeof(int), 1, f) != 1 || fread(&count, sizeof(int), 1, f) != 1)
+    {
+        fclose(f);
+        return ErrorResult(ErrorResultType_Critical, tr("File '%1' is not valid Agros2D solution file.").arg(fileName));
+    }
+    bool compress = (flags & 1);
+
+    // mesh
+    FILE *block = readBlock(f, compress);
+    int size;
+    bool ok = block && (fread(&size, sizeof(int), 1, block) == 1) && (size >= 0);
+    QByteArray contentMesh(ok ? size : 0, 0);
+    ok = ok && (fread(contentMesh.data(), 1, size, block) == (size_t) size) && checkMeshText(contentMesh);
+    if (block) closeBlock(f, block);
+
+    if (ok)
+        setMeshInitial(readMeshFromByteArray(contentMesh));
+
+    fclose(f);
+
+    // solutions are read on demand
+    SolutionStorage *storage = NULL;
+    if (ok && count > 0)
+    {
+        storage = new SolutionStorage(fileName, compress);
+        ok = storage->open() && (storage->count() == count);
+    }
+
+    QList<SolutionArray *> solutionArrayList;
+    if (ok && count > 0 && Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
+        solutionArrayList.append(initialSolutionArray());
+
+    for (int i = 0; ok && i < count; i++)
     {
         SolutionArray *solutionArray = new SolutionArray();
-        solutionArray->load(&n.toElement());
+        storage->header(i, &solutionArray->time, &solutionArray->adaptiveError, &solutionArray->adaptiveSteps);
+        solutionArray->setStorage(storage, storage->offset(i));
 
-        // add to the array
         solutionArrayList.append(solutionArray);
+    }
 
-        n = n.nextSibling();
+    if (!ok)
+    {
+        delete storage;
+        for (int i = 0; i < solutionArrayList.count(); i++)
+            delete solutionArrayList.at(i);
+
+        return ErrorResult(ErrorResultType_Critical, tr("File '%1' is not valid Agros2D solution file.").arg(fileName));
     }
 
     if (!solutionArrayList.isEmpty())
         setSolutionArrayList(solutionArrayList);
+
+    return ErrorResult();
 }
 
-void SceneSolution::saveSolution(QDomDocument *doc, QDomElement *element)
+// header of the record: time, adaptive error, adaptive steps, record type,
+// index of the layout and number of the coefficients (-1 for the full record)
+static const int SOLUTION_RECORD_HEADER = 2 * sizeof(double) + 4 * sizeof(int);
+
+SolutionStorage::SolutionStorage(const QString &fileName, bool compress)
+    : references(0), m_file(fileName), m_data(NULL), m_compress(compress)
 {
-    logMessage("SceneSolution::saveSolution()");
+    logMessage("SolutionStorage::SolutionStorage()");
+}
 
-    if (isSolved())
+SolutionStorage::~SolutionStorage()
+{
+    logMessage("SolutionStorage::~SolutionStorage()");
+
+    for (int i = 0; i < m_layouts.count(); i++)
+        if (m_layouts.at(i) && --m_layouts[i]->references == 0)
+            delete m_layouts.at(i);
+
+    if (m_data)
+        m_file.unmap(m_data);
+    m_file.close();
+}
+
+bool SolutionStorage::open()
+{
+    logMessage("SolutionStorage::open()");
+
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 size = m_file.size();
+    if (size < (qint64) sizeof(qint64))
+        return false;
+
+    m_data = m_file.map(0, size);
+    if (!m_data)
+        return false;
+
+    // index of the records at the end of the file
+    qint64 offsetIndex;
+    memcpy(&offsetIndex, m_data + size - sizeof(qint64), sizeof(qint64));
+    if (offsetIndex < 0 || offsetIndex > size - (qint64) sizeof(qint64) ||
+            (size - sizeof(qint64) - offsetIndex) % sizeof(qint64) != 0)
+        return false;
+
+    int count = (size - sizeof(qint64) - offsetIndex) / sizeof(qint64);
+    for (int i = 0; i < count; i++)
+    {
+        qint64 offset;
+        memcpy(&offset, m_data + offsetIndex + i * sizeof(qint64), sizeof(qint64));
+        m_offsets.append(offset);
+    }
+    m_offsets.append(offsetIndex);
+
+    // only the headers are checked here, the records are checked when they are used
+    // for the first time (hermes loaders abort on corrupt data, see block())
+    QList<int> layoutCoefs;
+    for (int i = 0; i < count; i++)
     {
-        // constant solution cannot be saved
-        int start = (Util::scene()->problemInfo()->analysisType != AnalysisType_Transient) ? 0 : 1;
+        if (m_offsets.at(i) < 0 || m_offsets.at(i) + SOLUTION_RECORD_HEADER > m_offsets.at(i + 1))
+            return false;
 
-        for (int i = start; i < timeStepCount(); i++)
+        int record, layout, coefs;
+        recordHeader(i, &record, &layout, &coefs);
+        switch (record)
         {
-            QDomNode eleSolution = doc->createElement("solution");
-            m_solutionArrayList.at(i)->save(doc, &eleSolution.toElement());
-            element->appendChild(eleSolution);
+        case SolutionRecord_Full:
+            break;
+        case SolutionRecord_Layout:
+            // layouts are numbered in the order of the records
+            if (layout != layoutCoefs.count() || coefs < 0)
+                return false;
+            m_layoutOffsets.append(m_offsets.at(i));
+            layoutCoefs.append(coefs);
+            break;
+        case SolutionRecord_Compact:
+            // compact records use the coefficients of a previous layout
+            if (layout < 0 || layout >= layoutCoefs.count() || coefs != layoutCoefs.at(layout))
+                return false;
+            break;
+        default:
+            return false;
         }
     }
+
+    for (int i = 0; i < m_layoutOffsets.count(); i++)
+        m_layouts.append(NULL);
+    m_layoutCoefs.resize(m_layoutOffsets.count());
+    m_checked.fill(false, count);
+
+    return true;
+}
+
+void SolutionStorage::header(int index, double *time, double *adaptiveError, int *adaptiveSteps)
+{
+    const uchar *data = m_data + m_offsets.at(index);
+
+    memcpy(time, data, sizeof(double));
+    memcpy(adaptiveError, data + sizeof(double), sizeof(double));
+    memcpy(adaptiveSteps, data + 2 * sizeof(double), sizeof(int));
+}
+
+void SolutionStorage::recordHeader(int index, int *record, int *layout, int *coefs)
+{
+    const uchar *data = m_data + m_offsets.at(index) + 2 * sizeof(double) + sizeof(int);
+
+    memcpy(record, data, sizeof(int));
+    memcpy(layout, data + sizeof(int), sizeof(int));
+    memcpy(coefs, data + 2 * sizeof(int), sizeof(int));
+}
+
+bool SolutionStorage::restore(qint64 offset, Solution **sln, Orderizer **order, SolutionLayout **layout)
+{
+    logTrace("SolutionStorage::restore()");
+
+    FILE *f = block(offset);
+    if (!f)
+        return false;
+
+    int record;
+    memcpy(&record, m_data + offset + 2 * sizeof(double) + sizeof(int), sizeof(int));
+
+    bool ok = true;
+    if (record == SolutionRecord_Full)
+    {
+        *sln = new Solution();
+        (*sln)->load(f);
+        *order = new Orderizer();
+        (*order)->load_data(f);
+    }
+    else
+    {
+        SolutionLayout *solutionLayout = NULL;
+        if (record == SolutionRecord_Layout)
+        {
+            solutionLayout = this->layout(qLowerBound(m_layoutOffsets, offset) - m_layoutOffsets.constBegin(), f);
+        }
+        else
+        {
+            int index;
+            ok = (fread(&index, sizeof(int), 1, f) == 1) && (index >= 0) && (index < m_layouts.count());
+            if (ok)
+                solutionLayout = this->layout(index);
+        }
+
+        QVector<double> coefs;
+        ok = ok && solutionLayout && readCoefs(f, coefs) && (coefs.count() == solutionLayout->sln->get_num_coefs());
+        if (ok)
+        {
+            *sln = new Solution();
+            (*sln)->copy(solutionLayout->sln, false);
+            (*sln)->set_mono_coefs(coefs.data());
+            *order = solutionLayout->order;
+            *layout = solutionLayout;
+        }
+    }
+    fclose(f);
+
+    return ok;
+}
+
+FILE *SolutionStorage::block(qint64 offset)
+{
+    int index = qLowerBound(m_offsets, offset) - m_offsets.constBegin();
+    if (index >= m_offsets.count() - 1 || m_offsets.at(index) != offset)
+        return NULL;
+
+    QByteArray content;
+    const uchar *data;
+    qint64 size;
+    if (!recordData(index, &content, &data, &size))
+    {
+        logMessage(QObject::tr("Record %1 of the solution file '%2' cannot be read.").arg(index).arg(fileName()), LogLevel_Warning);
+        return NULL;
+    }
+
+    // the record is checked when it is used for the first time, compact records
+    // must match the layout and the number of the coefficients of the header
+    if (!m_checked.at(index))
+    {
+        int record, layout, coefs;
+        recordHeader(index, &record, &layout, &coefs);
+
+        int layoutRecord = -1, coefsRecord = -1;
+        if (!checkRecord(record, data, size, &layoutRecord, &coefsRecord) ||
+                (record == SolutionRecord_Compact && layoutRecord != layout) ||
+                (record != SolutionRecord_Full && coefsRecord != coefs))
+        {
+            logMessage(QObject::tr("Record %1 of the solution file '%2' is not valid.").arg(index).arg(fileName()), LogLevel_Warning);
+            return NULL;
+        }
+        m_checked[index] = true;
+    }
+
+    if (!m_compress)
+        return fmemopen((void *) data, size, "rb");
+
+    FILE *f = tmpfile();
+    if (f)
+    {
+        fwrite(content.constData(), 1, content.size(), f);
+        rewind(f);
+    }
+    return f;
+}
+
+bool SolutionStorage::recordData(int index, QByteArray *content, const uchar **data, qint64 *size)
+{
+    *data = m_data + m_offsets.at(index) + SOLUTION_RECORD_HEADER;
+    *size = m_offsets.at(index + 1) - m_offsets.at(index) - SOLUTION_RECORD_HEADER;
+
+    if (!m_compress)
+        return true;
+
+    int sizeCompressed;
+    if (*size < (qint64) sizeof(int))
+        return false;
+    memcpy(&sizeCompressed, *data, sizeof(int));
+    if (sizeCompressed < 0 || sizeof(int) + sizeCompressed > *size)
+        return false;
+
+    *content = qUncompress(*data + sizeof(int), sizeCompressed);
+    *data = (const uchar *) content->constData();
+    *size = content->size();
+    return true;
+}
+
+SolutionLayout *SolutionStorage::layout(int index, FILE *f)
+{
+    if (!m_layouts.at(index))
+    {
+        FILE *fileLayout = f ? f : block(m_layoutOffsets.at(index));
+        if (!fileLayout)
+            return NULL;
+
+        Solution *sln = new Solution();
+        sln->load(fileLayout);
+        Orderizer *order = new Orderizer();
+        order->load_data(fileLayout);
+        m_layoutCoefs[index] = filePosition(fileLayout);
+
+        if (!f)
+            fclose(fileLayout);
+
+        // layout is kept by the storage until the file is closed
+        m_layouts[index] = new SolutionLayout(sln, order);
+        m_layouts[index]->references++;
+    }
+    else if (f)
+    {
+        // coefficients follow the layout
+        fileSeek(f, m_layoutCoefs.at(index));
+    }
+
+    return m_layouts.at(index);
+}
+
+SolutionArray *SceneSolution::initialSolutionArray()
+{
+    logMessage("SceneSolution::initialSolutionArray()");
+
+    Util::scene()->problemInfo()->initialCondition.evaluate(true);
+
+    SolutionArray *solutionArray = new SolutionArray();
+    solutionArray->order = new Orderizer();
+    solutionArray->sln = new Solution();
+    solutionArray->sln->set_const(meshInitial(), Util::scene()->problemInfo()->initialCondition.number);
+    solutionArray->adaptiveError = 0.0;
+    solutionArray->adaptiveSteps = 0.0;
+    solutionArray->time = 0.0;
+
+    return solutionArray;
 }
 
-Solution *SceneSolution::sln(int i)
+Solution *SceneSolution::sln(int i, int timeStep)
 {
-    logMessage("SceneSolution::sln()");
+    logTrace("SceneSolution::sln()");
 
     int currentTimeStep = i;
+    if (timeStep != -1)
+        currentTimeStep = timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution() + qMax(i, 0);
     if (isSolved() && currentTimeStep < timeStepCount() * Util::scene()->problemInfo()->hermes()->numberOfSolution())
     {
         // default
         if (currentTimeStep == -1)
             currentTimeStep = m_timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution();
 
-        if (m_solutionArrayList.value(currentTimeStep)->sln)
-            return m_solutionArrayList.value(currentTimeStep)->sln;
+        SolutionArray *solutionArray = m_solutionArrayList.value(currentTimeStep);
+        if (solutionArray->hasSolution())
+        {
+            // restore compact or stored time step, the most recently used is the last one
+            if (solutionArray->isRestorable())
+            {
+                if (solutionArray->sln)
+                {
+                    m_solutionArrayRestored.removeOne(solutionArray);
+                    m_solutionArrayRestored.append(solutionArray);
+                }
+                else
+                {
+                    m_solutionArrayRestored.append(solutionArray);
+                    releaseSolutionArrays();
+                }
+            }
+
+            return solutionArray->solution();
+        }
     }
     return NULL;
 }
 
+void SceneSolution::releaseSolutionArrays()
+{
+    logTrace("SceneSolution::releaseSolutionArrays()");
+
+    // solutions are evaluated in the worker threads (also by the cancelled tasks)
+    if (isProcessingView() || !m_processViewTasksCancelled.isEmpty()) return;
+
+    // the least recently used solutions, the current time step is kept; the view
+    // filters of the other time steps are not evaluated again, only deleted
+    int numberOfSolution = Util::scene()->problemInfo()->hermes()->numberOfSolution();
+    for (int i = 0; i < m_solutionArrayRestored.count() &&
+         m_solutionArrayRestored.count() > SOLUTION_ARRAYS_RESTORED * numberOfSolution; )
+    {
+        SolutionArray *solutionArray = m_solutionArrayRestored.at(i);
+        if (m_solutionArrayList.indexOf(solutionArray) / numberOfSolution != m_timeStep)
+        {
+            m_solutionArrayRestored.removeAt(i);
+            solutionArray->release();
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
 Orderizer *SceneSolution::ordView()
 {
-    logMessage("SceneSolution::ordView()");
+    logTrace("SceneSolution::ordView()");
 
     if (isSolved())
+    {
+        // order of the stored time step is read with the solution
+        sln(m_timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution());
         return m_solutionArrayList.value(m_timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution())->order;
+    }
     else
         return NULL;
 }
 
+void SceneSolution::particleTracingPaths(QList<QList<Point3> > *positionsList,
+                                         QList<QList<Point3> > *velocitiesList)
+{
+    logMessage("SceneSolution::particleTracingPaths()");
+
+    // settings and time step of the paths
+    QByteArray settings;
+    QDataStream stream(&settings, QIODevice::WriteOnly);
+    stream << Util::config()->particleIncludeGravitation
+           << Util::config()->particleMass
+           << Util::config()->particleConstant
+           << Util::config()->particleMaximumRelativeError
+           << Util::config()->particleMinimumStep
+           << Util::config()->particleMaximumNumberOfSteps
+           << Util::config()->particleReflectOnDifferentMaterial
+           << Util::config()->particleReflectOnBoundary
+           << Util::config()->particleCoefficientOfRestitution
+           << Util::config()->particleStart.x << Util::config()->particleStart.y
+           << Util::config()->particleStartVelocity.x << Util::config()->particleStartVelocity.y
+           << Util::config()->particleNumberOfParticles
+           << Util::config()->particleStartingRadius
+           << Util::config()->particleDragDensity
+           << Util::config()->particleDragCoefficient
+           << Util::config()->particleDragReferenceArea
+           << m_timeStep;
+
+    // solution of the active time step
+    Solution *solution = sln();
+    if (solution && settings != m_particleTracingSettings)
+    {
+        clearParticleTracingPaths();
+
+        // starting points (random points are generated in the same order as before)
+        QList<Point3> starts;
+        for (int k = 0; k < Util::config()->particleNumberOfParticles; k++)
+            starts.append(Util::scene()->particleStartingPoint(k > 0));
+
+        QVector<QList<Point3> > positions(starts.count());
+        QVector<QList<Point3> > velocities(starts.count());
+
+        // all solutions needed by the particle force (e.g. the previous time step or the imaginary part)
+        // are restored here, the threads do not touch the solutions of the scene
+        QList<Solution *> localSolutions = Util::scene()->problemInfo()->hermes()->localPointValueSolutions();
+
+        // point location grids are built before the threads start
+        Hermes::vector<Mesh *> meshes;
+        for (int i = 0; i < localSolutions.count(); i++)
+        {
+            if (localSolutions.at(i))
+            {
+                localSolutions.at(i)->get_mesh()->get_hash_grid();
+                meshes.push_back(localSolutions.at(i)->get_mesh());
+            }
+        }
+
+        // every thread evaluates its own copies of the solutions (element and reference map state),
+        // the global quadratures switch the mode per element, so mixed meshes are traced by one thread
+        int count = qMax(1, qMin(Util::config()->numberOfThreads, starts.count()));
+        if (!Traverse::is_mode_uniform(meshes))
+            count = 1;
+        QList<QList<Solution *> > solutions;
+        for (int t = 0; t < count; t++)
+        {
+            QList<Solution *> copies;
+            for (int i = 0; i < localSolutions.count(); i++)
+            {
+                Solution *copy = NULL;
+                if (localSolutions.at(i))
+                {
+                    copy = new Solution();
+                    copy->copy(localSolutions.at(i), false);
+                    copy->use_private_refmap_pss();
+                }
+                copies.append(copy);
+            }
+            solutions.append(copies);
+        }
+
+        // the first thread is the calling thread
+        QAtomicInt next(0);
+        QList<QFuture<void> > futures;
+        for (int t = 1; t < count; t++)
+            futures.append(QtConcurrent::run(traceParticles, &next, &starts, positions.data(), velocities.data(), solutions.at(t)));
+        traceParticles(&next, &starts, positions.data(), velocities.data(), solutions.at(0));
+        for (int t = 0; t < futures.count(); t++)
+            futures[t].waitForFinished();
+
+        for (int t = 0; t < count; t++)
+            qDeleteAll(solutions.at(t));
+
+        m_particlePositionsList = positions.toList();
+        m_particleVelocitiesList = velocities.toList();
+        m_particleTracingSettings = settings;
+    }
+
+    *positionsList = m_particlePositionsList;
+    *velocitiesList = m_particleVelocitiesList;
+}
+
+void SceneSolution::clearParticleTracingPaths()
+{
+    logMessage("SceneSolution::clearParticleTracingPaths()");
+
+    m_particlePositionsList.clear();
+    m_particleVelocitiesList.clear();
+    m_particleTracingSettings.clear();
+}
+
 double SceneSolution::adaptiveError()
 {
     logMessage("SceneSolution::adaptiveError()");
@@ -303,7 +1207,7 @@ int SceneSolution::adaptiveSteps()
 
 int SceneSolution::findElementInVectorizer(const Vectorizer &vec, const Point &point) const
 {
-    logMessage("SceneSolution::findTriangleInVectorizer()");
+    logTrace("SceneSolution::findTriangleInVectorizer()");
 
     double4* vecVert = vec.get_vertices();
     int3* vecTris = vec.get_triangles();
@@ -336,31 +1240,11 @@ int SceneSolution::findElementInVectorizer(const Vectorizer &vec, const Point &p
     return -1;
 }
 
-#define sign(x) (( x > 0 ) - ( x < 0 ))
-
 int SceneSolution::findElementInMesh(Mesh *mesh, const Point &point) const
 {
-    for (int i = 0; i < mesh->get_num_active_elements(); i++)
-    {
-        Element *element = mesh->get_element_fast(i);
-
-        bool inElement = false;
-        int j;
-        int npol = (element->is_triangle()) ? 3 : 4;
-
-        for (int i = 0, j = npol-1; i < npol; j = i++) {
-            if ((((element->vn[i]->y <= point.y) && (point.y < element->vn[j]->y)) ||
-                 ((element->vn[j]->y <= point.y) && (point.y < element->vn[i]->y))) &&
-                    (point.x < (element->vn[j]->x - element->vn[i]->x) * (point.y - element->vn[i]->y)
-                     / (element->vn[j]->y - element->vn[i]->y) + element->vn[i]->x))
-                inElement = !inElement;
-        }
+    Element *element = mesh->element_on_physical_coordinates(point.x, point.y);
 
-        if (inElement)
-            return i;
-    }
-    
-    return -1;
+    return (element) ? element->id : -1;
 }
 
 void SceneSolution::setMeshInitial(Mesh *meshInitial)
@@ -371,18 +1255,28 @@ void SceneSolution::setMeshInitial(Mesh *meshInitial)
     }
 
     m_meshInitial = meshInitial;
+
+    // point location grid
+    if (m_meshInitial)
+        m_meshInitial->get_hash_grid();
 }
 
 void SceneSolution::setSolutionArrayList(QList<SolutionArray *> solutionArrayList)
 {
     logMessage("SceneSolution::setSolutionArrayList()");
 
+    // linearizations of the previous solutions
+    waitProcessView();
+    clearViewLinearizations();
+
     if (!m_solutionArrayList.isEmpty())
     {
         for (int i = 0; i < m_solutionArrayList.count(); i++)
             delete m_solutionArrayList.at(i);
         m_solutionArrayList.clear();
     }
+    m_solutionArrayRestored.clear();
+    clearParticleTracingPaths();
 
     m_solutionArrayList = solutionArrayList;
 
@@ -402,164 +1296,510 @@ void SceneSolution::setTimeStep(int timeStep, bool showViewProgress)
 
 int SceneSolution::timeStepCount() const
 {
-    logMessage("SceneSolution::timeStepCount()");
+    logTrace("SceneSolution::timeStepCount()");
 
     return (!m_solutionArrayList.isEmpty()) ? m_solutionArrayList.count() / Util::scene()->problemInfo()->hermes()->numberOfSolution() : 0;
 }
 
-double SceneSolution::time() const
+double SceneSolution::time(int timeStep) const
 {
-    logMessage("SceneSolution::time()");
+    logTrace("SceneSolution::time()");
 
     if (isSolved())
     {
-        if (m_solutionArrayList.value(m_timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution())->sln)
-            return m_solutionArrayList.value(m_timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution())->time;
+        // default
+        if (timeStep == -1)
+            timeStep = m_timeStep;
+
+        if (m_solutionArrayList.value(timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution())->hasSolution())
+            return m_solutionArrayList.value(timeStep * Util::scene()->problemInfo()->hermes()->numberOfSolution())->time;
     }
     return 0.0;
 }
 
-void SceneSolution::setSlnContourView(ViewScalarFilter *slnScalarView)
+QList<QList<LocalPointValue *> > SceneSolution::localPointValuesTimeSeries(const QList<Point> &points)
 {
-    logMessage("SceneSolution::setSlnContourView()");
+    logMessage("SceneSolution::localPointValuesTimeSeries()");
+
+    QList<QList<LocalPointValue *> > values;
+    if (!isSolved()) return values;
+
+    // the time step is passed explicitly, the time step of the view is not changed
+    for (int i = 0; i < timeStepCount(); i++)
+        values.append(Util::scene()->problemInfo()->hermes()->localPointValues(points, i));
+
+    // restore time functions
+    if (Util::scene()->problemInfo()->analysisType == AnalysisType_Transient)
+        Util::scene()->problemInfo()->hermes()->updateTimeFunctions(time());
+
+    return values;
+}
 
-    if (m_slnContourView)
+void SceneSolution::processView(bool showViewProgress)
+{
+    if (showViewProgress)
+    {
+        m_progressDialog->clear();
+        m_progressDialog->appendProgressItem(m_progressItemProcessView);
+        m_progressDialog->run(showViewProgress);
+    }
+    else
     {
-        delete m_slnContourView;
-        m_slnContourView = NULL;
+        m_progressItemProcessView->setSteps();
+        m_progressItemProcessView->run(true);
     }
-    
-    m_slnContourView = slnScalarView;
-    m_linContourView.process_solution(m_slnContourView, H2D_FN_VAL_0, Util::config()->linearizerQuality);
+}
+
+void SceneSolution::processSolutionMesh()
+{
+    logMessage("SceneSolution::processSolutionMesh()");
+
+    startProcessView(true, false, false, false);
+    waitProcessView();
+}
+
+void SceneSolution::processRangeContour()
+{
+    logMessage("SceneSolution::processRangeContour()");
+
+    startProcessView(false, true, false, false);
+    waitProcessView();
+}
+
+void SceneSolution::processRangeScalar()
+{
+    logMessage("SceneSolution::processRangeScalar()");
+
+    startProcessView(false, false, true, false);
+    waitProcessView();
+}
+
+void SceneSolution::processRangeVector()
+{
+    logMessage("SceneSolution::processRangeVector()");
 
-    // deformed shape
-    if (Util::config()->deformContour)
-        Util::scene()->problemInfo()->hermes()->deformShape(m_linContourView.get_vertices(), m_linContourView.get_num_vertices());
+    startProcessView(false, false, false, true);
+    waitProcessView();
 }
 
-void SceneSolution::setSlnScalarView(ViewScalarFilter *slnScalarView)
+void SceneSolution::startProcessView(bool solutionMesh, bool contour, bool scalar, bool vector)
 {
-    logMessage("SceneSolution::setSlnScalarView()");
+    logMessage("SceneSolution::startProcessView()");
+
+    // previous processing is abandoned, its caches are processed again
+    foreach (ProcessViewTask *task, m_processViewTasks)
+    {
+        solutionMesh = solutionMesh || task->viewCaches.contains(ViewCache_SolutionMesh);
+        contour = contour || task->viewCaches.contains(ViewCache_Contour);
+        scalar = scalar || task->viewCaches.contains(ViewCache_Scalar);
+        vector = vector || task->viewCaches.contains(ViewCache_Vector);
+    }
+    cancelProcessView();
 
-    if (m_slnScalarView)
+    // stored time step can fail to be restored (e.g. no temporary file)
+    if (!isSolved() || !sln())
+        return;
+
+    // workers share the global quadratures, which switch the mode per element,
+    // caches are processed concurrently only on meshes with one type of elements
+    Hermes::vector<Mesh *> meshes(sln()->get_mesh());
+    m_processViewConcurrent = Traverse::is_mode_uniform(meshes);
+
+    // filters and solutions are prepared here, each task works on its own copies
+    if (solutionMesh)
+    {
+        ProcessViewTask *task = new ProcessViewTask();
+        task->viewCaches.append(ViewCache_SolutionMesh);
+        task->solution = new Solution();
+        task->solution->set_zero(sln()->get_mesh());
+        task->solution->use_private_refmap_pss();
+        task->linearizer = new Linearizer();
+
+        m_processViewTasks.append(task);
+    }
+    if (contour)
+    {
+        if (isPhysicFieldVariableScalar(sceneView()->sceneViewSettings().contourPhysicFieldVariable))
+            processViewLinearization(ViewCache_Contour, sceneView()->sceneViewSettings().contourPhysicFieldVariable,
+                                     PhysicFieldVariableComp_Scalar, Util::config()->deformContour);
+        else
+            processViewLinearization(ViewCache_Contour, sceneView()->sceneViewSettings().contourPhysicFieldVariable,
+                                     PhysicFieldVariableComp_Magnitude, Util::config()->deformContour);
+    }
+    if (scalar)
+    {
+        processViewLinearization(ViewCache_Scalar, sceneView()->sceneViewSettings().scalarPhysicFieldVariable,
+                                 sceneView()->sceneViewSettings().scalarPhysicFieldVariableComp, Util::config()->deformScalar);
+    }
+    if (vector)
     {
-        delete m_slnScalarView;
-        m_slnScalarView = NULL;
+        ProcessViewTask *task = new ProcessViewTask();
+        task->viewCaches.append(ViewCache_Vector);
+        task->filter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().vectorPhysicFieldVariable,
+                                                                                PhysicFieldVariableComp_X);
+        task->filterY = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().vectorPhysicFieldVariable,
+                                                                                 PhysicFieldVariableComp_Y);
+        task->vectorizer = new Vectorizer();
+
+        m_processViewConcurrent = task->filter->usePrivateSolutions() && task->filterY->usePrivateSolutions() && m_processViewConcurrent;
+        m_processViewTasks.append(task);
     }
-    
-    m_slnScalarView = slnScalarView;
-    // QTime time;
-    // time.start();
-    m_linScalarView.process_solution(m_slnScalarView, H2D_FN_VAL_0, Util::config()->linearizerQuality);
-    // qDebug() << "linScalarView.process_solution: " << time.elapsed();
 
-    // deformed shape
-    if (Util::config()->deformScalar)
-        Util::scene()->problemInfo()->hermes()->deformShape(m_linScalarView.get_vertices(), m_linScalarView.get_num_vertices());
+    // the threads are divided among the tasks processed at once
+    if (Traverse::is_mode_uniform(meshes) && !m_processViewTasks.isEmpty())
+    {
+        int count = Util::config()->numberOfThreads;
+        if (m_processViewConcurrent)
+            count = qMax(1, count / m_processViewTasks.count());
+
+        foreach (ProcessViewTask *task, m_processViewTasks)
+            prepareProcessViewThreads(task, count);
+    }
+
+    // the cancelled tasks stop at the next element, the new ones are started after them
+    // (the solutions and quadratures are shared)
+    if (m_processViewTasksCancelled.isEmpty())
+        startProcessViewTasks();
 }
 
-void SceneSolution::setSlnVectorView(ViewScalarFilter *slnVectorXView, ViewScalarFilter *slnVectorYView)
+void SceneSolution::cancelProcessView()
 {
-    logMessage("SceneSolution::setSlnVectorView()");
+    logMessage("SceneSolution::cancelProcessView()");
 
-    if (m_slnVectorXView)
+    // running tasks are deleted by processViewTaskFinished(), the others at once
+    foreach (ProcessViewTask *task, m_processViewTasks)
     {
-        delete m_slnVectorXView;
-        m_slnVectorXView = NULL;
+        if (task->watcher)
+        {
+            if (task->vectorizer)
+                task->vectorizer->cancel();
+            else
+                task->linearizer->cancel();
+            m_processViewTasksCancelled.append(task);
+        }
+        else
+        {
+            deleteProcessViewTask(task);
+        }
     }
-    if (m_slnVectorYView)
+    m_processViewTasks.clear();
+}
+
+void SceneSolution::prepareProcessViewThreads(ProcessViewTask *task, int count)
+{
+    logMessage("SceneSolution::prepareProcessViewThreads()");
+
+    // the first thread evaluates the function of the task, the filter of the task is private
+    // exactly when its copies are (the same solutions are filtered)
+    for (int i = 1; i < count; i++)
     {
-        delete m_slnVectorYView;
-        m_slnVectorYView = NULL;
+        switch (task->viewCaches.first())
+        {
+        case ViewCache_SolutionMesh:
+        {
+            Solution *solution = new Solution();
+            solution->set_zero(sln()->get_mesh());
+            solution->use_private_refmap_pss();
+            task->threadFunctions.append(solution);
+        }
+            break;
+        case ViewCache_Contour:
+        case ViewCache_Scalar:
+        {
+            ViewScalarFilter *filter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(task->linearization->physicFieldVariable,
+                                                                                                task->linearization->physicFieldVariableComp);
+            if (!filter->usePrivateSolutions())
+            {
+                delete filter;
+                return;
+            }
+            task->threadFunctions.append(filter);
+        }
+            break;
+        case ViewCache_Vector:
+        {
+            ViewScalarFilter *filter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().vectorPhysicFieldVariable,
+                                                                                                PhysicFieldVariableComp_X);
+            ViewScalarFilter *filterY = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().vectorPhysicFieldVariable,
+                                                                                                 PhysicFieldVariableComp_Y);
+            if (!filter->usePrivateSolutions() || !filterY->usePrivateSolutions())
+            {
+                delete filter;
+                delete filterY;
+                return;
+            }
+            task->threadFunctions.append(filter);
+            task->threadFunctionsY.append(filterY);
+        }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void SceneSolution::waitProcessView()
+{
+    while (!m_processViewTasksCancelled.isEmpty())
+    {
+        ProcessViewTask *task = m_processViewTasksCancelled.takeFirst();
+
+        task->watcher->waitForFinished();
+        deleteProcessViewTask(task);
     }
-    
-    m_slnVectorXView = slnVectorXView;
-    m_slnVectorYView = slnVectorYView;
-    
-    m_vecVectorView.process_solution(m_slnVectorXView, H2D_FN_VAL_0, m_slnVectorYView, H2D_FN_VAL_0, HERMES_EPS_LOW);
+    startProcessViewTasks();
 
-    // deformed shape
-    if (Util::config()->deformVector)
-        Util::scene()->problemInfo()->hermes()->deformShape(m_vecVectorView.get_vertices(), m_vecVectorView.get_num_vertices());
+    while (!m_processViewTasks.isEmpty())
+    {
+        ProcessViewTask *task = m_processViewTasks.first();
+
+        task->watcher->waitForFinished();
+        finishProcessViewTask(task);
+    }
 }
 
-void SceneSolution::processView(bool showViewProgress)
+void SceneSolution::startProcessViewTasks()
 {
-    if (showViewProgress)
+    // otherwise the tasks are processed one by one
+    for (int i = 0; i < m_processViewTasks.count(); i++)
+        if (!m_processViewTasks.at(i)->watcher && (i == 0 || m_processViewConcurrent))
+            startProcessViewTask(m_processViewTasks.at(i));
+}
+
+void SceneSolution::startProcessViewTask(ProcessViewTask *task)
+{
+    logMessage("SceneSolution::startProcessViewTask()");
+
+    task->watcher = new QFutureWatcher<void>();
+    connect(task->watcher, SIGNAL(finished()), this, SLOT(processViewTaskFinished()));
+
+    Hermes::vector<MeshFunction *> slns;
+    Hermes::vector<MeshFunction *> slnsY;
+    if (task->solution)
+        slns.push_back(task->solution);
+    else
+        slns.push_back(task->filter);
+    foreach (MeshFunction *function, task->threadFunctions)
+        slns.push_back(function);
+
+    if (task->vectorizer)
     {
-        m_progressDialog->clear();
-        m_progressDialog->appendProgressItem(m_progressItemProcessView);
-        m_progressDialog->run(showViewProgress);
+        slnsY.push_back(task->filterY);
+        foreach (MeshFunction *function, task->threadFunctionsY)
+            slnsY.push_back(function);
+
+        task->watcher->setFuture(QtConcurrent::run(vectorizeView, task->vectorizer, slns, slnsY));
+    }
+    else if (task->solution)
+    {
+        task->watcher->setFuture(QtConcurrent::run(linearizeView, task->linearizer, slns, HERMES_EPS_NORMAL));
     }
     else
     {
-        m_progressItemProcessView->setSteps();
-        m_progressItemProcessView->run(true);
+        task->watcher->setFuture(QtConcurrent::run(linearizeView, task->linearizer, slns, Util::config()->linearizerQuality));
     }
 }
 
-void SceneSolution::processSolutionMesh()
+void SceneSolution::processViewTaskFinished()
 {
-    logMessage("SceneSolution::processSolutionMesh()");
+    logMessage("SceneSolution::processViewTaskFinished()");
 
-    if (isSolved())
+    // abandoned by a new pass, which is started when all such tasks are finished
+    for (int i = 0; i < m_processViewTasksCancelled.count(); i++)
     {
-        Solution tsln;
-        tsln.set_zero(sln()->get_mesh());
-        m_linSolutionMeshView.process_solution(&tsln);
+        if (m_processViewTasksCancelled.at(i)->watcher == sender())
+        {
+            deleteProcessViewTask(m_processViewTasksCancelled.takeAt(i));
+            if (m_processViewTasksCancelled.isEmpty())
+                startProcessViewTasks();
+            return;
+        }
+    }
 
-        emit processedSolutionMesh();
+    // the task could be already finished by waitProcessView()
+    for (int i = 0; i < m_processViewTasks.count(); i++)
+    {
+        if (m_processViewTasks.at(i)->watcher == sender())
+        {
+            finishProcessViewTask(m_processViewTasks.at(i));
+            break;
+        }
     }
 }
 
-void SceneSolution::processRangeContour()
+void SceneSolution::finishProcessViewTask(ProcessViewTask *task)
 {
-    logMessage("SceneSolution::processRangeContour()");
+    logMessage("SceneSolution::finishProcessViewTask()");
 
-    if (isSolved())
+    m_processViewTasks.removeOne(task);
+    task->watcher->deleteLater();
+
+    // copies evaluated by the other threads
+    qDeleteAll(task->threadFunctions);
+    qDeleteAll(task->threadFunctionsY);
+
+    // swap the processed cache
+    switch (task->viewCaches.first())
     {
-        ViewScalarFilter *viewScalarFilter;
-        if (isPhysicFieldVariableScalar(sceneView()->sceneViewSettings().contourPhysicFieldVariable))
-            viewScalarFilter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().contourPhysicFieldVariable,
-                                                                                        PhysicFieldVariableComp_Scalar);
-        else
-            viewScalarFilter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().contourPhysicFieldVariable,
-                                                                                        PhysicFieldVariableComp_Magnitude);
+    case ViewCache_SolutionMesh:
+        delete m_linSolutionMeshView;
+        m_linSolutionMeshView = task->linearizer;
+        delete task->solution;
 
-        setSlnContourView(viewScalarFilter);
-        emit processedRangeContour();
+        emit processedSolutionMesh();
+        break;
+    case ViewCache_Contour:
+    case ViewCache_Scalar:
+        // deformed shape
+        if (task->linearization->deform)
+            Util::scene()->problemInfo()->hermes()->deformShape(task->linearization->linearizer.get_vertices(),
+                                                                task->linearization->linearizer.get_num_vertices());
+
+        // linearization shared by the contour and scalar view
+        m_viewLinearizations.append(task->linearization);
+        foreach (ViewCache viewCache, task->viewCaches)
+            setViewLinearization(viewCache, task->linearization);
+        break;
+    case ViewCache_Vector:
+        delete m_vecVectorView;
+        m_vecVectorView = task->vectorizer;
+        if (m_slnVectorXView)
+            delete m_slnVectorXView;
+        if (m_slnVectorYView)
+            delete m_slnVectorYView;
+        m_slnVectorXView = task->filter;
+        m_slnVectorYView = task->filterY;
+
+        // deformed shape
+        if (Util::config()->deformVector)
+            Util::scene()->problemInfo()->hermes()->deformShape(m_vecVectorView->get_vertices(), m_vecVectorView->get_num_vertices());
+
+        emit processedRangeVector();
+        break;
+    default:
+        break;
     }
+
+    delete task;
+
+    if (m_processViewTasks.isEmpty())
+        emit processedView();
+    else if (!m_processViewConcurrent)
+        startProcessViewTask(m_processViewTasks.first());
 }
 
-void SceneSolution::processRangeScalar()
+void SceneSolution::deleteProcessViewTask(ProcessViewTask *task)
 {
-    logMessage("SceneSolution::processRangeScalar()");
+    logMessage("SceneSolution::deleteProcessViewTask()");
 
-    if (isSolved())
-    {
-        ViewScalarFilter *viewScalarFilter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().scalarPhysicFieldVariable,
-                                                                                                      sceneView()->sceneViewSettings().scalarPhysicFieldVariableComp);
+    if (task->watcher)
+        task->watcher->deleteLater();
 
-        setSlnScalarView(viewScalarFilter);
-        emit processedRangeScalar();
+    qDeleteAll(task->threadFunctions);
+    qDeleteAll(task->threadFunctionsY);
+
+    // the linearization owns its filter and linearizer
+    if (task->linearization)
+    {
+        delete task->linearization;
+    }
+    else
+    {
+        delete task->solution;
+        delete task->linearizer;
+        delete task->filter;
+        delete task->filterY;
+        delete task->vectorizer;
     }
+
+    delete task;
 }
 
-void SceneSolution::processRangeVector()
+void SceneSolution::processViewLinearization(ViewCache viewCache, PhysicFieldVariable physicFieldVariable,
+                                             PhysicFieldVariableComp physicFieldVariableComp, bool deform)
 {
-    logMessage("SceneSolution::processRangeVector()");
+    logMessage("SceneSolution::processViewLinearization()");
 
-    if (isSolved())
+    double quality = Util::config()->linearizerQuality;
+
+    // linearized before
+    foreach (ViewLinearization *linearization, m_viewLinearizations)
     {
-        ViewScalarFilter *viewVectorXFilter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().vectorPhysicFieldVariable,
-                                                                                                       PhysicFieldVariableComp_X);
+        if (linearization->isEqual(m_timeStep, physicFieldVariable, physicFieldVariableComp, quality, deform))
+        {
+            setViewLinearization(viewCache, linearization);
+            return;
+        }
+    }
+
+    // being linearized for the other view
+    foreach (ProcessViewTask *task, m_processViewTasks)
+    {
+        if (task->linearization &&
+                task->linearization->isEqual(m_timeStep, physicFieldVariable, physicFieldVariableComp, quality, deform))
+        {
+            task->viewCaches.append(viewCache);
+            return;
+        }
+    }
 
-        ViewScalarFilter *viewVectorYFilter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(sceneView()->sceneViewSettings().vectorPhysicFieldVariable,
-                                                                                                       PhysicFieldVariableComp_Y);
+    ViewLinearization *linearization = new ViewLinearization(m_timeStep, physicFieldVariable, physicFieldVariableComp, quality, deform);
+    linearization->filter = Util::scene()->problemInfo()->hermes()->viewScalarFilter(physicFieldVariable, physicFieldVariableComp);
 
-        setSlnVectorView(viewVectorXFilter, viewVectorYFilter);
-        emit processedRangeVector();
+    ProcessViewTask *task = new ProcessViewTask();
+    task->viewCaches.append(viewCache);
+    task->linearization = linearization;
+    task->filter = linearization->filter;
+    task->linearizer = &linearization->linearizer;
+
+    m_processViewConcurrent = task->filter->usePrivateSolutions() && m_processViewConcurrent;
+    m_processViewTasks.append(task);
+}
+
+void SceneSolution::setViewLinearization(ViewCache viewCache, ViewLinearization *linearization)
+{
+    logMessage("SceneSolution::setViewLinearization()");
+
+    // most recently used at the end
+    m_viewLinearizations.removeOne(linearization);
+    m_viewLinearizations.append(linearization);
+
+    if (viewCache == ViewCache_Contour)
+        m_contourView = linearization;
+    else
+        m_scalarView = linearization;
+
+    // release the least recently used linearizations, which are not shown
+    for (int i = 0; i < m_viewLinearizations.count() && m_viewLinearizations.count() > VIEW_LINEARIZATIONS_CACHED; )
+    {
+        ViewLinearization *cached = m_viewLinearizations.at(i);
+        if (cached != m_contourView && cached != m_scalarView)
+        {
+            m_viewLinearizations.removeAt(i);
+            delete cached;
+        }
+        else
+        {
+            i++;
+        }
     }
+
+    if (viewCache == ViewCache_Contour)
+        emit processedRangeContour();
+    else
+        emit processedRangeScalar();
+}
+
+void SceneSolution::clearViewLinearizations()
+{
+    logMessage("SceneSolution::clearViewLinearizations()");
+
+    m_contourView = &m_viewLinearizationEmpty;
+    m_scalarView = &m_viewLinearizationEmpty;
+
+    for (int i = 0; i < m_viewLinearizations.count(); i++)
+        delete m_viewLinearizations.at(i);
+    m_viewLinearizations.clear();
 }
 
 ProgressDialog *SceneSolution::progressDialog()
@@ -27,14 +27,110 @@ class Scene;
 class SceneMaterial;
 
 class ViewScalarFilter;
+class LocalPointValue;
 
 struct SolutionArray;
+struct SolutionLayout;
 
 class ProgressDialog;
 class ProgressItemMesh;
 class ProgressItemSolve;
 class ProgressItemProcessView;
 
+enum ViewCache
+{
+    ViewCache_Undefined,
+    ViewCache_SolutionMesh,
+    ViewCache_Contour,
+    ViewCache_Scalar,
+    ViewCache_Vector
+};
+
+// linearized scalar variable, shared by the contour and scalar (also 3D) views
+struct ViewLinearization
+{
+    ViewLinearization(int timeStep = -1,
+                      PhysicFieldVariable physicFieldVariable = PhysicFieldVariable_Undefined,
+                      PhysicFieldVariableComp physicFieldVariableComp = PhysicFieldVariableComp_Undefined,
+                      double quality = 0.0, bool deform = false);
+    ~ViewLinearization();
+
+    bool isEqual(int timeStep, PhysicFieldVariable physicFieldVariable, PhysicFieldVariableComp physicFieldVariableComp,
+                 double quality, bool deform) const;
+
+    int timeStep;
+    PhysicFieldVariable physicFieldVariable;
+    PhysicFieldVariableComp physicFieldVariableComp;
+    double quality;
+    bool deform;
+
+    ViewScalarFilter *filter;
+    Linearizer linearizer;
+};
+
+// time steps of the solution file, the file is mapped to memory and the
+// solutions are read when the time step is used (see SolutionArray::solution())
+class SolutionStorage
+{
+public:
+    SolutionStorage(const QString &fileName, bool compress);
+    ~SolutionStorage();
+
+    // maps the file and reads the index of the records (time steps)
+    bool open();
+    inline QString fileName() const { return m_file.fileName(); }
+
+    inline int count() const { return m_offsets.count() - 1; }
+    inline qint64 offset(int index) const { return m_offsets.at(index); }
+    void header(int index, double *time, double *adaptiveError, int *adaptiveSteps);
+    // reads the solution, compact time steps share the layout
+    bool restore(qint64 offset, Solution **sln, Orderizer **order, SolutionLayout **layout);
+
+    int references;
+
+private:
+    QFile m_file;
+    uchar *m_data;
+    bool m_compress;
+
+    // offsets of the records, the last one is the end of the records
+    QList<qint64> m_offsets;
+    QList<qint64> m_layoutOffsets;
+    QList<SolutionLayout *> m_layouts;
+    QVector<qint64> m_layoutCoefs;
+    // records checked by block()
+    QVector<bool> m_checked;
+
+    // data of the record (checked when it is used for the first time)
+    FILE *block(qint64 offset);
+    // type of the record, index of the layout and number of the coefficients
+    void recordHeader(int index, int *record, int *layout, int *coefs);
+    // data of the record, compressed records are uncompressed to content
+    bool recordData(int index, QByteArray *content, const uchar **data, qint64 *size);
+    SolutionLayout *layout(int index, FILE *block = NULL);
+};
+
+// view cache processed in a worker thread
+struct ProcessViewTask
+{
+    QList<ViewCache> viewCaches;
+
+    Solution *solution; // zero solution (solution mesh)
+    ViewScalarFilter *filter;
+    ViewScalarFilter *filterY; // vector view - y
+
+    ViewLinearization *linearization; // contour and scalar view
+
+    Linearizer *linearizer;
+    Vectorizer *vectorizer;
+
+    // private copies of the solution or filters for the other threads of the linearizer
+    QList<MeshFunction *> threadFunctions;
+    QList<MeshFunction *> threadFunctionsY;
+
+    QFutureWatcher<void> *watcher;
+};
+
 class SceneSolution : public QObject
 {
     Q_OBJECT
@@ -44,10 +140,13 @@ public:
     ~SceneSolution();
 
     void clear();
+    // mesh and solutions saved in base64 encoded xml (older documents)
     void loadMeshInitial(QDomElement *element);
-    void saveMeshInitial(QDomDocument *doc, QDomElement *element);
     void loadSolution(QDomElement *element);
-    void saveSolution(QDomDocument *doc, QDomElement *element);
+
+    // mesh and solutions in a binary file, written and read one time step after another
+    ErrorResult saveSolutionFile(const QString &fileName, bool compress = false);
+    ErrorResult loadSolutionFile(const QString &fileName);
 
     // solve
     void solve(SolverMode solverMode);
@@ -57,7 +156,8 @@ public:
     void setMeshInitial(Mesh *meshInitial);
 
     // solution
-    Solution *sln(int i = -1);
+    // i-th solution of the time step (i indexes the solutions of all time steps if the time step is not given)
+    Solution *sln(int i = -1, int timeStep = -1);
     void setSolutionArrayList(QList<SolutionArray *> solutionArrayList);
     inline QList<SolutionArray *> solutionArrayList() { return m_solutionArrayList; }
 
@@ -65,7 +165,10 @@ public:
     void setTimeStep(int timeStep, bool showViewProgress = true);
     inline int timeStep() const { return m_timeStep; }
     int timeStepCount() const;
-    double time() const;
+    double time(int timeStep = -1) const;
+
+    // evaluates the points in all time steps without processing the view
+    QList<QList<LocalPointValue *> > localPointValuesTimeSeries(const QList<Point> &points);
 
     bool isSolved() const { return (m_timeStep != -1); }
     bool isMeshed()  const { return m_meshInitial; }
@@ -73,27 +176,29 @@ public:
 
     // mesh
     inline Linearizer &linInitialMeshView() { return m_linInitialMeshView; }
-    inline Linearizer &linSolutionMeshView() { return m_linSolutionMeshView; }
+    inline Linearizer &linSolutionMeshView() { return *m_linSolutionMeshView; }
 
     // contour
-    inline ViewScalarFilter *slnContourView() { return m_slnContourView; }
-    void setSlnContourView(ViewScalarFilter *slnScalarView);
-    inline Linearizer &linContourView() { return m_linContourView; }
+    inline ViewScalarFilter *slnContourView() { return m_contourView->filter; }
+    inline Linearizer &linContourView() { return m_contourView->linearizer; }
 
     // scalar view
-    inline ViewScalarFilter *slnScalarView() { return m_slnScalarView; }
-    void setSlnScalarView(ViewScalarFilter *slnScalarView);
-    inline Linearizer &linScalarView() { return m_linScalarView; }
+    inline ViewScalarFilter *slnScalarView() { return m_scalarView->filter; }
+    inline Linearizer &linScalarView() { return m_scalarView->linearizer; }
 
     // vector view
-    void setSlnVectorView(ViewScalarFilter *slnVectorXView, ViewScalarFilter *slnVectorYView);
     inline ViewScalarFilter *slnVectorViewX() { return m_slnVectorXView; }
     inline ViewScalarFilter *slnVectorViewY() { return m_slnVectorYView; }
-    inline Vectorizer &vecVectorView() { return m_vecVectorView; }
+    inline Vectorizer &vecVectorView() { return *m_vecVectorView; }
 
     // order view
     Orderizer *ordView();
 
+    // particle tracing, the paths are traced in worker threads and kept until
+    // the solution or the particle tracing settings change
+    void particleTracingPaths(QList<QList<Point3> > *positionsList,
+                              QList<QList<Point3> > *velocitiesList);
+
     inline int timeElapsed() const { return m_timeElapsed; }
     double adaptiveError();
     int adaptiveSteps();
@@ -109,6 +214,13 @@ public:
     void processRangeScalar();
     void processRangeVector();
 
+    // view caches are processed concurrently in worker threads and swapped in
+    // (in the order of completion) by the event loop, processedView() is emitted at the end;
+    // a new pass cancels the running one and processes its caches too
+    void startProcessView(bool solutionMesh, bool contour, bool scalar, bool vector);
+    void waitProcessView();
+    inline bool isProcessingView() const { return !m_processViewTasks.isEmpty(); }
+
     // progress dialog
     ProgressDialog *progressDialog();
 
@@ -121,6 +233,10 @@ signals:
     void processedRangeContour();
     void processedRangeScalar();
     void processedRangeVector();
+    void processedView();
+
+private slots:
+    void processViewTaskFinished();
 
 private:
     int m_timeElapsed;
@@ -130,25 +246,55 @@ private:
     QList<SolutionArray *> m_solutionArrayList;
     int m_timeStep;
 
+    // recently used solutions of the compact and stored time steps
+    QList<SolutionArray *> m_solutionArrayRestored;
+    void releaseSolutionArrays();
+
     // mesh
     Linearizer m_linInitialMeshView;
-    Linearizer m_linSolutionMeshView;
+    Linearizer *m_linSolutionMeshView;
 
-    // contour
-    ViewScalarFilter *m_slnContourView; // scalar view solution
-    Linearizer m_linContourView;
+    // contour and scalar view
+    ViewLinearization *m_contourView;
+    ViewLinearization *m_scalarView;
 
-    // scalar view
-    ViewScalarFilter *m_slnScalarView; // scalar view solution
-    Linearizer m_linScalarView; // linealizer for scalar view
+    // recently used linearizations (contour and scalar view)
+    QList<ViewLinearization *> m_viewLinearizations;
+    ViewLinearization m_viewLinearizationEmpty;
 
     // vector view
     ViewScalarFilter *m_slnVectorXView; // vector view solution - x
     ViewScalarFilter *m_slnVectorYView; // vector view solution - y
-    Vectorizer m_vecVectorView; // vectorizer for vector view
+    Vectorizer *m_vecVectorView; // vectorizer for vector view
 
     Mesh *m_meshInitial; // linearizer only for mesh (on empty solution)
 
+    // particle tracing
+    QList<QList<Point3> > m_particlePositionsList;
+    QList<QList<Point3> > m_particleVelocitiesList;
+    QByteArray m_particleTracingSettings; // settings and time step of the traced paths
+    void clearParticleTracingPaths();
+
+    // view processing
+    QList<ProcessViewTask *> m_processViewTasks;
+    QList<ProcessViewTask *> m_processViewTasksCancelled; // still running, deleted when finished
+    bool m_processViewConcurrent;
+
+    void cancelProcessView();
+    void prepareProcessViewThreads(ProcessViewTask *task, int count);
+    void startProcessViewTasks();
+    void startProcessViewTask(ProcessViewTask *task);
+    void finishProcessViewTask(ProcessViewTask *task);
+    void deleteProcessViewTask(ProcessViewTask *task);
+
+    void processViewLinearization(ViewCache viewCache, PhysicFieldVariable physicFieldVariable,
+                                  PhysicFieldVariableComp physicFieldVariableComp, bool deform);
+    void setViewLinearization(ViewCache viewCache, ViewLinearization *linearization);
+    void clearViewLinearizations();
+
+    // constant solution of the transient problem
+    SolutionArray *initialSolutionArray();
+
     // progress dialog
     ProgressDialog *m_progressDialog;
     ProgressItemMesh *m_progressItemMesh;
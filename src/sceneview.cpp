@@ -2452,13 +2452,12 @@ void SceneView::paintParticleTracing()
         QList<QList<Point3> > positionsList;
         QList<QList<Point3> > velocitiesList;
 
-        for (int k = 0; k < Util::config()->particleNumberOfParticles; k++)
-        {
-            // position and velocity cache
-            QList<Point3> positions;
-            QList<Point3> velocities;
+        // position and velocity cache
+        Util::scene()->sceneSolution()->particleTracingPaths(&positionsList, &velocitiesList);
 
-            Util::scene()->computeParticleTracingPath(&positions, &velocities, (k > 0));
+        for (int k = 0; k < velocitiesList.count(); k++)
+        {
+            const QList<Point3> &velocities = velocitiesList[k];
 
             // velocity min and max value
             for (int i = 0; i < velocities.length(); i++)
@@ -2468,13 +2467,10 @@ void SceneView::paintParticleTracing()
                 if (velocity < velocityMin) velocityMin = velocity;
                 if (velocity > velocityMax) velocityMax = velocity;
             }
-
-            positionsList.append(positions);
-            velocitiesList.append(velocities);
         }
 
         // visualization
-        for (int k = 0; k < Util::config()->particleNumberOfParticles; k++)
+        for (int k = 0; k < positionsList.count(); k++)
         {
             // starting point
             glPointSize(Util::config()->nodeSize * 1.2);
@@ -2886,13 +2882,13 @@ void SceneView::paintParticleTracing3D()
         QList<QList<Point3> > positionsList;
         QList<QList<Point3> > velocitiesList;
 
-        for (int k = 0; k < Util::config()->particleNumberOfParticles; k++)
-        {
-            // position and velocity cache
-            QList<Point3> positions;
-            QList<Point3> velocities;
+        // position and velocity cache
+        Util::scene()->sceneSolution()->particleTracingPaths(&positionsList, &velocitiesList);
 
-            Util::scene()->computeParticleTracingPath(&positions, &velocities, (k > 0));
+        for (int k = 0; k < positionsList.count(); k++)
+        {
+            const QList<Point3> &positions = positionsList[k];
+            const QList<Point3> &velocities = velocitiesList[k];
 
             // velocity min and max value
             for (int i = 0; i < velocities.length(); i++)
@@ -2910,9 +2906,6 @@ void SceneView::paintParticleTracing3D()
                 if (position < positionMin) positionMin = position;
                 if (position > positionMax) positionMax = position;
             }
-
-            positionsList.append(positions);
-            velocitiesList.append(velocities);
         }
 
         if ((positionMax - positionMin) < EPS_ZERO)
@@ -2922,7 +2915,7 @@ void SceneView::paintParticleTracing3D()
         }
 
         // visualization
-        for (int k = 0; k < Util::config()->particleNumberOfParticles; k++)
+        for (int k = 0; k < positionsList.count(); k++)
         {
             // starting point
             glPointSize(Util::config()->nodeSize * 1.2);
@@ -3323,7 +3316,7 @@ void SceneView::paintEdgeLine()
 
 const double* SceneView::paletteColor(double x) const
 {
-    logMessage("SceneView::paletteColor()");
+    logTrace("SceneView::paletteColor()");
 
     switch (Util::config()->paletteType)
     {
@@ -3448,7 +3441,7 @@ const double* SceneView::paletteColor(double x) const
 
 const double* SceneView::paletteColorOrder(int n) const
 {
-    logMessage("SceneView::paletteColorOrder()");
+    logTrace("SceneView::paletteColorOrder()");
 
     switch (Util::config()->orderPaletteOrderType)
     {
@@ -4080,7 +4073,7 @@ void SceneView::mouseReleaseEvent(QMouseEvent *event)
 
 void SceneView::mouseMoveEvent(QMouseEvent *event)
 {
-    logMessage("SceneView::mouseMoveEvent()");
+    logTrace("SceneView::mouseMoveEvent()");
 
     int dx = event->x() - m_lastPos.x();
     int dy = event->y() - m_lastPos.y();
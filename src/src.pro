@@ -154,6 +154,8 @@ linux-g++|linux-g++-64|linux-g++-32 {
     # DEFINES += WITH_MUMPS
     # DEFINES += WITH_SUPERLU
     # DEFINES += WITH_UNITY
+    # DEFINES += WITH_TRIANGLE
+    # DEFINES += WITH_TRACE
 
     INCLUDEPATH += /usr/include
     INCLUDEPATH += /usr/include/suitesparse
@@ -191,6 +193,11 @@ linux-g++|linux-g++-64|linux-g++-32 {
         INCLUDEPATH += /usr/include/libdbusmenu-0.4
         LIBS += -lunity
     }
+
+    # triangle (shared library, its triexit() is replaced in progressdialog.cpp)
+    contains(DEFINES, WITH_TRIANGLE) {
+        LIBS += -ltriangle
+    }
 }
 
 macx-g++|macx-g++42 {
@@ -34,7 +34,7 @@ SurfaceIntegralValue::SurfaceIntegralValue()
 
 void SurfaceIntegralValue::calculate()
 {
-    logMessage("SurfaceIntegralValue::calculate()");
+    logTrace("SurfaceIntegralValue::calculate()");
 
     if (!Util::scene()->sceneSolution()->isSolved())
         return;
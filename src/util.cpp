@@ -1300,7 +1300,7 @@ QString tempProblemDir()
 
 QString tempProblemFileName()
 {
-    logMessage("tempProblemFileName()");
+    logTrace("tempProblemFileName()");
 
     return tempProblemDir() + "/temp";
 }
@@ -1388,33 +1388,52 @@ void setVerbose(bool verb)
     verbose = verb;
 }
 
-QString formatLogMessage(QtMsgType type, const QString &msg)
+QString formatLogMessage(LogLevel level, const QString &msg, const QDateTime &dateTime = QDateTime::currentDateTime())
 {
     QString msgType = "";
 
-    switch (type) {
-    case QtDebugMsg:
+    switch (level) {
+    case LogLevel_Trace:
+        msgType = "Trace";
+        break;
+    case LogLevel_Debug:
         msgType = "Debug";
         break;
-    case QtWarningMsg:
+    case LogLevel_Warning:
         msgType = "Warning";
         break;
-    case QtCriticalMsg:
+    case LogLevel_Critical:
         msgType = "Critical";
         break;
-    case QtFatalMsg:
+    case LogLevel_Fatal:
         msgType = "Fatal";
         break;
     }
 
     QString str = QString("%1 %2: %3").
-            arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss.zzz")).
+            arg(dateTime.toString("dd.MM.yyyy hh:mm:ss.zzz")).
             arg(msgType).
             arg(msg);
 
     return str;
 }
 
+LogLevel logLevel(QtMsgType type)
+{
+    switch (type) {
+    case QtDebugMsg:
+        return LogLevel_Debug;
+    case QtWarningMsg:
+        return LogLevel_Warning;
+    case QtCriticalMsg:
+        return LogLevel_Critical;
+    case QtFatalMsg:
+        return LogLevel_Fatal;
+    }
+
+    return LogLevel_Debug;
+}
+
 void appendToFile(const QString &fileName, const QString &str)
 {
     QFile file(fileName);
@@ -1428,33 +1447,235 @@ void appendToFile(const QString &fileName, const QString &str)
     }
 }
 
-void logOutput(QtMsgType type, const char *msg)
+// messages are copied into the ring buffer by the callers (from any thread, without locks
+// and allocations) and written to app.log in batches by the writer thread
+const int LOG_BUFFER_SIZE = 4096; // power of two
+const int LOG_MESSAGE_LENGTH = 256;
+
+struct LogRecord
 {
-    QString str = formatLogMessage(type, msg);
+    QAtomicInt sequence;
+    LogLevel level;
+    QDate date;
+    QTime time;
+    char text[LOG_MESSAGE_LENGTH];
+};
+
+class LogWriter : public QThread
+{
+public:
+    LogWriter();
 
-    // string
-    fprintf(stderr, "%s\n", str.toStdString().c_str());
+    void push(LogLevel level, const char *text, int length);
+    void flush();
+    void stop();
 
-    if (Util::singleton() && Util::config()->enabledApplicationLog)
+protected:
+    virtual void run();
+
+private:
+    LogRecord m_records[LOG_BUFFER_SIZE];
+    QAtomicInt m_head;
+    int m_tail;
+    QAtomicInt m_dropped;
+
+    // single consumer (writer thread or flushLog())
+    QMutex m_flushMutex;
+
+    QMutex m_waitMutex;
+    QWaitCondition m_waitCondition;
+    bool m_stop;
+    // writer thread is finished, push() flushes the message
+    QAtomicInt m_stopped;
+};
+
+LogWriter::LogWriter() : QThread(), m_head(0), m_tail(0), m_dropped(0), m_stop(false), m_stopped(0)
+{
+    for (int i = 0; i < LOG_BUFFER_SIZE; i++)
+        m_records[i].sequence = i;
+}
+
+void LogWriter::push(LogLevel level, const char *text, int length)
+{
+    int pos;
+    LogRecord *record;
+    forever
+    {
+        pos = m_head;
+        record = &m_records[pos & (LOG_BUFFER_SIZE - 1)];
+
+        // acquire pairs with the release in flush(), the record is read by the writer before it is reused
+        int diff = int(uint(record->sequence.fetchAndAddAcquire(0)) - uint(pos));
+        if (diff == 0)
+        {
+            if (m_head.testAndSetRelaxed(pos, pos + 1))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // buffer is full, message is counted and dropped
+            m_dropped.ref();
+            return;
+        }
+    }
+
+    record->level = level;
+    record->date = QDate::currentDate();
+    record->time = QTime::currentTime();
+    length = qMin(length, LOG_MESSAGE_LENGTH - 1);
+    memcpy(record->text, text, length);
+    record->text[length] = '\0';
+
+    record->sequence.fetchAndStoreRelease(pos + 1);
+
+    if (m_stopped.fetchAndAddAcquire(0))
+        flush();
+    // wake up the writer when a quarter of the buffer is filled
+    else if (((pos + 1) & (LOG_BUFFER_SIZE / 4 - 1)) == 0)
+        m_waitCondition.wakeOne();
+}
+
+void LogWriter::flush()
+{
+    // location of the log is not available without the application
+    if (!QCoreApplication::instance())
+        return;
+
+    QMutexLocker locker(&m_flushMutex);
+
+    QString str;
+    forever
+    {
+        LogRecord *record = &m_records[m_tail & (LOG_BUFFER_SIZE - 1)];
+        if (record->sequence.fetchAndAddAcquire(0) != m_tail + 1)
+            break;
+
+        str += formatLogMessage(record->level, QString::fromUtf8(record->text), QDateTime(record->date, record->time)) + "\n";
+
+        record->sequence.fetchAndStoreRelease(m_tail + LOG_BUFFER_SIZE);
+        m_tail++;
+    }
+
+    int dropped = m_dropped.fetchAndStoreRelaxed(0);
+    if (dropped > 0)
+        str += formatLogMessage(LogLevel_Warning, QString("%1 log messages were dropped").arg(dropped)) + "\n";
+
+    if (!str.isEmpty())
     {
         QString location = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
         QDir("/").mkpath(location);
 
-        appendToFile(location + "/app.log", str);
+        QFile file(location + "/app.log");
+        if (file.open(QIODevice::Append | QIODevice::Text))
+        {
+            file.write(str.toUtf8());
+            file.close();
+        }
+    }
+}
+
+void LogWriter::stop()
+{
+    m_waitMutex.lock();
+    m_stop = true;
+    m_waitCondition.wakeOne();
+    m_waitMutex.unlock();
+
+    wait();
+    m_stopped.fetchAndStoreRelease(1);
+
+    // messages pushed while the thread was finishing
+    flush();
+}
+
+void LogWriter::run()
+{
+    forever
+    {
+        m_waitMutex.lock();
+        if (!m_stop)
+            m_waitCondition.wait(&m_waitMutex, 100);
+        bool stop = m_stop;
+        m_waitMutex.unlock();
+
+        flush();
+
+        if (stop)
+            return;
+    }
+}
+
+static QAtomicPointer<LogWriter> logWriter;
+
+// acquire pairs with the release of testAndSetOrdered() in logWriterInstance()
+static LogWriter *logWriterCurrent()
+{
+    return logWriter.fetchAndAddAcquire(0);
+}
+
+static LogWriter *logWriterInstance()
+{
+    LogWriter *writer = logWriterCurrent();
+    if (!writer)
+    {
+        writer = new LogWriter();
+        if (logWriter.testAndSetOrdered(NULL, writer))
+        {
+            writer->start(QThread::LowPriority);
+        }
+        else
+        {
+            delete writer;
+            writer = logWriterCurrent();
+        }
     }
 
+    return writer;
+}
+
+void flushLog()
+{
+    LogWriter *writer = logWriterCurrent();
+    if (writer)
+        writer->flush();
+}
+
+void stopLog()
+{
+    LogWriter *writer = logWriterCurrent();
+    if (writer)
+        writer->stop();
+}
+
+void logOutput(QtMsgType type, const char *msg)
+{
+    QString str = formatLogMessage(logLevel(type), msg);
+
+    // string
+    fprintf(stderr, "%s\n", str.toStdString().c_str());
+
+    if (Util::singleton() && Util::config()->enabledApplicationLog)
+        logWriterInstance()->push(logLevel(type), msg, strlen(msg));
+
     if (type == QtFatalMsg)
+    {
+        flushLog();
         abort();
+    }
 }
 
-void logMessage(const QString &msg)
+void logMessage(const char *msg, LogLevel level)
 {
-    if (verbose)
-    {
-        QString location = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
-        QDir("/").mkpath(location);
+    if (verbose || (level >= LogLevel_Warning && Util::singleton() && Util::config()->enabledApplicationLog))
+        logWriterInstance()->push(level, msg, strlen(msg));
+}
 
-        appendToFile(location + "/app.log", formatLogMessage(QtDebugMsg, msg));
+void logMessage(const QString &msg, LogLevel level)
+{
+    if (verbose || (level >= LogLevel_Warning && Util::singleton() && Util::config()->enabledApplicationLog))
+    {
+        QByteArray text = msg.toUtf8();
+        logWriterInstance()->push(level, text.constData(), text.length());
     }
 }
 
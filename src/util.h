@@ -61,8 +61,30 @@ using namespace std;
 void setVerbose(bool verb);
 
 // log file
+enum LogLevel
+{
+    LogLevel_Trace,
+    LogLevel_Debug,
+    LogLevel_Warning,
+    LogLevel_Critical,
+    LogLevel_Fatal
+};
+
 void logOutput(QtMsgType type, const char *msg);
-void logMessage(const QString &msg);
+void logMessage(const char *msg, LogLevel level = LogLevel_Debug);
+void logMessage(const QString &msg, LogLevel level = LogLevel_Debug);
+// write all queued messages to the log file
+void flushLog();
+// stop the writer thread before the application is destroyed, messages are then written by the caller
+void stopLog();
+
+// trace of the functions called in hot paths (drawing, point values, evaluation),
+// compiled in only with DEFINES += WITH_TRACE
+#ifdef WITH_TRACE
+#define logTrace(msg) logMessage(msg, LogLevel_Trace)
+#else
+#define logTrace(msg)
+#endif
 
 // show page
 void showPage(const QString &str = "");
@@ -901,6 +923,8 @@ const ProjNormType ADAPTIVITY_PROJNORMTYPE = HERMES_H1_NORM;
 
 // command argument
 const QString COMMANDS_TRIANGLE = "%1 -p -P -q31.0 -e -A -a -z -Q -I -n -o2 \"%2\"";
+// switches of Triangle linked as a library (second order elements with edges, neighbors and attributes)
+const QString TRIANGLE_SWITCHES = "pPq31.0eAazQIno2";
 const QString COMMANDS_FFMPEG = "%1 -r %2 -y -i \"%3video_%08d.png\" -vcodec %4 \"%5\"";
 
 // max dofs
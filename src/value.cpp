@@ -30,7 +30,7 @@ bool Value::evaluate(bool quiet)
 
 bool Value::evaluate(double time, bool quiet)
 {
-    logMessage("Value::evaluate()");
+    logTrace("Value::evaluate()");
 
     // eval time
     runPythonExpression(QString("time = %1").arg(time), false);
@@ -33,7 +33,7 @@ VolumeIntegralValue::VolumeIntegralValue()
 
 void VolumeIntegralValue::calculate()
 {
-    logMessage("VolumeIntegralValue::calculate()");
+    logTrace("VolumeIntegralValue::calculate()");
 
     if (!Util::scene()->sceneSolution()->isSolved())
         return;